@@ -153,6 +153,11 @@ to exclude the API function. */
 #define configMAX_SYSCALL_INTERRUPT_PRIORITY    16
 #endif
 
+/* Microsecond task releases (Software/rtos/hrrelease.h); the wake-ups use notification index 1 */
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES   2
+#define appUSE_HR_RELEASE                       1
+
 /* A header file that defines trace macro can be included here. */
+#include "rtos_hooks.h"
 
 #endif /* FREERTOS_CONFIG_H */
\ No newline at end of file
@@ -4,9 +4,22 @@
 #include "queue.h"
 #include "semphr.h"
 #include "bsp.h"
+#include "hrrelease.h"
 #include "hardware/clocks.h"
 
+#ifndef HR_RELEASE
+#define HR_RELEASE 0
+#endif
+
+/* Releases from hardware timer alarms, or by xTaskDelayUntil() on the tick */
+#define RELEASE_MODE            (HR_RELEASE ? HRRELEASE_ALARM : HRRELEASE_DELAY_UNTIL)
+
+#define TASK1_PERIOD_US         400000u
+#define SAMPLER_PERIOD_US       2500u       /* No multiple of the 1 ms tick, 2 ms with xTaskDelayUntil() */
+#define REPORT_JOBS             10u         /* Task 1 jobs between two jitter reports */
+
 TaskHandle_t    xTask1_handle; /* Handle for the task 1. */
+TaskHandle_t    xSampler_handle; /* Handle for the sampler task. */
 
 /** 
  * @brief Wait function in milliseconds (CPU clock).
@@ -26,37 +39,60 @@ void wait_cpu_ms(uint32_t n) {
 
 /**
  * @brief Task 1
- * 
- * @param args Period in ticks
+ *
+ * Release, completion and response time are measured in microseconds; a
+ * tick-based measurement would round them to 1 ms.
+ *
+ * @param args Period in us
  */
 void vTask1(void *args) {
-    TickType_t xLastWakeTime = 0;
-    const TickType_t xPeriod = (int)args;   /* Get period (in ticks) from argument. */
-    TickType_t release, completion;
+    const uint32_t period_us = (uint32_t)(uintptr_t)args;
+    hrrelease_t *release = hrrelease_start("Task 1", period_us, RELEASE_MODE);
+    uint64_t released, completion;
     uint32_t response;
     uint32_t wcrt = 0;
+    uint32_t jobs = 0;
 
     for (;;) {
-        release = xLastWakeTime;
+        released = hrrelease_time(release);
         /* Simulate Computation with estimated WCET*/ 
         wait_cpu_ms(100);
         
-        completion = xTaskGetTickCount();
-        response = completion - release;
+        completion = time_us_64();
+        response = (uint32_t)(completion - released);
         if (response > wcrt) {
             wcrt = response;
         }
 
-        printf("Task 1 - Release: %6.3f, Completion: %6.3f, Response Time: %4.3f, WCRT: %4.3f", 
-            ((float) pdTICKS_TO_MS(release) / 1000), 
-            ((float) pdTICKS_TO_MS(completion) / 1000),
-            ((float) pdTICKS_TO_MS(response) / 1000),
-            ((float) pdTICKS_TO_MS(wcrt) / 1000));
-        if (response > xPeriod) {
+        printf("Task 1 - Release: %10.6f, Completion: %10.6f, Response Time: %8.6f, WCRT: %8.6f",
+            ((double) released / 1e6),
+            ((double) completion / 1e6),
+            ((double) response / 1e6),
+            ((double) wcrt / 1e6));
+        if (response > period_us) {
             printf(" ==> Deadline violated!");
         }    
         printf("\n");    
-        vTaskDelayUntil(&xLastWakeTime, xPeriod);   /* Wait for the next release. */
+        if (++jobs % REPORT_JOBS == 0) {
+            hrrelease_request_report();         /* Jitter histograms of both tasks */
+        }
+        hrrelease_wait(release);                /* Wait for the next release. */
+    }
+}
+
+/**
+ * @brief Sampler task: short job at a period that is no multiple of the
+ *        tick, which xTaskDelayUntil() cannot keep.
+ *
+ * @param args Period in us
+ */
+void vSamplerTask(void *args) {
+    hrrelease_t *release = hrrelease_start("Sampler", (uint32_t)(uintptr_t)args, RELEASE_MODE);
+    const uint32_t cycles_50us = clock_get_hz(clk_sys) / 20000u;
+
+    for (;;) {
+        BSP_WaitClkCycles(cycles_50us);         /* Simulate a 50 us sampling job */
+        hrrelease_wait(release);
     }
 }
 
@@ -75,9 +111,10 @@ int main()
     xTaskCreate(vTask1,          /* Pointer to task function */ 
                 "Task 1",        /* Name of the task */
                 512,             /* Stack depth in words */
-                (void*) 400,     /* Task parameter, here period */ 
+                (void*) TASK1_PERIOD_US, /* Task parameter, here period in us */
                 3,               /* Task Priority */
                 &xTask1_handle); /* Task Handle */
+    xTaskCreate(vSamplerTask, "Sampler", 512, (void*) SAMPLER_PERIOD_US, 4, &xSampler_handle);
 
     vTaskStartScheduler();  /* Start the scheduler. */
     
@@ -78,7 +78,11 @@
 #define configKERNEL_PROVIDED_STATIC_MEMORY     1
 
 /* Hook function related definitions. */
+#ifndef NDEBUG
+#define configCHECK_FOR_STACK_OVERFLOW          2   /* Debug builds: check the painted stack end */
+#else
 #define configCHECK_FOR_STACK_OVERFLOW          0
+#endif
 #define configUSE_MALLOC_FAILED_HOOK            0
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
@@ -15,10 +15,22 @@
 #include "queue.h"
 #include "semphr.h"
 #include "bsp.h"
+#include "cruise_core.h"
+#include "taskset.h"                /* Periods and priorities of tasks.csv */
 #include "hardware/clocks.h"
 
 #define GAS_STEP 2  /* Defines how much the throttle is increased if GAS_STEP is asserted */
 
+/* Step controller of the lab, shared with the host simulator (see cruise_core.h) */
+static const cruise_control_config_t xControlConfig = {
+    .throttle_max = 80,
+    .gas_step = GAS_STEP,
+    .cruise_min_velocity = 250,     /* Minimum velocity for cruise control to be active */
+    .error_band = 40,
+    .cruise_step = 3,
+    .pi = NULL,
+};
+
 /* Definition of handles for tasks */
 TaskHandle_t    xButton_handle; /* Handle for the Button task */
 TaskHandle_t    xControl_handle; /* Handle for the Control task */
@@ -41,51 +53,34 @@ QueueHandle_t xQueueBrakePedal;
  * ==> MODIFY THIS TASK! 
  *     Currently the buttons are ignored. Use busy wait I/O to monitor the buttons
  * ==> MODIFIED: Now periodically reads button inputs and sends them via queues
+ * ==> MODIFIED: Edge detection in cruise_buttons_step() (cruise_core.h)
  * @param args 
  */
 void vButtonTask(void *args) {
     TickType_t xLastWakeTime = xTaskGetTickCount();
     const TickType_t xPeriod = (int)args;   /* Period in ticks */
 
-    bool btnGas;
-    bool btnBrake;
-    bool prev_btnCruise = BSP_GetInput(SW_6); /* raw read, active-low: pressed -> 0 */
-    bool value_cruise_control = false;
+    cruise_buttons_t buttons;
+    cruise_pedals_t pedals;
 
     uint16_t now_velocity = 0;
 
-    for (;;) {
-        /* Busy-wait read of hardware button states */
-        bool raw_sw7 = BSP_GetInput(SW_7); /* GAS, active-low */
-        bool raw_sw5 = BSP_GetInput(SW_5); /* BRAKE, active-low */
-        bool raw_sw6 = BSP_GetInput(SW_6); /* CRUISE, raw */
-
-        /* Convert to logical pressed booleans (pressed == true) */
-        btnGas = !raw_sw7;
-        btnBrake = !raw_sw5;
-
-        /* Edge detect negative-edge of cruise button (pressed -> raw goes from 1->0) */
-        if ((raw_sw6 != prev_btnCruise) && (raw_sw6 == false)) {
-            /* at negative edge: toggle cruise state */
-            value_cruise_control = !value_cruise_control;
+    cruise_buttons_init(&buttons, BSP_GetInput(SW_6)); /* raw read, active-low: pressed -> 0 */
 
+    for (;;) {
+        /* Busy-wait read of hardware button states: GAS, BRAKE, CRUISE (all active-low);
+         * a negative edge of CRUISE toggles the request, the brake cancels it */
+        if (cruise_buttons_step(&buttons, BSP_GetInput(SW_7), BSP_GetInput(SW_5), BSP_GetInput(SW_6),
+                                &pedals)) {
             /* Snapshot current velocity as target */
             xQueuePeek(xQueueVelocity, &now_velocity, (TickType_t)0);
             xQueueOverwrite(xQueueTargetVelocity, &now_velocity);
-            
-        }
-
-        prev_btnCruise = raw_sw6;
-
-        /* Brake cancels cruise immediately */
-        if (btnBrake) {
-            value_cruise_control = false;
         }
 
         /* Send values to respective queues */
-        xQueueOverwrite(xQueueGasPedal,&btnGas);
-        xQueueOverwrite(xQueueBrakePedal,&btnBrake);
-        xQueueOverwrite(xQueueCruiseControl,&value_cruise_control);
+        xQueueOverwrite(xQueueGasPedal, &pedals.gas);
+        xQueueOverwrite(xQueueBrakePedal, &pedals.brake);
+        xQueueOverwrite(xQueueCruiseControl, &pedals.cruise);
 
         vTaskDelayUntil(&xLastWakeTime, xPeriod);   /* Periodic execution */
     }
@@ -98,64 +93,33 @@ void vButtonTask(void *args) {
  * ==> MODIFY THIS TASK!
  *     Currently the throttle has a fixed value of 80
  * ==> MODIFIED: Now periodic, and Proportional controller for throttle adjustment
+ * ==> MODIFIED: State machine and controller in cruise_control_step() (cruise_core.h)
  * @param args 
  */
 void vControlTask(void *args) {
     TickType_t xLastWakeTime = xTaskGetTickCount();
     const TickType_t xPeriod = (int)args;
 
+    cruise_control_t control;
+    cruise_pedals_t pedals = {0};
     uint16_t throttle = 0;
     uint16_t velocity = 0;
-    uint16_t target_velocity = 0;
-    bool cruise_request = false;
     bool cruise_active = false;
-    bool gas_pedal = false;
-    bool brake_pedal = false;
 
-    const uint16_t VELOCITY_CRUISE_THRESHOLD = 250; /* Minimum velocity for cruise control to be active */
+    cruise_control_init(&control);
 
     for (;;) {
-        xQueuePeek(xQueueCruiseControl, &cruise_request, (TickType_t)0);
-        xQueuePeek(xQueueGasPedal, &gas_pedal, (TickType_t)0);
-        xQueuePeek(xQueueBrakePedal, &brake_pedal, (TickType_t)0);
+        xQueuePeek(xQueueCruiseControl, &pedals.cruise, (TickType_t)0);
+        xQueuePeek(xQueueGasPedal, &pedals.gas, (TickType_t)0);
+        xQueuePeek(xQueueBrakePedal, &pedals.brake, (TickType_t)0);
         xQueuePeek(xQueueVelocity, &velocity, (TickType_t)0);
-        xQueuePeek(xQueueTargetVelocity, &target_velocity, (TickType_t)0);
-
-        /* Cruise control toggle logic */
-        if (brake_pedal || gas_pedal) {
-            /* brakes or gas deactivate cruise */
-            cruise_active = false;
-        } else {
-            /* user requested cruise and velocity threshold satisfied */
-            if (cruise_request && (velocity >= VELOCITY_CRUISE_THRESHOLD)) {
-                if (!cruise_active) {
-                    cruise_active = true;
-                    /* snapshot current velocity as target */
-                    target_velocity = velocity;
-                    xQueueOverwrite(xQueueTargetVelocity, &target_velocity);
-                }
-            } else {
-                cruise_active = false;
-            }
-        }
-        
-        if (brake_pedal) {
-            throttle = 0;
-        }
-        else if (gas_pedal) {
-            throttle += GAS_STEP;
-            if (throttle > 80)
-                throttle = 80;
-        }
-        else if (cruise_active) {
-            int16_t err = (int16_t)target_velocity - (int16_t)velocity;
-            /* simple proportional step adjust: */
-            if (err > 40) throttle = (throttle + 3 > 80) ? 80 : throttle + 3;
-            else if (err < -40) throttle = (throttle > 3) ? throttle - 3 : 0;
-            /* else keep throttle */
-        } else {
-            throttle = 0;
+
+        throttle = cruise_control_step(&xControlConfig, &control, &pedals, velocity, 0, true);
+        if (control.cruise_active && !cruise_active) {
+            /* engaged: publish the snapshot of the current velocity as target */
+            xQueueOverwrite(xQueueTargetVelocity, &control.target_velocity);
         }
+        cruise_active = control.cruise_active;
 
         /* Set yellow LED for cruise active */
         BSP_SetLED(LED_YELLOW, cruise_active);
@@ -359,6 +323,7 @@ void vDisplayTask(void *args) {
  *        - Adjust the priorities of the task so that they correspond
  *          to the rate-monotonic algorithm.
  * ==> MODIFIED: Converted button and control tasks to periodic, adjusted priorities
+ * ==> MODIFIED: Periods and priorities from tasks.csv (taskset.h), checked at configure time
  * @return 
  */
 int main()
@@ -375,13 +340,30 @@ int main()
     xQueueThrottle = xQueueCreate( 1, sizeof(uint16_t));
 
     /* Create the tasks. */
-    xTaskCreate(vButtonTask, "Button Task", 512, (void*) 50, 7, &xButton_handle);
-    xTaskCreate(vVehicleTask, "Vehicle Task", 512, (void*) 100, 6, &xVehicle_handle); 
-    xTaskCreate(vControlTask, "Control Task", 512, (void*) 200, 5, &xControl_handle);
-    xTaskCreate(vDisplayTask, "Display Task", 512, (void*) 500, 4, &xDisplay_handle); 
+    xTaskCreate(vButtonTask, "Button Task", 512, (void*) pdMS_TO_TICKS(TASK_BUTTON_PERIOD_MS), TASK_BUTTON_PRIORITY, &xButton_handle);
+    xTaskCreate(vVehicleTask, "Vehicle Task", 512, (void*) pdMS_TO_TICKS(TASK_VEHICLE_PERIOD_MS), TASK_VEHICLE_PRIORITY, &xVehicle_handle); 
+    xTaskCreate(vControlTask, "Control Task", 512, (void*) pdMS_TO_TICKS(TASK_CONTROL_PERIOD_MS), TASK_CONTROL_PRIORITY, &xControl_handle);
+    xTaskCreate(vDisplayTask, "Display Task", 512, (void*) pdMS_TO_TICKS(TASK_DISPLAY_PERIOD_MS), TASK_DISPLAY_PRIORITY, &xDisplay_handle); 
 
     vTaskStartScheduler();  /* Start the scheduler. */
     
     return 0;
 }
 /*-----------------------------------------------------------*/
+
+#if ( configCHECK_FOR_STACK_OVERFLOW > 0 )
+/**
+ * @brief Called by the kernel when a task has overrun its stack (debug builds).
+ *        This project does not link Software/rtos, so it has its own hook.
+ *
+ * @param xTask Task that overflowed.
+ * @param pcTaskName Name of the task.
+ */
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
+    taskDISABLE_INTERRUPTS();
+    printf("STACK OVERFLOW in task %s!\n", pcTaskName);
+    for (;;) {
+        /* Halt, the kernel state can no longer be trusted. */
+    }
+}
+#endif
@@ -45,7 +45,7 @@
 #define configUSE_PREEMPTION                    1
 #define configUSE_TICKLESS_IDLE                 0
 #define configUSE_IDLE_HOOK                     0
-#define configUSE_TICK_HOOK                     0
+#define configUSE_TICK_HOOK                     1
 #define configTICK_RATE_HZ                      ( ( TickType_t ) 1000 )
 #define configMAX_PRIORITIES                    32
 #define configMINIMAL_STACK_SIZE                ( configSTACK_DEPTH_TYPE ) 512 
@@ -78,7 +78,11 @@
 #define configKERNEL_PROVIDED_STATIC_MEMORY     1
 
 /* Hook function related definitions. */
+#ifndef NDEBUG
+#define configCHECK_FOR_STACK_OVERFLOW          2   /* Debug builds: check the painted stack end */
+#else
 #define configCHECK_FOR_STACK_OVERFLOW          0
+#endif
 #define configUSE_MALLOC_FAILED_HOOK            0
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
@@ -153,6 +157,11 @@ to exclude the API function. */
 #define configMAX_SYSCALL_INTERRUPT_PRIORITY    16
 #endif
 
+/* Application monitoring modules (Software/rtos). */
+#define appUSE_LOAD_MONITOR                     1
+#define appUSE_WATCHDOG_SUPERVISOR              1
+
 /* A header file that defines trace macro can be included here. */
+#include "rtos_hooks.h"
 
 #endif /* FREERTOS_CONFIG_H */
\ No newline at end of file
@@ -13,19 +13,30 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
-#include "semphr.h"
 #include "bsp.h"
+#include "cruise_core.h"
+#include "taskset.h"                /* Periods and priorities of tasks.csv */
+#include "loadmon.h"
+#include "supervisor.h"
 #include "hardware/clocks.h"
 
 #define GAS_STEP 2  /* Defines how much the throttle is increased if GAS_STEP is asserted */
 
+/* Step controller of the lab, shared with the host simulator (see cruise_core.h) */
+static const cruise_control_config_t xControlConfig = {
+    .throttle_max = 80,
+    .gas_step = GAS_STEP,
+    .cruise_min_velocity = 250,     /* Minimum velocity for cruise control to be active */
+    .error_band = 40,
+    .cruise_step = 3,
+    .pi = NULL,
+};
+
 /* Definition of handles for tasks */
 TaskHandle_t    xButton_handle; /* Handle for the Button task */
 TaskHandle_t    xControl_handle; /* Handle for the Control task */
 TaskHandle_t    xVehicle_handle; /* Handle for the Vehicle task */
 TaskHandle_t    xDisplay_handle; /* Handle for the Display task */
-TaskHandle_t    xWatchDog_handle; /* Handle for the Watchdog task */
-TaskHandle_t    xOverload_handle; /* Handle for the OverloadDetection task */
 TaskHandle_t    xExtraLoad_handle; /* Handle for the ExtraLoad task */
 
 /* Definition of handles for queues */
@@ -38,18 +49,34 @@ QueueHandle_t xQueueGasPedal;
 QueueHandle_t xQueueBrakePedal;
 
 /* ---------------- Part 3 globals ------------------ */
-/* Watchdog semaphore (OK token) */
-SemaphoreHandle_t xSemaphoreWatchDogFood = NULL;
+/* Load monitor thresholds:
+ * - overload if the last 100 ms were at least 95 % busy or contain a deadline miss
+ * - cleared again once the load drops below 80 % without misses
+ */
+static const loadwin_limits_t xOverloadLimits = {
+    .level = LOADWIN_100MS,
+    .enter_permille = 950,
+    .exit_permille = 800,
+    .miss_limit = 1,
+};
+
+/* Watchdog: the CMake option CRUISE_WATCHDOG (OFF by default) arms the hardware watchdog
+ * (supervisor.h). It is fed only while Button and Control each check in within
+ * WATCHDOG_WINDOW_PERIODS of their periods; a hung task resets the board, and the next start
+ * prints which task missed its window */
+#ifndef CRUISE_WATCHDOG
+#define CRUISE_WATCHDOG             0
+#endif
+#define WATCHDOG_TIMEOUT_MS         500u
+#define WATCHDOG_CHECK_MS           50u
+#define WATCHDOG_WINDOW_PERIODS     5u
 
 /* Part3 constants */
-#define OVERLOAD_WATCHDOG_TIMEOUT_MS 1000u
-#define OVERLOAD_DETECT_PERIOD_MS   100u
-#define EXTRA_LOAD_PERIOD_MS        25u
+#define EXTRA_LOAD_PERIOD_MS        TASK_EXTRALOAD_PERIOD_MS
 
 /* Forward prototypes for new tasks */
-void vWatchDogTask(void *arg);
-void vOverloadDetectionTask(void *arg);
 void vExtraLoadTask(void *arg);
+static void vOverloadEvent(bool overloaded, uint16_t permille);
 
 /**
  * @brief The button task shall monitor the input buttons and send the values to the
@@ -58,53 +85,40 @@ void vExtraLoadTask(void *arg);
  * ==> MODIFY THIS TASK! 
  *     Currently the buttons are ignored. Use busy wait I/O to monitor the buttons
  * ==> MODIFIED: Now periodically reads button inputs and sends them via queues
+ * ==> MODIFIED: Edge detection in cruise_buttons_step() (cruise_core.h)
+ * ==> MODIFIED: Checks in with the watchdog supervisor once per job
  * @param args 
  */
 void vButtonTask(void *args) {
     TickType_t xLastWakeTime = xTaskGetTickCount();
     const TickType_t xPeriod = (int)args;   /* Period in ticks */
 
-    bool btnGas;
-    bool btnBrake;
-    bool prev_btnCruise = BSP_GetInput(SW_6); /* raw read, active-low: pressed -> 0 */
-    bool value_cruise_control = false;
+    cruise_buttons_t buttons;
+    cruise_pedals_t pedals;
 
     uint16_t now_velocity = 0;
 
-    for (;;) {
-        /* Busy-wait read of hardware button states */
-        bool raw_sw7 = BSP_GetInput(SW_7); /* GAS, active-low */
-        bool raw_sw5 = BSP_GetInput(SW_5); /* BRAKE, active-low */
-        bool raw_sw6 = BSP_GetInput(SW_6); /* CRUISE, raw */
-
-        /* Convert to logical pressed booleans (pressed == true) */
-        btnGas = !raw_sw7;
-        btnBrake = !raw_sw5;
-
-        /* Edge detect negative-edge of cruise button (pressed -> raw goes from 1->0) */
-        if ((raw_sw6 != prev_btnCruise) && (raw_sw6 == false)) {
-            /* at negative edge: toggle cruise state */
-            value_cruise_control = !value_cruise_control;
+    cruise_buttons_init(&buttons, BSP_GetInput(SW_6)); /* raw read, active-low: pressed -> 0 */
 
+    for (;;) {
+        /* Busy-wait read of hardware button states: GAS, BRAKE, CRUISE (all active-low);
+         * a negative edge of CRUISE toggles the request, the brake cancels it */
+        if (cruise_buttons_step(&buttons, BSP_GetInput(SW_7), BSP_GetInput(SW_5), BSP_GetInput(SW_6),
+                                &pedals)) {
             /* Snapshot current velocity as target */
             xQueuePeek(xQueueVelocity, &now_velocity, (TickType_t)0);
             xQueueOverwrite(xQueueTargetVelocity, &now_velocity);
-            
-        }
-
-        prev_btnCruise = raw_sw6;
-
-        /* Brake cancels cruise immediately */
-        if (btnBrake) {
-            value_cruise_control = false;
         }
 
         /* Send values to respective queues */
-        xQueueOverwrite(xQueueGasPedal,&btnGas);
-        xQueueOverwrite(xQueueBrakePedal,&btnBrake);
-        xQueueOverwrite(xQueueCruiseControl,&value_cruise_control);
+        xQueueOverwrite(xQueueGasPedal, &pedals.gas);
+        xQueueOverwrite(xQueueBrakePedal, &pedals.brake);
+        xQueueOverwrite(xQueueCruiseControl, &pedals.cruise);
 
-        vTaskDelayUntil(&xLastWakeTime, xPeriod);   /* Periodic execution */
+        sup_checkin();  /* Watchdog supervisor (CRUISE_WATCHDOG) */
+        if (xTaskDelayUntil(&xLastWakeTime, xPeriod) == pdFALSE) {  /* Periodic execution */
+            loadmon_deadline_miss();    /* Released late: the job overran its period */
+        }
     }
 }
 
@@ -115,71 +129,44 @@ void vButtonTask(void *args) {
  * ==> MODIFY THIS TASK!
  *     Currently the throttle has a fixed value of 80
  * ==> MODIFIED: Now periodic, and Proportional controller for throttle adjustment
+ * ==> MODIFIED: State machine and controller in cruise_control_step() (cruise_core.h)
+ * ==> MODIFIED: Checks in with the watchdog supervisor once per job
  * @param args 
  */
 void vControlTask(void *args) {
     TickType_t xLastWakeTime = xTaskGetTickCount();
     const TickType_t xPeriod = (int)args;
 
+    cruise_control_t control;
+    cruise_pedals_t pedals = {0};
     uint16_t throttle = 0;
     uint16_t velocity = 0;
-    uint16_t target_velocity = 0;
-    bool cruise_request = false;
     bool cruise_active = false;
-    bool gas_pedal = false;
-    bool brake_pedal = false;
 
-    const uint16_t VELOCITY_CRUISE_THRESHOLD = 250; /* Minimum velocity for cruise control to be active */
+    cruise_control_init(&control);
 
     for (;;) {
-        xQueuePeek(xQueueCruiseControl, &cruise_request, (TickType_t)0);
-        xQueuePeek(xQueueGasPedal, &gas_pedal, (TickType_t)0);
-        xQueuePeek(xQueueBrakePedal, &brake_pedal, (TickType_t)0);
+        xQueuePeek(xQueueCruiseControl, &pedals.cruise, (TickType_t)0);
+        xQueuePeek(xQueueGasPedal, &pedals.gas, (TickType_t)0);
+        xQueuePeek(xQueueBrakePedal, &pedals.brake, (TickType_t)0);
         xQueuePeek(xQueueVelocity, &velocity, (TickType_t)0);
-        xQueuePeek(xQueueTargetVelocity, &target_velocity, (TickType_t)0);
-
-        /* Cruise control toggle logic */
-        if (brake_pedal || gas_pedal) {
-            /* brakes or gas deactivate cruise */
-            cruise_active = false;
-        } else {
-            /* user requested cruise and velocity threshold satisfied */
-            if (cruise_request && (velocity >= VELOCITY_CRUISE_THRESHOLD)) {
-                if (!cruise_active) {
-                    cruise_active = true;
-                    /* snapshot current velocity as target */
-                    target_velocity = velocity;
-                    xQueueOverwrite(xQueueTargetVelocity, &target_velocity);
-                }
-            } else {
-                cruise_active = false;
-            }
-        }
-        
-        if (brake_pedal) {
-            throttle = 0;
-        }
-        else if (gas_pedal) {
-            throttle += GAS_STEP;
-            if (throttle > 80)
-                throttle = 80;
-        }
-        else if (cruise_active) {
-            int16_t err = (int16_t)target_velocity - (int16_t)velocity;
-            /* simple proportional step adjust: */
-            if (err > 40) throttle = (throttle + 3 > 80) ? 80 : throttle + 3;
-            else if (err < -40) throttle = (throttle > 3) ? throttle - 3 : 0;
-            /* else keep throttle */
-        } else {
-            throttle = 0;
+
+        throttle = cruise_control_step(&xControlConfig, &control, &pedals, velocity, 0, true);
+        if (control.cruise_active && !cruise_active) {
+            /* engaged: publish the snapshot of the current velocity as target */
+            xQueueOverwrite(xQueueTargetVelocity, &control.target_velocity);
         }
+        cruise_active = control.cruise_active;
 
         /* Set yellow LED for cruise active */
         BSP_SetLED(LED_YELLOW, cruise_active);
 
         xQueueOverwrite(xQueueThrottle, &throttle);
 
-        vTaskDelayUntil(&xLastWakeTime, xPeriod);
+        sup_checkin();
+        if (xTaskDelayUntil(&xLastWakeTime, xPeriod) == pdFALSE) {
+            loadmon_deadline_miss();
+        }
     }
 }
 
@@ -363,7 +350,9 @@ void vDisplayTask(void *args) {
 
         BSP_7SegDispString(display_str);
         
-        vTaskDelayUntil(&xLastWakeTime, xPeriod);   /* Wait for the next release. */
+        if (xTaskDelayUntil(&xLastWakeTime, xPeriod) == pdFALSE) {  /* Wait for the next release. */
+            loadmon_deadline_miss();
+        }
     }
 }
 
@@ -404,62 +393,32 @@ void vExtraLoadTask(void *arg)
         uint32_t busy_ms = X / 10u; /* 0..25 ms */
         if (busy_ms > 0) busy_wait(busy_ms);
 
-        vTaskDelayUntil(&xLastWake, xPeriod);
-    }
-}
-
-/* OverloadDetection task:
- * - periodically gives watchdog semaphore (OK token)
- * - if it gets starved it will not give and watchdog will detect overload
- */
-void vOverloadDetectionTask(void *arg)
-{
-    TickType_t xLastWake = xTaskGetTickCount();
-    const TickType_t xPeriod = pdMS_TO_TICKS(OVERLOAD_DETECT_PERIOD_MS);
-
-    for (;;) {
-        if (xSemaphoreWatchDogFood != NULL) {
-            xSemaphoreGive(xSemaphoreWatchDogFood);
+        if (xTaskDelayUntil(&xLastWake, xPeriod) == pdFALSE) {
+            loadmon_deadline_miss();
         }
-        vTaskDelayUntil(&xLastWake, xPeriod);
     }
 }
 
-/* Watchdog:
- * - waits for OK token with timeout 1000 ms
- * - if timeout => system overload: print and turn on all LEDs
- * - when OK returns, clear overload (turn off LEDs)
+/* Overload event (called by the load monitor in the timer service task):
+ * - overload => print and turn on all LEDs
+ * - when the load drops again, clear overload (turn off LEDs)
  */
-void vWatchDogTask(void *arg)
+static void vOverloadEvent(bool overloaded, uint16_t permille)
 {
-    const TickType_t xTimeout = pdMS_TO_TICKS(OVERLOAD_WATCHDOG_TIMEOUT_MS);
-    bool overloaded = false;
-
-    for (;;) {
-        BaseType_t got = xSemaphoreTake(xSemaphoreWatchDogFood, xTimeout);
-
-        if (got == pdTRUE) {
-            if (overloaded) {
-                overloaded = false;
-                /* clear all LEDs; main system will re-set them as appropriate */
-                BSP_SetLED(LED_RED, false);
-                BSP_SetLED(LED_GREEN, false);
-                BSP_SetLED(LED_YELLOW, false);
-                printf("Watchdog: system OK -> clearing overload.\n");
-            }
-        } else {
-            /* timeout */
-            if (!overloaded) {
-                overloaded = true;
-                printf("Watchdog: SYSTEM OVERLOAD DETECTED!\n");
-                BSP_SetLED(LED_RED, true);
-                BSP_SetLED(LED_GREEN, true);
-                BSP_SetLED(LED_YELLOW, true);
-            }
-        }
-
-        /* small sleep so this task does not loop too tightly */
-        vTaskDelay(pdMS_TO_TICKS(10));
+    if (overloaded) {
+        printf("Load monitor: SYSTEM OVERLOAD DETECTED! (load %u.%u %%, %lu misses)\n",
+               permille / 10u, permille % 10u,
+               (unsigned long)loadmon_misses(xOverloadLimits.level));
+        BSP_SetLED(LED_RED, true);
+        BSP_SetLED(LED_GREEN, true);
+        BSP_SetLED(LED_YELLOW, true);
+    } else {
+        printf("Load monitor: system OK -> clearing overload (load %u.%u %%).\n",
+               permille / 10u, permille % 10u);
+        /* clear all LEDs; main system will re-set them as appropriate */
+        BSP_SetLED(LED_RED, false);
+        BSP_SetLED(LED_GREEN, false);
+        BSP_SetLED(LED_YELLOW, false);
     }
 }
 
@@ -471,6 +430,8 @@ void vWatchDogTask(void *arg)
  *        - Adjust the priorities of the task so that they correspond
  *          to the rate-monotonic algorithm.
  * ==> MODIFIED: Converted button and control tasks to periodic, adjusted priorities
+ * ==> MODIFIED: Periods and priorities from tasks.csv (taskset.h), checked at configure time
+ * ==> MODIFIED: With CRUISE_WATCHDOG a hung Button or Control task resets the board
  * @return 
  */
 int main()
@@ -487,18 +448,27 @@ int main()
     xQueueThrottle = xQueueCreate( 1, sizeof(uint16_t));
     
     /* Create the tasks. */
-    xTaskCreate(vButtonTask, "Button Task", 512, (void*) 50, 7, &xButton_handle);
-    xTaskCreate(vVehicleTask, "Vehicle Task", 512, (void*) 100, 6, &xVehicle_handle); 
-    xTaskCreate(vControlTask, "Control Task", 512, (void*) 200, 5, &xControl_handle);
-    xTaskCreate(vDisplayTask, "Display Task", 512, (void*) 500, 4, &xDisplay_handle); 
-
-    /* ----------------- Part 3 init: create watchdog semaphore and tasks ----------------- */
-    xSemaphoreWatchDogFood = xSemaphoreCreateBinary();
-
-    /* Create Watchdog (highest), ExtraLoad (high), OverloadDetection (low) */
-    xTaskCreate(vWatchDogTask, "Watchdog", 512, (void*)1000, 10, &xWatchDog_handle);
-    xTaskCreate(vExtraLoadTask, "ExtraLoad", 512, (void*)25, 9, &xExtraLoad_handle);
-    xTaskCreate(vOverloadDetectionTask, "OverDetect", 512, NULL, 3, &xOverload_handle);
+    xTaskCreate(vButtonTask, "Button Task", 512, (void*) pdMS_TO_TICKS(TASK_BUTTON_PERIOD_MS), TASK_BUTTON_PRIORITY, &xButton_handle);
+    xTaskCreate(vVehicleTask, "Vehicle Task", 512, (void*) pdMS_TO_TICKS(TASK_VEHICLE_PERIOD_MS), TASK_VEHICLE_PRIORITY, &xVehicle_handle); 
+    xTaskCreate(vControlTask, "Control Task", 512, (void*) pdMS_TO_TICKS(TASK_CONTROL_PERIOD_MS), TASK_CONTROL_PRIORITY, &xControl_handle);
+    xTaskCreate(vDisplayTask, "Display Task", 512, (void*) pdMS_TO_TICKS(TASK_DISPLAY_PERIOD_MS), TASK_DISPLAY_PRIORITY, &xDisplay_handle); 
+
+    /* ----------------- Part 3 init: load monitor and extra load ----------------- */
+    loadmon_init(&xOverloadLimits, vOverloadEvent);
+
+    /* Create ExtraLoad (high) */
+    xTaskCreate(vExtraLoadTask, "ExtraLoad", 512, (void*) pdMS_TO_TICKS(TASK_EXTRALOAD_PERIOD_MS), TASK_EXTRALOAD_PRIORITY, &xExtraLoad_handle);
+
+#if CRUISE_WATCHDOG
+    /* Watchdog supervisor of the tasks that may be modified; the Vehicle task stays as given.
+     * Print the record if the last reset was the watchdog */
+    sup_init(WATCHDOG_TIMEOUT_MS, pdMS_TO_TICKS(WATCHDOG_CHECK_MS));
+    sup_register(xButton_handle, WATCHDOG_WINDOW_PERIODS * TASK_BUTTON_PERIOD_MS);
+    sup_register(xControl_handle, WATCHDOG_WINDOW_PERIODS * TASK_CONTROL_PERIOD_MS);
+    if (sup_last_reset() != NULL) {
+        sup_report();
+    }
+#endif
 
     vTaskStartScheduler();  /* Start the scheduler. */
     
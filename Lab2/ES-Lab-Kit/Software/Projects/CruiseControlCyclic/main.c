@@ -0,0 +1,429 @@
+/**
+ * @file main.c
+ * @author Harsh Roniyar (roniyar@kth.se)
+ *
+ * @version 0.1
+ * @date 2025-10-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * The tasks of CruiseControlBasic as job functions, run either by the
+ * time-triggered cyclic executive (cyclic.h) or by the preemptive FreeRTOS
+ * scheduler, selected with the CMake option CRUISE_CYCLIC. Both builds
+ * record the same job statistics; SW_8 prints them, so the start jitter and
+ * the CPU overhead of the two schedulers can be compared directly.
+ * The preemptive build also prints the stack profile of its tasks.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/stdlib.h"
+#include "hardware/timer.h"
+#include "hardware/sync.h"
+#include "bsp.h"
+#include "cruise_core.h"
+#include "blackboard.h"
+#include "terrain.h"
+#include "cyclic.h"
+#include "loadmon.h"
+#include "stackprof.h"
+#include "taskset.h"                /* Periods and priorities of tasks.csv */
+#include "cyclic_table.h"           /* Frame table of tasks.csv */
+
+#ifndef CRUISE_CYCLIC
+#define CRUISE_CYCLIC 0
+#endif
+
+#define GAS_STEP 2  /* Defines how much the throttle is increased if GAS_STEP is asserted */
+
+/* Step controller of the lab, shared with the host simulator (see cruise_core.h) */
+static const cruise_control_config_t xControlConfig = {
+    .throttle_max = 80,
+    .gas_step = GAS_STEP,
+    .cruise_min_velocity = 250,     /* Minimum velocity for cruise control to be active */
+    .error_band = 40,
+    .cruise_step = 3,
+    .pi = NULL,
+};
+
+/* Track profile of the lab (see terrain.h) */
+#define TRACK_LENGTH            24000u  /* adjust_position() wraps here */
+#define TRACK_MIN_SEGMENT       4000u   /* Shortest segment of the track */
+static terrain_map_t xTrack;
+static uint16_t xTrackIndex[TERRAIN_INDEX_LEN(TRACK_LENGTH, TRACK_MIN_SEGMENT)];
+
+static const cruise_vehicle_config_t xVehicleConfig = {
+    .track = &xTrack,
+    .substep_us = 0u,
+};
+
+/* Shared state of the jobs (see blackboard.h); needed by the preemptive build only, the
+ * cyclic executive never runs two jobs at the same time */
+static blackboard_t xBoard;
+
+/* State of the jobs, kept between their releases */
+static cruise_buttons_t xButtons;
+static cruise_control_t xControl;
+static uint32_t xControlVehicleGen;
+static cruise_vehicle_t xVehicle;
+static bool xReportButton;
+
+/* Job statistics of both builds, and the frame table state of the cyclic executive */
+static cyclic_t xExec;
+
+static void request_report(void);
+
+/**
+ * @brief Button job: samples the buttons and publishes the pedals; a
+ *        negative edge of SW_8 prints the report.
+ */
+static void vButtonJob(void) {
+    cruise_pedals_t pressed;
+    bool raw_sw8 = BSP_GetInput(SW_8);  /* active-low */
+
+    cruise_buttons_step(&xButtons, BSP_GetInput(SW_7), BSP_GetInput(SW_5), BSP_GetInput(SW_6), &pressed);
+    blackboard_write_pedals(&xBoard, &(bb_pedals_t){ .gas = pressed.gas, .brake = pressed.brake,
+                                                     .cruise = pressed.cruise });
+
+    if ((raw_sw8 != xReportButton) && (raw_sw8 == false)) {
+        request_report();
+    }
+    xReportButton = raw_sw8;
+}
+
+/**
+ * @brief Vehicle job: advances the vehicle by one period.
+ */
+static void vVehicleJob(void) {
+    bb_pedals_t pedals;
+    bb_control_t control;
+
+    blackboard_read_control(&xBoard, &control);
+    blackboard_read_pedals(&xBoard, &pedals);
+    cruise_vehicle_step(&xVehicleConfig, &xVehicle, control.throttle, pedals.brake, TASK_VEHICLE_PERIOD_MS);
+    blackboard_write_vehicle(&xBoard, &(bb_vehicle_t){ .velocity = xVehicle.velocity,
+                                                       .position = xVehicle.position });
+}
+
+/**
+ * @brief Control job: computes the throttle.
+ */
+static void vControlJob(void) {
+    bb_pedals_t pedals;
+    bb_vehicle_t vehicle;
+    uint32_t vehicle_gen;
+    uint16_t throttle;
+
+    blackboard_read_pedals(&xBoard, &pedals);
+    vehicle_gen = blackboard_read_vehicle(&xBoard, &vehicle);
+
+    /* The Vehicle job (100 ms) must have published since the last job (200 ms) */
+    throttle = cruise_control_step(&xControlConfig, &xControl,
+                                   &(cruise_pedals_t){ pedals.gas, pedals.brake, pedals.cruise },
+                                   vehicle.velocity, vehicle.position, vehicle_gen != xControlVehicleGen);
+    xControlVehicleGen = vehicle_gen;
+
+    BSP_SetLED(LED_YELLOW, xControl.cruise_active);
+    blackboard_write_control(&xBoard, &(bb_control_t){ .throttle = throttle,
+                                                       .target_velocity = xControl.target_velocity,
+                                                       .cruise_active = xControl.cruise_active });
+}
+
+/**
+ * @brief Function to write the position on the 24 LEDs
+ *
+ * @param position The position to display
+ */
+void write_position(uint16_t position) {
+    uint32_t led_reg = 0u;
+    int led_index = (position / 1000u); /* 0..23 */
+    if (led_index < 0) led_index = 0;
+    if (led_index > 23) led_index = 23;
+
+    led_reg = (1u << led_index); /* a single bit set */
+
+    /* LSB-first byte order as required by BSP_ShiftRegWriteAll */
+    uint8_t bytes[3];
+    bytes[2] = (uint8_t)((led_reg >> 16) & 0xFFu);
+    bytes[1] = (uint8_t)((led_reg >> 8) & 0xFFu);
+    bytes[0] = (uint8_t)((led_reg) & 0xFFu);
+
+    BSP_ShiftRegWriteAll(bytes);
+}
+
+/**
+ * @brief Display job: throttle and velocity on the seven segment display,
+ *        the position on the 24 LEDs and the serial output.
+ */
+static void vDisplayJob(void) {
+    bb_pedals_t pedals;
+    bb_vehicle_t vehicle;
+    bb_control_t control;
+    char display_str[9];   /* enough for "TTVV\0" and extras */
+
+    blackboard_read_pedals(&xBoard, &pedals);
+    blackboard_read_vehicle(&xBoard, &vehicle);
+    blackboard_read_control(&xBoard, &control);
+
+    printf("Throttle: %d\n", control.throttle);
+    printf("Velocity: %d\n", vehicle.velocity);
+    printf("Position: %d\n", vehicle.position);
+
+    sprintf(display_str, "%02d%02d", control.throttle, vehicle.velocity / 10);
+
+    write_position(vehicle.position);        /* 24 LEDs */
+    BSP_SetLED(LED_GREEN, pedals.gas);
+    BSP_SetLED(LED_YELLOW, pedals.cruise);
+    BSP_SetLED(LED_RED, pedals.brake);
+
+    BSP_7SegDispString(display_str);
+}
+
+/* Job functions in the order of tasks.csv (CYCLIC_TASK_*) */
+static const cyclic_job_t xJobs[CYCLIC_TASKS] = {
+    [CYCLIC_TASK_BUTTON] = vButtonJob,
+    [CYCLIC_TASK_VEHICLE] = vVehicleJob,
+    [CYCLIC_TASK_CONTROL] = vControlJob,
+    [CYCLIC_TASK_DISPLAY] = vDisplayJob,
+};
+
+static uint32_t clock_us(void) {
+    return time_us_32();
+}
+
+#if CRUISE_CYCLIC
+/* ----------------- Cyclic executive: one timer interrupt per frame ----------------- */
+
+static uint xFrameAlarm;
+static uint64_t xFrameStart_us;         /* Ideal start of the next frame */
+static volatile bool xReportRequested;
+static uint64_t xIsrBusy_us;            /* Time in vFrameIsr(), the busy time of the report */
+
+static void request_report(void) {
+    xReportRequested = true;            /* Printed by main() between two frames */
+}
+
+/**
+ * @brief Frame interrupt: arms the next frame and runs the jobs of this one.
+ *        A frame that overruns makes the next interrupt pending at once, so
+ *        the next frame starts late instead of being skipped.
+ *
+ * The whole interrupt, re-arming the alarm included, counts as busy time,
+ * as the tick interrupt and the context switches do in the preemptive
+ * build. Only the exception entry and the SDK's alarm dispatch before the
+ * first clock read are left out.
+ */
+static void vFrameIsr(uint alarm_num) {
+    uint32_t entered_us = time_us_32();
+    uint64_t start_us = xFrameStart_us;
+
+    xFrameStart_us += CYCLIC_FRAME_US;
+    if (hardware_alarm_set_target(alarm_num, from_us_since_boot(xFrameStart_us))) {
+        hardware_alarm_force_irq(alarm_num);    /* Already missed by an earlier overrun */
+    }
+    (void)cyclic_run_frame(&xExec, (uint32_t)start_us);
+    xIsrBusy_us += time_us_32() - entered_us;
+}
+
+static void start_frames(void) {
+    cyclic_restart(&xExec);
+    xFrameStart_us = time_us_64() + CYCLIC_FRAME_US;
+    hardware_alarm_set_target(xFrameAlarm, from_us_since_boot(xFrameStart_us));
+}
+
+/**
+ * @brief Main program: starts the cyclic executive and prints the report on SW_8.
+ *
+ * The executive is paused while the report is printed, the jobs' printf must
+ * not wait for it in the interrupt. It restarts with frame 0; the pause does
+ * not count as measurement time.
+ */
+int main()
+{
+    uint64_t elapsed_us = 0;
+    uint64_t run_start_us;
+
+    BSP_Init();  /* Initialize all components on the ES Lab-Kit. */
+
+    if (!terrain_init(&xTrack, terrain_lab_track, terrain_lab_track_count, TRACK_LENGTH,
+                      xTrackIndex, sizeof(xTrackIndex) / sizeof(xTrackIndex[0]))) {
+        printf("Track profile does not fit the index!\n");
+        for (;;) { }
+    }
+    blackboard_init(&xBoard);
+    cruise_buttons_init(&xButtons, BSP_GetInput(SW_6)); /* raw read, active-low: pressed -> 0 */
+    cruise_control_init(&xControl);
+    cruise_vehicle_init(&xVehicle, 0, 0);
+    xReportButton = BSP_GetInput(SW_8);
+    cyclic_init(&xExec, &cyclic_table, xJobs, CYCLIC_TASKS, clock_us);
+
+    printf("Cyclic executive: %u frames of %lu us per %u ms\n", (unsigned)CYCLIC_FRAMES,
+           (unsigned long)CYCLIC_FRAME_US, (unsigned)CYCLIC_HYPERPERIOD_MS);
+
+    xFrameAlarm = (uint)hardware_alarm_claim_unused(true);
+    hardware_alarm_set_callback(xFrameAlarm, vFrameIsr);
+    run_start_us = time_us_64();
+    start_frames();
+
+    for (;;) {
+        __wfi();    /* Sleep until the next frame */
+        if (xReportRequested) {
+            hardware_alarm_cancel(xFrameAlarm);
+            elapsed_us += time_us_64() - run_start_us;
+
+            printf("Scheduler: cyclic executive\n");
+            cyclic_report(&xExec, cyclic_task_names, elapsed_us, xIsrBusy_us, stdout);
+
+            xReportRequested = false;
+            run_start_us = time_us_64();
+            start_frames();
+        }
+    }
+
+    return 0;
+}
+
+#else
+/* ----------------- Preemptive build: one FreeRTOS task per job ----------------- */
+
+static const TickType_t xPeriods[CYCLIC_TASKS] = {
+    [CYCLIC_TASK_BUTTON] = pdMS_TO_TICKS(TASK_BUTTON_PERIOD_MS),
+    [CYCLIC_TASK_VEHICLE] = pdMS_TO_TICKS(TASK_VEHICLE_PERIOD_MS),
+    [CYCLIC_TASK_CONTROL] = pdMS_TO_TICKS(TASK_CONTROL_PERIOD_MS),
+    [CYCLIC_TASK_DISPLAY] = pdMS_TO_TICKS(TASK_DISPLAY_PERIOD_MS),
+};
+
+static const UBaseType_t xPriorities[CYCLIC_TASKS] = {
+    [CYCLIC_TASK_BUTTON] = TASK_BUTTON_PRIORITY,
+    [CYCLIC_TASK_VEHICLE] = TASK_VEHICLE_PRIORITY,
+    [CYCLIC_TASK_CONTROL] = TASK_CONTROL_PRIORITY,
+    [CYCLIC_TASK_DISPLAY] = TASK_DISPLAY_PRIORITY,
+};
+
+/* Stack depths in words; SW_8 also prints the profiler's recommendation (see stackprof.h) */
+#define JOB_STACK_WORDS         512u
+#define REPORT_STACK_WORDS      512u
+
+static TaskHandle_t xReport_handle;
+static uint32_t xStart_us;              /* Time of tick 0 */
+static bool xStarted;
+
+/* Load monitor, only used for the idle time; the thresholds are never reached */
+static const loadwin_limits_t xLimits = {
+    .level = LOADWIN_1S,
+    .enter_permille = 1001,
+    .exit_permille = 1000,
+    .miss_limit = 0,
+};
+
+static void request_report(void) {
+    xTaskNotifyGive(xReport_handle);
+}
+
+/**
+ * @brief Periodic task running one job function.
+ *
+ * The release of a job is its wake-up tick. Tick 0 is the start of the
+ * first job, which runs right after the scheduler starts; the start
+ * latency of the later jobs thus includes the tick interrupt and the
+ * context switch, and the spread is the release jitter. The statistics are
+ * updated in a critical section, a higher-priority job may preempt the job.
+ *
+ * @param args Task index in tasks.csv.
+ */
+static void vPeriodicTask(void *args) {
+    const uint8_t task = (uint8_t)(uintptr_t)args;
+    const TickType_t xPeriod = xPeriods[task];
+    TickType_t xLastWakeTime = 0;
+
+    for (;;) {
+        taskENTER_CRITICAL();
+        if (!xStarted) {
+            xStart_us = time_us_32();
+            xStarted = true;
+        }
+        cyclic_job_begin(&xExec, task, xStart_us + xLastWakeTime * portTICK_PERIOD_MS * 1000u);
+        taskEXIT_CRITICAL();
+
+        xJobs[task]();
+
+        taskENTER_CRITICAL();
+        cyclic_job_end(&xExec);
+        taskEXIT_CRITICAL();
+
+        vTaskDelayUntil(&xLastWakeTime, xPeriod);   /* Wait for the next release. */
+    }
+}
+
+/**
+ * @brief Prints the report on SW_8. Runs above idle only, so it does not
+ *        delay the jobs except for sharing printf with the Display task.
+ *
+ * @param args
+ */
+static void vReportTask(void *args) {
+    static cyclic_t snapshot;
+    uint32_t elapsed_us;
+    uint32_t idle_us;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        taskENTER_CRITICAL();
+        snapshot = xExec;
+        elapsed_us = time_us_32() - xStart_us;
+        idle_us = loadmon_core_idle_us(0);
+        taskEXIT_CRITICAL();
+
+        printf("Scheduler: preemptive (FreeRTOS, fixed priorities)\n");
+        cyclic_report(&snapshot, cyclic_task_names, elapsed_us,
+                      (idle_us < elapsed_us) ? elapsed_us - idle_us : 0, stdout);
+        stackprof_report();     /* The high-water marks persist, no sampling timer disturbs the jobs */
+    }
+}
+
+/**
+ * @brief Main program that starts all the tasks and the scheduler
+ *
+ * ==> MODIFIED: One task per job function, periods and priorities from tasks.csv
+ * @return
+ */
+int main()
+{
+    BSP_Init();  /* Initialize all components on the ES Lab-Kit. */
+
+    if (!terrain_init(&xTrack, terrain_lab_track, terrain_lab_track_count, TRACK_LENGTH,
+                      xTrackIndex, sizeof(xTrackIndex) / sizeof(xTrackIndex[0]))) {
+        printf("Track profile does not fit the index!\n");
+        for (;;) { }
+    }
+    blackboard_init(&xBoard);
+    cruise_buttons_init(&xButtons, BSP_GetInput(SW_6)); /* raw read, active-low: pressed -> 0 */
+    cruise_control_init(&xControl);
+    cruise_vehicle_init(&xVehicle, 0, 0);
+    xReportButton = BSP_GetInput(SW_8);
+    cyclic_init(&xExec, NULL, NULL, CYCLIC_TASKS, clock_us);
+    loadmon_init(&xLimits, NULL);
+
+    /* Create the tasks. */
+    for (uint8_t i = 0; i < CYCLIC_TASKS; i++) {
+        TaskHandle_t xHandle;
+
+        if (xTaskCreate(vPeriodicTask, cyclic_task_names[i], JOB_STACK_WORDS, (void *)(uintptr_t)i,
+                        xPriorities[i], &xHandle) != pdPASS) {
+            printf("%s task not created!\n", cyclic_task_names[i]);
+            for (;;) { }
+        }
+        stackprof_track(xHandle, JOB_STACK_WORDS);
+    }
+    xTaskCreate(vReportTask, "Report", REPORT_STACK_WORDS, NULL, tskIDLE_PRIORITY + 1, &xReport_handle);
+    stackprof_track(xReport_handle, REPORT_STACK_WORDS);
+
+    vTaskStartScheduler();  /* Start the scheduler. */
+
+    return 0;
+}
+#endif /* CRUISE_CYCLIC */
+/*-----------------------------------------------------------*/
@@ -45,7 +45,7 @@
 #define configUSE_PREEMPTION                    1
 #define configUSE_TICKLESS_IDLE                 0
 #define configUSE_IDLE_HOOK                     0
-#define configUSE_TICK_HOOK                     0
+#define configUSE_TICK_HOOK                     1
 #define configTICK_RATE_HZ                      ( ( TickType_t ) 1000 )
 #define configMAX_PRIORITIES                    32
 #define configMINIMAL_STACK_SIZE                ( configSTACK_DEPTH_TYPE ) 512 
@@ -78,8 +78,12 @@
 #define configKERNEL_PROVIDED_STATIC_MEMORY     1
 
 /* Hook function related definitions. */
+#ifndef NDEBUG
+#define configCHECK_FOR_STACK_OVERFLOW          2   /* Debug builds: check the painted stack end */
+#else
 #define configCHECK_FOR_STACK_OVERFLOW          0
-#define configUSE_MALLOC_FAILED_HOOK            0
+#endif
+#define configUSE_MALLOC_FAILED_HOOK            1
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
 /* Run time and task stats gathering related definitions. */
@@ -114,6 +118,7 @@
 #define configRUN_MULTIPLE_PRIORITIES           1
 #if configNUMBER_OF_CORES > 1
 #define configUSE_CORE_AFFINITY                 1
+#define configTIMER_SERVICE_TASK_CORE_AFFINITY  ( 1 << 0 )  /* Monitor reports print on the I/O core */
 #endif
 #define configUSE_PASSIVE_IDLE_HOOK             0
 #endif
@@ -153,6 +158,19 @@ to exclude the API function. */
 #define configMAX_SYSCALL_INTERRUPT_PRIORITY    16
 #endif
 
+/* Application monitoring modules (Software/rtos). */
+#define appUSE_LOAD_MONITOR                     1
+#define appUSE_BUDGET_MONITOR                   1
+#define appUSE_STACK_PROFILER                   1
+#define appUSE_HEAP_MONITOR                     1
+#define appUSE_LATENCY_TRACE                    1
+#define appUSE_EDF_SCHEDULER                    1
+#define appUSE_ADMISSION_CONTROL                1
+#define appUSE_APERIODIC_SERVER                 1
+#define appUSE_CRITICALITY_MODE                 1
+#define appUSE_WATCHDOG_SUPERVISOR              1
+
 /* A header file that defines trace macro can be included here. */
+#include "rtos_hooks.h"
 
 #endif /* FREERTOS_CONFIG_H */
\ No newline at end of file
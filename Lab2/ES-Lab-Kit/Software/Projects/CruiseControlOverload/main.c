@@ -12,44 +12,357 @@
 #include <stdio.h>
 #include "FreeRTOS.h"
 #include "task.h"
-#include "queue.h"
-#include "semphr.h"
 #include "bsp.h"
+#include "blackboard.h"
+#include "cruise_core.h"
+#include "inputrec.h"
+#include "loadmon.h"
+#include "budget.h"
+#include "stackprof.h"
+#include "heapmon.h"
+#include "latency.h"
+#include "edf.h"
+#include "admit.h"
+#include "server.h"
+#include "critmode.h"
+#include "supervisor.h"
+#include "taskset.h"                /* Periods, priorities and WCETs of tasks.csv */
 #include "hardware/clocks.h"
+#include "hardware/uart.h"
+#include "hardware/irq.h"
 
 #define GAS_STEP 2  /* Defines how much the throttle is increased if GAS_STEP is asserted */
 
+/* Cruise controller: the CMake option CRUISE_USE_PI_CONTROLLER replaces the
+ * +-3 step controller by the gain-scheduled PI controller (see cruise_pi.h) */
+#ifndef CRUISE_USE_PI_CONTROLLER
+#define CRUISE_USE_PI_CONTROLLER 0
+#endif
+#define SEGMENT_LENGTH 4000u    /* Track segments of the gain table (0.1 m) */
+
+/* Application logic, the same as in the host simulator (see cruise_core.h) */
+static const cruise_control_config_t xControlConfig = {
+    .throttle_max = 80,
+    .gas_step = GAS_STEP,
+    .cruise_min_velocity = 250,     /* Minimum velocity for cruise control to be active */
+    .error_band = 40,
+    .cruise_step = 3,
+    .pi = CRUISE_USE_PI_CONTROLLER ? &cruise_pi_default : NULL,
+    .segment_length = SEGMENT_LENGTH,
+};
+
 /* Definition of handles for tasks */
 TaskHandle_t    xButton_handle; /* Handle for the Button task */
 TaskHandle_t    xControl_handle; /* Handle for the Control task */
 TaskHandle_t    xVehicle_handle; /* Handle for the Vehicle task */
 TaskHandle_t    xDisplay_handle; /* Handle for the Display task */
-TaskHandle_t    xWatchDog_handle; /* Handle for the Watchdog task */
-TaskHandle_t    xOverload_handle; /* Handle for the OverloadDetection task */
 TaskHandle_t    xExtraLoad_handle; /* Handle for the ExtraLoad task */
 
-/* Definition of handles for queues */
-QueueHandle_t xQueueVelocity;
-QueueHandle_t xQueuePosition;
-QueueHandle_t xQueueThrottle;
-QueueHandle_t xQueueTargetVelocity;
-QueueHandle_t xQueueCruiseControl;
-QueueHandle_t xQueueGasPedal;
-QueueHandle_t xQueueBrakePedal;
+/* Shared state: one section per writing task, read without locking (see blackboard.h) */
+static blackboard_t xBoard;
 
-/* ---------------- Part 3 globals ------------------ */
-/* Watchdog semaphore (OK token) */
-SemaphoreHandle_t xSemaphoreWatchDogFood = NULL;
+/* Track profile: segment table in flash, position lookup index in RAM (see terrain.h) */
+#define TRACK_LENGTH            24000u  /* adjust_position() wraps here */
+#define TRACK_MIN_SEGMENT       4000u   /* Shortest segment of the track */
+static terrain_map_t xTrack;
+static uint16_t xTrackIndex[TERRAIN_INDEX_LEN(TRACK_LENGTH, TRACK_MIN_SEGMENT)];
+
+/* Vehicle physics: the CMake option CRUISE_USE_VEHICLE_MODEL replaces adjust_position()/
+ * adjust_velocity() by the fixed-point model, integrated in 1 ms sub-steps (see vehicle_model.h) */
+#ifndef CRUISE_USE_VEHICLE_MODEL
+#define CRUISE_USE_VEHICLE_MODEL 0
+#endif
+#define VEHICLE_SUBSTEP_US      1000u
+
+static const cruise_vehicle_config_t xVehicleConfig = {
+    .track = &xTrack,
+    .substep_us = CRUISE_USE_VEHICLE_MODEL ? VEHICLE_SUBSTEP_US : 0u,
+};
 
-/* Part3 constants */
-#define OVERLOAD_WATCHDOG_TIMEOUT_MS 1000u
-#define OVERLOAD_DETECT_PERIOD_MS   100u
-#define EXTRA_LOAD_PERIOD_MS        25u
+/* Cause-effect chains, both end when the Vehicle task reads the throttle */
+static int xBrakeChain;         /* SW_5 pressed -> throttle 0 */
+static int xGasChain;           /* SW_7 pressed -> throttle raised */
+
+/* ---------------- Part 3 globals ------------------ */
+/* Load monitor thresholds:
+ * - overload if the last 100 ms were at least 95 % busy or contain a deadline miss
+ * - cleared again once the load drops below 80 % without misses
+ */
+static const loadwin_limits_t xOverloadLimits = {
+    .level = LOADWIN_100MS,
+    .enter_permille = 950,
+    .exit_permille = 800,
+    .miss_limit = 1,
+};
+
+/* Input record/replay (see inputrec.h): the CMake option CRUISE_INPUT_RECORD logs every
+ * Button sample with the accelerometer, SW_8 dumps the log over the UART; CRUISE_INPUT_REPLAY
+ * feeds the log compiled in from input_replay.h (cruise_sim -c) to the tasks instead */
+#ifndef CRUISE_INPUT_RECORD
+#define CRUISE_INPUT_RECORD         0
+#endif
+#ifndef CRUISE_INPUT_REPLAY
+#define CRUISE_INPUT_REPLAY         0
+#endif
+#if CRUISE_INPUT_RECORD && CRUISE_INPUT_REPLAY
+#error "CRUISE_INPUT_RECORD and CRUISE_INPUT_REPLAY exclude each other"
+#endif
+#define INPUT_BUTTONS               ((1u << INPUTREC_SW_10) - 1u)   /* SW_5..SW_8, active-low */
+#define INPUT_LEVEL(inputs, sw)     ((((inputs) >> INPUTREC_##sw) & 1u) != 0)
+#define PSRAM_BASE                  0x11000000u     /* XIP window of the PSRAM (chip select 1) */
+#define RECORD_PSRAM_BYTES          (1024u * 1024u) /* About 4 h of Button samples */
+#define RECORD_SRAM_BLOCKS          64u             /* 16 KB, about 4 min, without PSRAM */
+
+/* Bit INPUTREC_SW_x of a sample is the level of xInputPins[INPUTREC_SW_x] */
+static const uint32_t xInputPins[INPUTREC_INPUTS] = {
+    SW_5, SW_6, SW_7, SW_8, SW_10, SW_11, SW_12, SW_13, SW_14, SW_15, SW_16, SW_17
+};
+static volatile uint32_t xInputs = INPUT_BUTTONS;   /* Last sample: buttons released, switches off */
+
+#if CRUISE_INPUT_RECORD
+TaskHandle_t    xInputDump_handle; /* Handle for the InputDump task */
+static inputrec_t xRecorder;
+static inputrec_block_t xRecordSram[RECORD_SRAM_BLOCKS];
+static volatile bool xDumping;      /* Recording paused while the InputDump task prints it */
+#elif CRUISE_INPUT_REPLAY
+#include "input_replay.h"           /* xReplayBlocks[], generated by cruise_sim -c */
+static inputrec_reader_t xReplay;
+#endif
+
+/* Execution-time budgets per job (see budget.h): the WCETs of tasks.csv, which pass the
+ * response-time analysis when the project is configured */
+#if CRUISE_INPUT_RECORD
+#define BUTTON_BUDGET_US            (TASK_BUTTON_WCET_US + 1000u)   /* + accelerometer read over I2C */
+#else
+#define BUTTON_BUDGET_US            TASK_BUTTON_WCET_US
+#endif
+#define CONTROL_BUDGET_US           TASK_CONTROL_WCET_US
+#define DISPLAY_BUDGET_US           TASK_DISPLAY_WCET_US            /* printf over UART dominates */
+#define EXTRA_LOAD_BUDGET_US        TASK_EXTRALOAD_WCET_US          /* demoted beyond this, protects the control loop */
+
+/* Stack depths in words; press SW_8 for the profiler's recommendation (see stackprof.h) */
+#define BUTTON_STACK_WORDS          512u
+#define VEHICLE_STACK_WORDS         512u
+#define CONTROL_STACK_WORDS         512u
+#define DISPLAY_STACK_WORDS         512u
+#define EXTRA_LOAD_STACK_WORDS      512u
+#define INPUT_DUMP_STACK_WORDS      512u
+#define STACKPROF_PERIOD_MS         100u
+#define HEAPMON_PERIOD_MS           1000u
+
+/* Execution mode: the CMake option CRUISE_EVENT_CHAINED runs Control and Display
+ * on task notifications instead of their own periods:
+ * every 2nd Vehicle publish -> Control runs at once -> every 3rd Control job -> Display.
+ * Control keeps the 200 ms of tasks.csv, so admission, EDF and the watchdog windows hold;
+ * Display runs every 600 ms, no more often than the declared 500 ms */
+#ifndef CRUISE_EVENT_CHAINED
+#define CRUISE_EVENT_CHAINED        0
+#endif
+#define CONTROL_DECIMATION          (TASK_CONTROL_PERIOD_MS / TASK_VEHICLE_PERIOD_MS)
+#define DISPLAY_DECIMATION          ((TASK_DISPLAY_PERIOD_MS + TASK_CONTROL_PERIOD_MS - 1u) / TASK_CONTROL_PERIOD_MS)
+
+/* Scheduling: the CMake option CRUISE_EDF schedules the periodic tasks earliest deadline
+ * first (edf.h) within the priorities EDF_BASE_PRIORITY.. instead of the fixed
+ * rate-monotonic priorities; task sets above the RM bound but below 100 % stay schedulable */
+#ifndef CRUISE_EDF
+#define CRUISE_EDF                  0
+#endif
+#if CRUISE_EDF && CRUISE_EVENT_CHAINED
+#error "CRUISE_EDF needs the periodic tasks, not CRUISE_EVENT_CHAINED"
+#endif
+#define EDF_BASE_PRIORITY           4u
+
+/* Admission control: the CMake option CRUISE_ADMISSION_CONTROL (ON by default) runs a new
+ * ExtraLoad setting only if the control loop stays schedulable (admit.h), at up to
+ * EXTRA_LOAD_MAX_PERIOD_MS; turn it OFF to overload the system on purpose */
+#ifndef CRUISE_ADMISSION_CONTROL
+#define CRUISE_ADMISSION_CONTROL    0
+#endif
+#define EXTRA_LOAD_MAX_PERIOD_MS    100u
+#define EXTRA_LOAD_OVERHEAD_US      500u    /* Switch reads and tick granularity of busy_wait() */
+
+/* Aperiodic server: the CMake option CRUISE_APERIODIC_SERVER runs the ExtraLoad busy work and
+ * the commands received on CN1 as jobs of a sporadic server (server.h). It has the ExtraLoad
+ * reservation of tasks.csv, its WCET every period at its priority; beyond that the jobs only
+ * get idle time, however high X is. ExtraLoad itself just reads the switches and queues a job */
+#ifndef CRUISE_APERIODIC_SERVER
+#define CRUISE_APERIODIC_SERVER     0
+#endif
+#define ADMIT_EXTRA_LOAD            (CRUISE_ADMISSION_CONTROL && !CRUISE_APERIODIC_SERVER)
+#define SERVER_BUDGET_US            TASK_EXTRALOAD_WCET_US
+#define SERVER_BACKGROUND_PRIORITY  ( tskIDLE_PRIORITY + 1 )
+#define SERVER_QUEUE_LENGTH         8u
+#define SERVER_STACK_WORDS          512u
+
+#if CRUISE_APERIODIC_SERVER
+static const server_config_t xServerConfig = {
+    .name = "Aperiodic",
+    .budget_us = SERVER_BUDGET_US,
+    .period = pdMS_TO_TICKS(TASK_EXTRALOAD_PERIOD_MS),
+    .priority = TASK_EXTRALOAD_PRIORITY,
+    .background_priority = SERVER_BACKGROUND_PRIORITY,
+    .queue_length = SERVER_QUEUE_LENGTH,
+    .stack_words = SERVER_STACK_WORDS,
+};
+static server_t *xAperiodicServer;
+#endif
+
+/* Mixed criticality: the CMake option CRUISE_MIXED_CRITICALITY (ON by default) switches to HI
+ * mode on an overload event (critmode.h). Button, Vehicle and Control are HI; ExtraLoad is
+ * suspended and Display runs DISPLAY_STRETCH times slower until the load monitor has cleared
+ * the overload and the system stayed calm for CRIT_HOLD_MS */
+#ifndef CRUISE_MIXED_CRITICALITY
+#define CRUISE_MIXED_CRITICALITY    0
+#endif
+#define CRIT_HOLD_MS                2000u
+#define DISPLAY_STRETCH             4u      /* 500 ms -> 2 s */
+
+/* Watchdog: the CMake option CRUISE_WATCHDOG (ON by default) arms the hardware watchdog
+ * (supervisor.h). It is fed only while Button, Vehicle and Control each check in within
+ * WATCHDOG_WINDOW_PERIODS of their periods; a hung control loop resets the board, and the
+ * next start prints which task missed its window and what ran last on each core */
+#ifndef CRUISE_WATCHDOG
+#define CRUISE_WATCHDOG             0
+#endif
+#define WATCHDOG_TIMEOUT_MS         500u
+#define WATCHDOG_CHECK_MS           50u
+#define WATCHDOG_WINDOW_PERIODS     5u
+
+/* Core assignment of the SMP build (CMake option CRUISE_SMP sets configNUMBER_OF_CORES 2):
+ * the control loop has core 1 to itself, so the ExtraLoad switches cannot starve it;
+ * Display, ExtraLoad, printf and the timer service task share core 0 with the tick */
+#define CONTROL_CORE_MASK           (1u << 1)
+#define IO_CORE_MASK                (1u << 0)
+
+/* Object allocation: the CMake option CRUISE_STATIC_ALLOCATION creates all tasks
+ * from the static buffers below instead of the FreeRTOS heap */
+#ifndef CRUISE_STATIC_ALLOCATION
+#define CRUISE_STATIC_ALLOCATION    0
+#endif
+
+#if CRUISE_STATIC_ALLOCATION
+#define TASK_BUFFERS(name, words)   static StackType_t name##_stack[words]; static StaticTask_t name##_tcb
+#define CREATE_TASK(name, fn, label, words, param, prio) \
+    (name##_handle = xTaskCreateStatic(fn, label, words, param, prio, name##_stack, &name##_tcb))
+
+TASK_BUFFERS(xButton, BUTTON_STACK_WORDS);
+TASK_BUFFERS(xVehicle, VEHICLE_STACK_WORDS);
+TASK_BUFFERS(xControl, CONTROL_STACK_WORDS);
+TASK_BUFFERS(xDisplay, DISPLAY_STACK_WORDS);
+TASK_BUFFERS(xExtraLoad, EXTRA_LOAD_STACK_WORDS);
+#if CRUISE_INPUT_RECORD
+TASK_BUFFERS(xInputDump, INPUT_DUMP_STACK_WORDS);
+#endif
+#else
+#define CREATE_TASK(name, fn, label, words, param, prio) \
+    xTaskCreate(fn, label, words, param, prio, &name##_handle)
+#endif
 
 /* Forward prototypes for new tasks */
-void vWatchDogTask(void *arg);
-void vOverloadDetectionTask(void *arg);
 void vExtraLoadTask(void *arg);
+#if CRUISE_INPUT_RECORD
+void vInputDumpTask(void *arg);
+#endif
+static void vOverloadEvent(bool overloaded, uint16_t permille);
+
+/**
+ * @brief Ends the job of a periodic task and waits for the next release. With CRUISE_EDF
+ *        the completion first re-assigns the priorities by the next deadlines. A LO task
+ *        in HI mode sheds its next jobs here (CRUISE_MIXED_CRITICALITY). The job checks in
+ *        with the watchdog supervisor (CRUISE_WATCHDOG).
+ *
+ * @return BaseType_t pdFALSE if the job missed its deadline or was released late
+ */
+static BaseType_t wait_next_period(TickType_t *pxLastWakeTime, TickType_t xPeriod) {
+    BaseType_t on_time = edf_job_done();    /* No-op for tasks that are not EDF tasks */
+    sup_checkin();                          /* No-op for tasks that are not supervised */
+    TickType_t xRelease = *pxLastWakeTime;
+    TickType_t xNext = crit_job_done(pxLastWakeTime, xPeriod);  /* xPeriod for HI tasks */
+
+    if ((xNext != xPeriod) || (*pxLastWakeTime != xRelease)) {
+        edf_set_release(*pxLastWakeTime + xNext);   /* The shed jobs have no EDF deadlines */
+    }
+    return (budget_wait_next_period(pxLastWakeTime, xNext) == pdTRUE) ? on_time : pdFALSE;
+}
+
+/**
+ * @brief Ends the test run: prints the stack, heap, latency and load profile (and the
+ *        input recording) from the timer service task
+ */
+static void request_reports(void) {
+    stackprof_request_report();
+    heapmon_request_report();
+    latency_request_report();
+    loadmon_request_report();
+#if CRUISE_ADMISSION_CONTROL
+    admit_request_report();
+#endif
+#if CRUISE_EDF
+    edf_request_report();
+#endif
+#if CRUISE_APERIODIC_SERVER
+    server_request_report();
+#endif
+#if CRUISE_MIXED_CRITICALITY
+    crit_request_report();
+#endif
+#if CRUISE_WATCHDOG
+    sup_request_report();
+#endif
+#if CRUISE_INPUT_RECORD
+    xTaskNotifyGive(xInputDump_handle);
+#endif
+}
+
+/**
+ * @brief Samples all buttons and switches, in replay mode takes the next recorded sample
+ *        instead. At the end of the recording the buttons are released and the switches
+ *        keep their last levels.
+ *
+ * @return uint32_t Levels, bit INPUTREC_SW_x for SW_x
+ */
+static uint32_t sample_inputs(void) {
+    uint32_t inputs = 0;
+
+#if CRUISE_INPUT_REPLAY
+    inputrec_frame_t frame;
+
+    inputs = inputrec_read(&xReplay, &frame) ? frame.inputs : (xInputs | INPUT_BUTTONS);
+#else
+    for (uint32_t i = 0; i < INPUTREC_INPUTS; i++) {
+        inputs |= (uint32_t)BSP_GetInput(xInputPins[i]) << i;
+    }
+#if CRUISE_INPUT_RECORD
+    if (!xDumping) {
+        inputrec_frame_t frame = { .time_ms = xTaskGetTickCount() * portTICK_PERIOD_MS,
+                                   .inputs = inputs };
+        float x, y, z;
+
+        if (BSP_GetAcceleration(&x, &y, &z)) {
+            frame.acc[0] = (int16_t)(x * 1000.0f);  /* g -> mg */
+            frame.acc[1] = (int16_t)(y * 1000.0f);
+            frame.acc[2] = (int16_t)(z * 1000.0f);
+        }
+        inputrec_add(&xRecorder, &frame);
+    }
+#endif
+#endif
+    xInputs = inputs;
+    return inputs;
+}
+
+/**
+ * @brief Level of a switch: the pin, in replay mode the last sample of the Button task.
+ */
+static bool input_level(uint32_t pin, uint32_t bit) {
+#if CRUISE_INPUT_REPLAY
+    (void)pin;
+    return ((xInputs >> bit) & 1u) != 0;
+#else
+    (void)bit;
+    return BSP_GetInput(pin);
+#endif
+}
 
 /**
  * @brief The button task shall monitor the input buttons and send the values to the
@@ -57,54 +370,56 @@ void vExtraLoadTask(void *arg);
  * 
  * ==> MODIFY THIS TASK! 
  *     Currently the buttons are ignored. Use busy wait I/O to monitor the buttons
- * ==> MODIFIED: Now periodically reads button inputs and sends them via queues
+ * ==> MODIFIED: Now periodically reads button inputs and publishes them on the blackboard
+ * ==> MODIFIED: Edge detection in cruise_buttons_step() (cruise_core.h)
+ * ==> MODIFIED: Inputs from sample_inputs(), recorded or replayed (CRUISE_INPUT_RECORD/REPLAY)
  * @param args 
  */
 void vButtonTask(void *args) {
     TickType_t xLastWakeTime = xTaskGetTickCount();
     const TickType_t xPeriod = (int)args;   /* Period in ticks */
 
-    bool btnGas;
-    bool btnBrake;
-    bool prev_btnCruise = BSP_GetInput(SW_6); /* raw read, active-low: pressed -> 0 */
-    bool value_cruise_control = false;
+    bb_pedals_t pedals = {0};
+    cruise_buttons_t buttons;
+    cruise_pedals_t pressed;
+    latency_tag_t sample_tag;
+    uint32_t inputs = xInputs;
+    bool prev_btnReport = INPUT_LEVEL(inputs, SW_8); /* stack report, active-low */
 
-    uint16_t now_velocity = 0;
+    cruise_buttons_init(&buttons, INPUT_LEVEL(inputs, SW_6)); /* raw level, active-low: pressed -> 0 */
 
     for (;;) {
-        /* Busy-wait read of hardware button states */
-        bool raw_sw7 = BSP_GetInput(SW_7); /* GAS, active-low */
-        bool raw_sw5 = BSP_GetInput(SW_5); /* BRAKE, active-low */
-        bool raw_sw6 = BSP_GetInput(SW_6); /* CRUISE, raw */
-
-        /* Convert to logical pressed booleans (pressed == true) */
-        btnGas = !raw_sw7;
-        btnBrake = !raw_sw5;
-
-        /* Edge detect negative-edge of cruise button (pressed -> raw goes from 1->0) */
-        if ((raw_sw6 != prev_btnCruise) && (raw_sw6 == false)) {
-            /* at negative edge: toggle cruise state */
-            value_cruise_control = !value_cruise_control;
-
-            /* Snapshot current velocity as target */
-            xQueuePeek(xQueueVelocity, &now_velocity, (TickType_t)0);
-            xQueueOverwrite(xQueueTargetVelocity, &now_velocity);
-            
+        /* Busy-wait read of hardware button states: GAS, BRAKE, CRUISE (all active-low);
+         * a negative edge of CRUISE toggles the request (the Control task snapshots the target) */
+        sample_tag = latency_capture();
+        inputs = sample_inputs();
+        cruise_buttons_step(&buttons, INPUT_LEVEL(inputs, SW_7), INPUT_LEVEL(inputs, SW_5),
+                            INPUT_LEVEL(inputs, SW_6), &pressed);
+
+        /* Negative edge of SW_8 ends the test run */
+        bool raw_sw8 = INPUT_LEVEL(inputs, SW_8);
+        if ((raw_sw8 != prev_btnReport) && (raw_sw8 == false)) {
+            request_reports();
         }
+        prev_btnReport = raw_sw8;
 
-        prev_btnCruise = raw_sw6;
-
-        /* Brake cancels cruise immediately */
-        if (btnBrake) {
-            value_cruise_control = false;
+        /* Tag new presses with their sample time */
+        if (pressed.gas && !pedals.gas) {
+            pedals.gas_tag = sample_tag;
+        }
+        if (pressed.brake && !pedals.brake) {
+            pedals.brake_tag = sample_tag;
         }
 
-        /* Send values to respective queues */
-        xQueueOverwrite(xQueueGasPedal,&btnGas);
-        xQueueOverwrite(xQueueBrakePedal,&btnBrake);
-        xQueueOverwrite(xQueueCruiseControl,&value_cruise_control);
+        /* Publish all pedal values as one snapshot */
+        pedals.gas = pressed.gas;
+        pedals.brake = pressed.brake;
+        pedals.cruise = pressed.cruise;
+        blackboard_write_pedals(&xBoard, &pedals);
 
-        vTaskDelayUntil(&xLastWakeTime, xPeriod);   /* Periodic execution */
+        if (wait_next_period(&xLastWakeTime, xPeriod) == pdFALSE) {  /* Periodic execution */
+            loadmon_deadline_miss();    /* Released late: the job overran its period */
+        }
     }
 }
 
@@ -115,186 +430,132 @@ void vButtonTask(void *args) {
  * ==> MODIFY THIS TASK!
  *     Currently the throttle has a fixed value of 80
  * ==> MODIFIED: Now periodic, and Proportional controller for throttle adjustment
+ *     With CRUISE_EVENT_CHAINED it runs on every 2nd Vehicle notification instead
+ * ==> MODIFIED: State machine and controller in cruise_control_step() (cruise_core.h)
  * @param args 
  */
 void vControlTask(void *args) {
+#if CRUISE_EVENT_CHAINED
+    uint32_t display_countdown = DISPLAY_DECIMATION;
+#else
     TickType_t xLastWakeTime = xTaskGetTickCount();
+#endif
     const TickType_t xPeriod = (int)args;
 
-    uint16_t throttle = 0;
-    uint16_t velocity = 0;
-    uint16_t target_velocity = 0;
-    bool cruise_request = false;
-    bool cruise_active = false;
-    bool gas_pedal = false;
-    bool brake_pedal = false;
+    bb_pedals_t pedals;
+    bb_vehicle_t vehicle;
+    bb_control_t out = {0};
+    uint32_t vehicle_gen, prev_vehicle_gen = 0;
+    cruise_control_t control;
+    uint16_t throttle;
+    bool cruise_active;
+    bool gas_pedal;
+    bool brake_pedal;
 
-    const uint16_t VELOCITY_CRUISE_THRESHOLD = 250; /* Minimum velocity for cruise control to be active */
+    cruise_control_init(&control);
 
     for (;;) {
-        xQueuePeek(xQueueCruiseControl, &cruise_request, (TickType_t)0);
-        xQueuePeek(xQueueGasPedal, &gas_pedal, (TickType_t)0);
-        xQueuePeek(xQueueBrakePedal, &brake_pedal, (TickType_t)0);
-        xQueuePeek(xQueueVelocity, &velocity, (TickType_t)0);
-        xQueuePeek(xQueueTargetVelocity, &target_velocity, (TickType_t)0);
-
-        /* Cruise control toggle logic */
-        if (brake_pedal || gas_pedal) {
-            /* brakes or gas deactivate cruise */
-            cruise_active = false;
-        } else {
-            /* user requested cruise and velocity threshold satisfied */
-            if (cruise_request && (velocity >= VELOCITY_CRUISE_THRESHOLD)) {
-                if (!cruise_active) {
-                    cruise_active = true;
-                    /* snapshot current velocity as target */
-                    target_velocity = velocity;
-                    xQueueOverwrite(xQueueTargetVelocity, &target_velocity);
-                }
-            } else {
-                cruise_active = false;
-            }
-        }
-        
-        if (brake_pedal) {
-            throttle = 0;
-        }
-        else if (gas_pedal) {
-            throttle += GAS_STEP;
-            if (throttle > 80)
-                throttle = 80;
-        }
-        else if (cruise_active) {
-            int16_t err = (int16_t)target_velocity - (int16_t)velocity;
-            /* simple proportional step adjust: */
-            if (err > 40) throttle = (throttle + 3 > 80) ? 80 : throttle + 3;
-            else if (err < -40) throttle = (throttle > 3) ? throttle - 3 : 0;
-            /* else keep throttle */
-        } else {
-            throttle = 0;
-        }
+        blackboard_read_pedals(&xBoard, &pedals);
+        vehicle_gen = blackboard_read_vehicle(&xBoard, &vehicle);
+        gas_pedal = pedals.gas;
+        brake_pedal = pedals.brake;
+
+        /* The Vehicle task (100 ms) must have published since the last Control job */
+        throttle = cruise_control_step(&xControlConfig, &control,
+                                       &(cruise_pedals_t){ gas_pedal, brake_pedal, pedals.cruise },
+                                       vehicle.velocity, vehicle.position,
+                                       vehicle_gen != prev_vehicle_gen);
+        cruise_active = control.cruise_active;
+        prev_vehicle_gen = vehicle_gen;
 
         /* Set yellow LED for cruise active */
         BSP_SetLED(LED_YELLOW, cruise_active);
 
-        xQueueOverwrite(xQueueThrottle, &throttle);
-
-        vTaskDelayUntil(&xLastWakeTime, xPeriod);
-    }
-}
-
-/**
- * @brief The function returns the new position depending on the input parameters.
- * 
- * ==> DO NOT CHANGE THIS FUNCTION !!!
- * 
- * @param position 
- * @param velocity 
- * @param acceleration 
- * @param time_interval 
- * @return 
- */
-uint16_t adjust_position(uint16_t position, int16_t velocity,
-                         int8_t acceleration, uint16_t time_interval)
-{
-  int16_t new_position = position + velocity * time_interval / 1000
-    + acceleration / 2  * (time_interval / 1000) * (time_interval / 1000);
-
-  if (new_position > 24000) {
-    new_position -= 24000;
-  } else if (new_position < 0){
-    new_position += 24000;
-  }
-
-  return new_position;
-}
-
+        /* A new press is forwarded with the throttle it caused */
+        if (brake_pedal && (pedals.brake_tag != out.brake_tag)) {
+            out.brake_tag = pedals.brake_tag;
+            latency_forward(xBrakeChain, out.brake_tag);
+        } else if (gas_pedal && (pedals.gas_tag != out.gas_tag)) {
+            out.gas_tag = pedals.gas_tag;
+            latency_forward(xGasChain, out.gas_tag);
+        }
 
-/**
- * @brief The function returns the new velocity depending on the input parameters.
- * 
- * ==> DO NOT CHANGE THIS FUNCTION !!! 
- *
- * @param velocity 
- * @param acceleration 
- * @param brake_pedal 
- * @param time_interval 
- * @return 
- */
-int16_t adjust_velocity(int16_t velocity, int8_t acceleration,  
-		       bool brake_pedal, uint16_t time_interval)
-{
-  int16_t new_velocity;
-  uint8_t brake_retardation = 50;
+        out.throttle = throttle;
+        out.target_velocity = control.target_velocity;
+        out.cruise_active = cruise_active;
+        blackboard_write_control(&xBoard, &out);
 
-  if (brake_pedal == false) {
-    new_velocity = velocity  + (float) ((acceleration * time_interval) / 1000);
-    if (new_velocity <= 0) {
-        new_velocity = 0;
-    }
-  } 
-  else { 
-    if ((float) (brake_retardation * time_interval) / 1000 > velocity) {
-       new_velocity = 0;
-    }
-    else {
-      new_velocity = velocity - (float) brake_retardation * time_interval / 1000;
+#if CRUISE_EVENT_CHAINED
+        /* Actuator path: pass every DISPLAY_DECIMATION-th state on to the display */
+        if (--display_countdown == 0) {
+            display_countdown = DISPLAY_DECIMATION;
+            xTaskNotifyGive(xDisplay_handle);
+        }
+        /* Exactly one new vehicle state per job, otherwise a state was skipped or lost;
+         * runs anyway (on stale data) if the Vehicle task stops for two periods */
+        sup_checkin();
+        if (budget_wait_notification(2 * xPeriod) != 1u) {
+            loadmon_deadline_miss();
+        }
+#else
+        if (wait_next_period(&xLastWakeTime, xPeriod) == pdFALSE) {
+            loadmon_deadline_miss();
+        }
+#endif
     }
-  } 
-
-  return new_velocity;
 }
 
 /**
  * @brief The vehicle task continuously calculates the velocity of the vehicle 
  *
  * ==> DO NOT CHANGE THIS TASK !!!  
+ * ==> MODIFIED: Only the I/O, reads and publishes the blackboard instead of the queues
+ * ==> MODIFIED: Terrain from the track map (xTrack) instead of a fixed if-chain
+ * ==> MODIFIED: Optionally the sub-stepped vehicle model (CRUISE_USE_VEHICLE_MODEL)
+ * ==> MODIFIED: Physics moved unchanged to cruise_vehicle_step() (cruise_core.h)
+ * ==> MODIFIED: Waits with edf_wait_next_period(), the same as vTaskDelayUntil() without CRUISE_EDF
+ * ==> MODIFIED: Checks in with the watchdog supervisor (CRUISE_WATCHDOG) once per job
+ * ==> MODIFIED: With CRUISE_EVENT_CHAINED notifies Control after every 2nd job
  *
  * @param args 
  */
 void vVehicleTask(void *args) {
     TickType_t xLastWakeTime = 0;
     const TickType_t xPeriod = (int)args;   /* Get period (in ticks) from argument. */
+    bb_pedals_t pedals;
+    bb_control_t control;
     uint16_t throttle;
     bool brake_pedal;
-                           /* Approximate values*/
-    uint8_t acceleration;  /* Value between 40 and -20 (4.0 m/s^2 and -2.0 m/s^2) */
-    uint8_t retardation;   /* Value between 20 and -10 (2.0 m/s^2 and -1.0 m/s^2) */
-    uint16_t position = 0; /* Value between 0 and 24000 (0.0 m and 2400.0 m)  */
-    uint16_t velocity = 0; /* Value between -200 and 700 (-20.0 m/s amd 70.0 m/s) */
-    uint16_t wind_factor;   /* Value between -10 and 20 (2.0 m/s^2 and -1.0 m/s^2) */
+    cruise_vehicle_t vehicle;
+#if CRUISE_EVENT_CHAINED
+    uint32_t control_countdown = CONTROL_DECIMATION;
+#endif
+
+    cruise_vehicle_init(&vehicle, 0, 0);   /* Position 0..24000 (2400.0 m), velocity in 0.1 m/s */
 
     for (;;) {
-        xQueuePeek(xQueueThrottle, &throttle, ( TickType_t ) 0);
-        xQueuePeek(xQueueBrakePedal, &brake_pedal, ( TickType_t ) 0);
-
-        /* Retardation : Factor of Terrain and Wind Resistance */
-        if (velocity > 0)
-	        wind_factor = velocity * velocity / 10000 + 1;
-        else 
-	        wind_factor = (-1) * velocity * velocity / 10000 + 1;
-
-        if (position < 4000) 
-            retardation = wind_factor; // even ground
-        else if (position < 8000)
-            retardation = wind_factor + 8; // traveling uphill
-        else if (position < 12000)
-            retardation = wind_factor + 16; // traveling steep uphill
-        else if (position < 16000)
-            retardation = wind_factor; // even ground
-        else if (position < 20000)
-            retardation = wind_factor - 8; //traveling downhill
-        else
-            retardation = wind_factor - 16 ; // traveling steep downhill
-
-        acceleration = throttle / 2 - retardation;	  
-        position = adjust_position(position, velocity, acceleration, xPeriod); 
-        velocity = adjust_velocity(velocity, acceleration, brake_pedal, xPeriod);         
+        blackboard_read_control(&xBoard, &control);
+        blackboard_read_pedals(&xBoard, &pedals);
+        throttle = control.throttle;
+        brake_pedal = pedals.brake;
+        latency_complete(xBrakeChain, control.brake_tag);   /* End of the cause-effect chains */
+        latency_complete(xGasChain, control.gas_tag);
+
+        cruise_vehicle_step(&xVehicleConfig, &vehicle, throttle, brake_pedal,
+                            xPeriod * 1000u / configTICK_RATE_HZ);
 
  
-        xQueueOverwrite(xQueueVelocity, &velocity);
-        xQueueOverwrite(xQueuePosition, &position); 
-        vTaskDelayUntil(&xLastWakeTime, xPeriod);   /* Wait for the next release. */
+        blackboard_write_vehicle(&xBoard, &(bb_vehicle_t){ .velocity = vehicle.velocity,
+                                                           .position = vehicle.position });
+#if CRUISE_EVENT_CHAINED
+        /* Start the control job on the fresh state, at the Control period */
+        if (--control_countdown == 0) {
+            control_countdown = CONTROL_DECIMATION;
+            xTaskNotifyGive(xControl_handle);
+        }
+#endif
+        sup_checkin();
+        (void)edf_wait_next_period(&xLastWakeTime, xPeriod);    /* Wait for the next release; misses in edf_report() */
     }
 }
 
@@ -328,12 +589,18 @@ void write_position(uint16_t position) {
  * ==> MODIFY THIS TASK!
  *     Currently the information is shown on the standard output (serial monitor in VSCode)
  * ==> MODIFIED: Uses LEDs and 7-segment display for output
+ *     With CRUISE_EVENT_CHAINED it runs when notified by the Control task instead
  * @param args 
  */
 void vDisplayTask(void *args) {
+#if !CRUISE_EVENT_CHAINED
     TickType_t xLastWakeTime = 0;
+#endif
     const TickType_t xPeriod = (int)args;   /* Get period (in ticks) from argument. */
 
+    bb_pedals_t pedals;
+    bb_vehicle_t vehicle;
+    bb_control_t control;
     uint16_t velocity; 
     uint16_t throttle;  
     uint16_t position;
@@ -343,12 +610,16 @@ void vDisplayTask(void *args) {
     char display_str[9];   /* enough for "TTVV\0" and extras */
 
     for (;;) {
-        xQueuePeek(xQueueVelocity, &velocity, ( TickType_t ) 0);
-        xQueuePeek(xQueuePosition, &position, ( TickType_t ) 0);
-        xQueuePeek(xQueueThrottle, &throttle, ( TickType_t ) 0);
-        xQueuePeek(xQueueGasPedal, &gas_pedal, ( TickType_t ) 0);
-        xQueuePeek(xQueueBrakePedal, &brake_pedal, ( TickType_t ) 0);
-        xQueuePeek(xQueueCruiseControl, &cruise_control, ( TickType_t ) 0);
+        /* Three consistent snapshots instead of six queue peeks */
+        blackboard_read_pedals(&xBoard, &pedals);
+        blackboard_read_vehicle(&xBoard, &vehicle);
+        blackboard_read_control(&xBoard, &control);
+        velocity = vehicle.velocity;
+        position = vehicle.position;
+        throttle = control.throttle;
+        gas_pedal = pedals.gas;
+        brake_pedal = pedals.brake;
+        cruise_control = pedals.cruise;
 
         printf("Throttle: %d\n", throttle);
         printf("Velocity: %d\n", velocity);
@@ -363,7 +634,15 @@ void vDisplayTask(void *args) {
 
         BSP_7SegDispString(display_str);
         
-        vTaskDelayUntil(&xLastWakeTime, xPeriod);   /* Wait for the next release. */
+#if CRUISE_EVENT_CHAINED
+        if (budget_wait_notification(2 * xPeriod) != 1u) {
+            loadmon_deadline_miss();
+        }
+#else
+        if (wait_next_period(&xLastWakeTime, xPeriod) == pdFALSE) {  /* Wait for the next release. */
+            loadmon_deadline_miss();
+        }
+#endif
     }
 }
 
@@ -378,88 +657,176 @@ static void busy_wait(uint32_t delay_ms)
     }
 }
 
+#if ADMIT_EXTRA_LOAD
+/* Requests busy_ms of ExtraLoad per period from admission control. If admitted, the
+ * period (also of EDF), and the budget follow the admitted load.
+ * Returns true if admitted, possibly at the longer period *pxPeriod */
+static bool admit_extra_load(uint32_t busy_ms, TickType_t *pxPeriod)
+{
+    admit_params_t load = {
+        .period_us = TASK_EXTRALOAD_PERIOD_MS * 1000u,
+        .wcet_us = busy_ms * 1000u + EXTRA_LOAD_OVERHEAD_US,
+        .priority = TASK_EXTRALOAD_PRIORITY,
+    };
+    admit_result_t result = admit_request(xExtraLoad_handle, &load, EXTRA_LOAD_MAX_PERIOD_MS * 1000u);
+
+    printf("Admission: ExtraLoad %lu ms every %lu ms %s\n", (unsigned long)busy_ms,
+           (unsigned long)(load.period_us / 1000u),
+           (result == ADMIT_ACCEPTED) ? "admitted" : (result == ADMIT_DEGRADED) ? "degraded" : "rejected");
+    if (result == ADMIT_REJECTED) {
+        return false;
+    }
+    *pxPeriod = pdMS_TO_TICKS(load.period_us / 1000u);
+    budget_set(xExtraLoad_handle, load.wcet_us);
+    edf_set_period(xExtraLoad_handle, *pxPeriod, 0);   /* pdFAIL without CRUISE_EDF */
+    return true;
+}
+#endif
+
+#if CRUISE_APERIODIC_SERVER
+/* Server job: busy_wait() for the number of ms in arg */
+static void vBusyJob(void *arg)
+{
+    busy_wait((uint32_t)(uintptr_t)arg);
+}
+
+/* Server job: command received on CN1, 'r' prints the reports like SW_8 */
+static void vCommandJob(void *arg)
+{
+    char c = (char)(uintptr_t)arg;
+
+    switch (c) {
+    case 'r':
+        request_reports();
+        break;
+    case 's':
+        server_report();
+        break;
+    case '\r':
+    case '\n':
+        break;
+    default:
+        printf("Command '%c' unknown (r: reports, s: server)\n", c);
+        break;
+    }
+}
+
+#ifdef CN1_UART
+/* CN1 receive interrupt: each character is queued to the server as a command */
+static void vCommandRxIsr(void)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    while (uart_is_readable(uart1)) {
+        char c = uart_getc(uart1);
+
+        server_submit_from_isr(xAperiodicServer, vCommandJob, (void *)(uintptr_t)c,
+                               &xHigherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+#endif
+#endif
+
 /* ExtraLoad task:
  * - period = 25 ms
  * - read SW10..SW17 (SW10 MSB), compute X (0..255)
  * - busy wait X/10 ms to impose load
+ * - with CRUISE_ADMISSION_CONTROL only as admitted: a degraded X runs at a longer
+ *   period, a rejected X keeps the previous load
+ * - with CRUISE_APERIODIC_SERVER the busy wait is a job of the server instead
  */
 void vExtraLoadTask(void *arg)
 {
     TickType_t xLastWake = xTaskGetTickCount();
-    const TickType_t xPeriod = pdMS_TO_TICKS(EXTRA_LOAD_PERIOD_MS);
+    TickType_t xPeriod = pdMS_TO_TICKS(TASK_EXTRALOAD_PERIOD_MS);
+#if ADMIT_EXTRA_LOAD
+    uint32_t admitted_ms = 0;
+    int requested = -1;             /* X of the last request */
+#endif
 
     for (;;) {
-        bool b7 = BSP_GetInput(SW_10);
-        bool b6 = BSP_GetInput(SW_11);
-        bool b5 = BSP_GetInput(SW_12);
-        bool b4 = BSP_GetInput(SW_13);
-        bool b3 = BSP_GetInput(SW_14);
-        bool b2 = BSP_GetInput(SW_15);
-        bool b1 = BSP_GetInput(SW_16);
-        bool b0 = BSP_GetInput(SW_17);
+        bool b7 = input_level(SW_10, INPUTREC_SW_10);
+        bool b6 = input_level(SW_11, INPUTREC_SW_11);
+        bool b5 = input_level(SW_12, INPUTREC_SW_12);
+        bool b4 = input_level(SW_13, INPUTREC_SW_13);
+        bool b3 = input_level(SW_14, INPUTREC_SW_14);
+        bool b2 = input_level(SW_15, INPUTREC_SW_15);
+        bool b1 = input_level(SW_16, INPUTREC_SW_16);
+        bool b0 = input_level(SW_17, INPUTREC_SW_17);
 
         uint8_t X = (uint8_t)((b7<<7) | (b6<<6) | (b5<<5) | (b4<<4) |
                               (b3<<3) | (b2<<2) | (b1<<1) | (b0<<0));
 
         uint32_t busy_ms = X / 10u; /* 0..25 ms */
+#if CRUISE_APERIODIC_SERVER
+        /* Dropped (and counted) if the server falls behind by SERVER_QUEUE_LENGTH jobs */
+        if (busy_ms > 0) server_submit(xAperiodicServer, vBusyJob, (void *)(uintptr_t)busy_ms);
+#else
+#if ADMIT_EXTRA_LOAD
+        if (X != requested) {
+            requested = X;
+            if (admit_extra_load(busy_ms, &xPeriod)) {
+                admitted_ms = busy_ms;
+            }
+        }
+        busy_ms = admitted_ms;
+#endif
         if (busy_ms > 0) busy_wait(busy_ms);
+#endif
 
-        vTaskDelayUntil(&xLastWake, xPeriod);
+        if (wait_next_period(&xLastWake, xPeriod) == pdFALSE) {
+            loadmon_deadline_miss();
+        }
     }
 }
 
-/* OverloadDetection task:
- * - periodically gives watchdog semaphore (OK token)
- * - if it gets starved it will not give and watchdog will detect overload
+#if CRUISE_INPUT_RECORD
+/* InputDump task:
+ * - waits for SW_8
+ * - prints the input recording ("IR ..." lines, see inputrec.h) at the lowest priority;
+ *   the Button task does not record meanwhile
  */
-void vOverloadDetectionTask(void *arg)
+void vInputDumpTask(void *arg)
 {
-    TickType_t xLastWake = xTaskGetTickCount();
-    const TickType_t xPeriod = pdMS_TO_TICKS(OVERLOAD_DETECT_PERIOD_MS);
+    (void)arg;
 
     for (;;) {
-        if (xSemaphoreWatchDogFood != NULL) {
-            xSemaphoreGive(xSemaphoreWatchDogFood);
-        }
-        vTaskDelayUntil(&xLastWake, xPeriod);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        xDumping = true;
+        inputrec_dump(&xRecorder, stdout);
+        xDumping = false;
     }
 }
+#endif
 
-/* Watchdog:
- * - waits for OK token with timeout 1000 ms
- * - if timeout => system overload: print and turn on all LEDs
- * - when OK returns, clear overload (turn off LEDs)
+/* Overload event (called by the load monitor in the timer service task):
+ * - overload => print and turn on all LEDs, HI mode with CRUISE_MIXED_CRITICALITY
+ * - when the load drops again, clear overload (turn off LEDs), LO mode after the hold time
  */
-void vWatchDogTask(void *arg)
+static void vOverloadEvent(bool overloaded, uint16_t permille)
 {
-    const TickType_t xTimeout = pdMS_TO_TICKS(OVERLOAD_WATCHDOG_TIMEOUT_MS);
-    bool overloaded = false;
-
-    for (;;) {
-        BaseType_t got = xSemaphoreTake(xSemaphoreWatchDogFood, xTimeout);
-
-        if (got == pdTRUE) {
-            if (overloaded) {
-                overloaded = false;
-                /* clear all LEDs; main system will re-set them as appropriate */
-                BSP_SetLED(LED_RED, false);
-                BSP_SetLED(LED_GREEN, false);
-                BSP_SetLED(LED_YELLOW, false);
-                printf("Watchdog: system OK -> clearing overload.\n");
-            }
-        } else {
-            /* timeout */
-            if (!overloaded) {
-                overloaded = true;
-                printf("Watchdog: SYSTEM OVERLOAD DETECTED!\n");
-                BSP_SetLED(LED_RED, true);
-                BSP_SetLED(LED_GREEN, true);
-                BSP_SetLED(LED_YELLOW, true);
-            }
-        }
-
-        /* small sleep so this task does not loop too tightly */
-        vTaskDelay(pdMS_TO_TICKS(10));
+    if (overloaded) {
+        printf("Load monitor: SYSTEM OVERLOAD DETECTED! (load %u.%u %%, %lu misses)\n",
+               permille / 10u, permille % 10u,
+               (unsigned long)loadmon_misses(xOverloadLimits.level));
+        budget_report();
+#if CRUISE_MIXED_CRITICALITY
+        crit_enter_hi();
+#endif
+        BSP_SetLED(LED_RED, true);
+        BSP_SetLED(LED_GREEN, true);
+        BSP_SetLED(LED_YELLOW, true);
+    } else {
+        printf("Load monitor: system OK -> clearing overload (load %u.%u %%).\n",
+               permille / 10u, permille % 10u);
+#if CRUISE_MIXED_CRITICALITY
+        crit_request_lo();
+#endif
+        /* clear all LEDs; main system will re-set them as appropriate */
+        BSP_SetLED(LED_RED, false);
+        BSP_SetLED(LED_GREEN, false);
+        BSP_SetLED(LED_YELLOW, false);
     }
 }
 
@@ -471,34 +838,196 @@ void vWatchDogTask(void *arg)
  *        - Adjust the priorities of the task so that they correspond
  *          to the rate-monotonic algorithm.
  * ==> MODIFIED: Converted button and control tasks to periodic, adjusted priorities
+ * ==> MODIFIED: With CRUISE_SMP the control loop is pinned to core 1, the I/O to core 0
+ * ==> MODIFIED: With CRUISE_EDF the periodic tasks get EDF instead of RM priorities
+ * ==> MODIFIED: Periods and priorities from tasks.csv (taskset.h), checked at configure time
+ * ==> MODIFIED: With CRUISE_ADMISSION_CONTROL the control loop is guaranteed, ExtraLoad admitted
+ * ==> MODIFIED: With CRUISE_APERIODIC_SERVER the ExtraLoad work and CN1 commands run in a server
+ * ==> MODIFIED: With CRUISE_MIXED_CRITICALITY the LO tasks are shed while overloaded
+ * ==> MODIFIED: With CRUISE_WATCHDOG a hung control loop resets the board
  * @return 
  */
 int main()
 {
+    uint64_t startup_us;
+
     BSP_Init();  /* Initialize all components on the ES Lab-Kit. */
+    startup_us = time_us_64();
+
+    /* Clear the shared state and index the track */
+    blackboard_init(&xBoard);
+    if (!terrain_init(&xTrack, terrain_lab_track, terrain_lab_track_count, TRACK_LENGTH,
+                      xTrackIndex, sizeof(xTrackIndex) / sizeof(xTrackIndex[0]))) {
+        printf("Track table invalid or index too small!\n");
+        for (;;) { }
+    }
 
-    /* Create the message queues */
-    xQueueCruiseControl = xQueueCreate( 1, sizeof(bool));
-    xQueueGasPedal = xQueueCreate( 1, sizeof(bool));
-    xQueueBrakePedal = xQueueCreate( 1, sizeof(bool));
-    xQueueVelocity = xQueueCreate( 1, sizeof(uint16_t));
-    xQueueTargetVelocity = xQueueCreate( 1, sizeof(uint16_t));
-    xQueuePosition = xQueueCreate( 1, sizeof(uint16_t));
-    xQueueThrottle = xQueueCreate( 1, sizeof(uint16_t));
+    /* Input recording in PSRAM if fitted, else in SRAM; or the compiled-in replay */
+#if CRUISE_INPUT_RECORD
+    if (BSP_HasPSRAM() >= RECORD_PSRAM_BYTES) {
+        inputrec_init(&xRecorder, (void *)PSRAM_BASE, RECORD_PSRAM_BYTES);
+    } else {
+        inputrec_init(&xRecorder, xRecordSram, sizeof(xRecordSram));
+    }
+#elif CRUISE_INPUT_REPLAY
+    inputrec_reader_init_blocks(&xReplay, xReplayBlocks, sizeof(xReplayBlocks) / sizeof(xReplayBlocks[0]));
+#endif
     
     /* Create the tasks. */
-    xTaskCreate(vButtonTask, "Button Task", 512, (void*) 50, 7, &xButton_handle);
-    xTaskCreate(vVehicleTask, "Vehicle Task", 512, (void*) 100, 6, &xVehicle_handle); 
-    xTaskCreate(vControlTask, "Control Task", 512, (void*) 200, 5, &xControl_handle);
-    xTaskCreate(vDisplayTask, "Display Task", 512, (void*) 500, 4, &xDisplay_handle); 
-
-    /* ----------------- Part 3 init: create watchdog semaphore and tasks ----------------- */
-    xSemaphoreWatchDogFood = xSemaphoreCreateBinary();
-
-    /* Create Watchdog (highest), ExtraLoad (high), OverloadDetection (low) */
-    xTaskCreate(vWatchDogTask, "Watchdog", 512, (void*)1000, 10, &xWatchDog_handle);
-    xTaskCreate(vExtraLoadTask, "ExtraLoad", 512, (void*)25, 9, &xExtraLoad_handle);
-    xTaskCreate(vOverloadDetectionTask, "OverDetect", 512, NULL, 3, &xOverload_handle);
+    CREATE_TASK(xButton, vButtonTask, "Button Task", BUTTON_STACK_WORDS,
+                (void*) pdMS_TO_TICKS(TASK_BUTTON_PERIOD_MS), TASK_BUTTON_PRIORITY);
+    CREATE_TASK(xVehicle, vVehicleTask, "Vehicle Task", VEHICLE_STACK_WORDS,
+                (void*) pdMS_TO_TICKS(TASK_VEHICLE_PERIOD_MS), TASK_VEHICLE_PRIORITY);
+    CREATE_TASK(xControl, vControlTask, "Control Task", CONTROL_STACK_WORDS,
+                (void*) pdMS_TO_TICKS(TASK_CONTROL_PERIOD_MS), TASK_CONTROL_PRIORITY);
+    CREATE_TASK(xDisplay, vDisplayTask, "Display Task", DISPLAY_STACK_WORDS,
+                (void*) pdMS_TO_TICKS(TASK_DISPLAY_PERIOD_MS), TASK_DISPLAY_PRIORITY);
+
+    /* ----------------- Part 3 init: load monitor and extra load ----------------- */
+    loadmon_init(&xOverloadLimits, vOverloadEvent);
+
+    /* Create ExtraLoad (high) */
+    CREATE_TASK(xExtraLoad, vExtraLoadTask, "ExtraLoad", EXTRA_LOAD_STACK_WORDS,
+                (void*) pdMS_TO_TICKS(TASK_EXTRALOAD_PERIOD_MS), TASK_EXTRALOAD_PRIORITY);
+#if CRUISE_INPUT_RECORD
+    CREATE_TASK(xInputDump, vInputDumpTask, "InputDump", INPUT_DUMP_STACK_WORDS, NULL, 1);
+#endif
+
+#if CRUISE_APERIODIC_SERVER
+    /* Sporadic server for the ExtraLoad busy work and the commands received on CN1 */
+    xAperiodicServer = server_create(&xServerConfig);
+    if (xAperiodicServer == NULL) {
+        printf("Aperiodic server not created!\n");
+        for (;;) { }
+    }
+#ifdef CN1_UART
+    irq_set_exclusive_handler(UART1_IRQ, vCommandRxIsr);
+    irq_set_enabled(UART1_IRQ, true);
+    uart_set_irq_enables(uart1, true, false);
+#endif
+#endif
+
+#if configNUMBER_OF_CORES > 1
+    /* Pin the control loop and the I/O to separate cores */
+    vTaskCoreAffinitySet(xButton_handle, CONTROL_CORE_MASK);
+    vTaskCoreAffinitySet(xVehicle_handle, CONTROL_CORE_MASK);
+    vTaskCoreAffinitySet(xControl_handle, CONTROL_CORE_MASK);
+    vTaskCoreAffinitySet(xDisplay_handle, IO_CORE_MASK);
+    vTaskCoreAffinitySet(xExtraLoad_handle, IO_CORE_MASK);
+#if CRUISE_INPUT_RECORD
+    vTaskCoreAffinitySet(xInputDump_handle, IO_CORE_MASK);
+#endif
+#if CRUISE_APERIODIC_SERVER
+    vTaskCoreAffinitySet(server_task(xAperiodicServer), IO_CORE_MASK);
+#endif
+#endif
+
+#if CRUISE_EDF
+    /* Earliest deadline first with the deadlines of tasks.csv; ExtraLoad competes by its
+     * deadline as well instead of preempting everything at priority 9 */
+    edf_register(xButton_handle, pdMS_TO_TICKS(TASK_BUTTON_PERIOD_MS), pdMS_TO_TICKS(TASK_BUTTON_DEADLINE_MS));
+    edf_register(xVehicle_handle, pdMS_TO_TICKS(TASK_VEHICLE_PERIOD_MS), pdMS_TO_TICKS(TASK_VEHICLE_DEADLINE_MS));
+    edf_register(xControl_handle, pdMS_TO_TICKS(TASK_CONTROL_PERIOD_MS), pdMS_TO_TICKS(TASK_CONTROL_DEADLINE_MS));
+    edf_register(xDisplay_handle, pdMS_TO_TICKS(TASK_DISPLAY_PERIOD_MS), pdMS_TO_TICKS(TASK_DISPLAY_DEADLINE_MS));
+    edf_register(xExtraLoad_handle, pdMS_TO_TICKS(TASK_EXTRALOAD_PERIOD_MS), pdMS_TO_TICKS(TASK_EXTRALOAD_DEADLINE_MS));
+    edf_start(EDF_BASE_PRIORITY);
+#endif
+
+    /* Execution-time budgets: log overruns, demote a runaway ExtraLoad (RM only: under
+     * EDF the priority belongs to the scheduler) */
+    budget_register(xButton_handle, BUTTON_BUDGET_US, BUDGET_LOG);
+    budget_register(xControl_handle, CONTROL_BUDGET_US, BUDGET_LOG);
+    budget_register(xDisplay_handle, DISPLAY_BUDGET_US, BUDGET_LOG);
+    budget_register(xExtraLoad_handle, EXTRA_LOAD_BUDGET_US, CRUISE_EDF ? BUDGET_LOG : BUDGET_DEMOTE);
+
+#if CRUISE_MIXED_CRITICALITY
+    /* Criticality: the control loop is HI. On overload ExtraLoad stops and Display slows down;
+     * the event-chained Display has no period to stretch and keeps running */
+    crit_init(pdMS_TO_TICKS(CRIT_HOLD_MS));
+    crit_register(xButton_handle, CRIT_HI, CRIT_SUSPEND, 0);
+    crit_register(xVehicle_handle, CRIT_HI, CRIT_SUSPEND, 0);
+    crit_register(xControl_handle, CRIT_HI, CRIT_SUSPEND, 0);
+#if !CRUISE_EVENT_CHAINED
+    crit_register(xDisplay_handle, CRIT_LO, CRIT_STRETCH, DISPLAY_STRETCH);
+#endif
+    crit_register(xExtraLoad_handle, CRIT_LO, CRIT_SUSPEND, 0);
+#endif
+
+#if CRUISE_ADMISSION_CONTROL
+    /* The control loop is guaranteed, ExtraLoad asks for each new switch setting */
+    admit_init(CRUISE_EDF ? ADMIT_EDF : ADMIT_FIXED_PRIORITY, ADMIT_DEFAULT_CAP_PERMILLE);
+    admit_guarantee(xButton_handle, &(admit_params_t){ TASK_BUTTON_PERIOD_MS * 1000u, BUTTON_BUDGET_US,
+                                                       TASK_BUTTON_DEADLINE_MS * 1000u, TASK_BUTTON_PRIORITY });
+    admit_guarantee(xVehicle_handle, &(admit_params_t){ TASK_VEHICLE_PERIOD_MS * 1000u, TASK_VEHICLE_WCET_US,
+                                                        TASK_VEHICLE_DEADLINE_MS * 1000u, TASK_VEHICLE_PRIORITY });
+    admit_guarantee(xControl_handle, &(admit_params_t){ TASK_CONTROL_PERIOD_MS * 1000u, CONTROL_BUDGET_US,
+                                                        TASK_CONTROL_DEADLINE_MS * 1000u, TASK_CONTROL_PRIORITY });
+    if (admit_guarantee(xDisplay_handle, &(admit_params_t){ TASK_DISPLAY_PERIOD_MS * 1000u, DISPLAY_BUDGET_US,
+                                                            TASK_DISPLAY_DEADLINE_MS * 1000u,
+                                                            TASK_DISPLAY_PRIORITY }) != pdPASS) {
+        printf("Admission: the control loop alone is not schedulable!\n");
+    }
+#if CRUISE_APERIODIC_SERVER
+    /* The server reservation is fixed, so ExtraLoad needs no admission per switch setting.
+     * The test charges Q plus one tick, which covers the server overrun until the exhaustion
+     * alarm has lowered its priority */
+    if (admit_guarantee(server_task(xAperiodicServer),
+                        &(admit_params_t){ TASK_EXTRALOAD_PERIOD_MS * 1000u, SERVER_BUDGET_US,
+                                           TASK_EXTRALOAD_DEADLINE_MS * 1000u,
+                                           TASK_EXTRALOAD_PRIORITY }) != pdPASS) {
+        printf("Admission: the aperiodic server is not schedulable!\n");
+    }
+#endif
+#endif
+
+#if CRUISE_WATCHDOG
+    /* Watchdog supervisor: the control loop must keep running, Display and ExtraLoad may be
+     * shed or starved on overload */
+    sup_init(WATCHDOG_TIMEOUT_MS, pdMS_TO_TICKS(WATCHDOG_CHECK_MS));
+    sup_register(xButton_handle, WATCHDOG_WINDOW_PERIODS * TASK_BUTTON_PERIOD_MS);
+    sup_register(xVehicle_handle, WATCHDOG_WINDOW_PERIODS * TASK_VEHICLE_PERIOD_MS);
+    sup_register(xControl_handle, WATCHDOG_WINDOW_PERIODS * TASK_CONTROL_PERIOD_MS);
+#endif
+
+    /* Stack profiling of all tasks; the idle and timer tasks are added by the profiler */
+    stackprof_track(xButton_handle, BUTTON_STACK_WORDS);
+    stackprof_track(xVehicle_handle, VEHICLE_STACK_WORDS);
+    stackprof_track(xControl_handle, CONTROL_STACK_WORDS);
+    stackprof_track(xDisplay_handle, DISPLAY_STACK_WORDS);
+    stackprof_track(xExtraLoad_handle, EXTRA_LOAD_STACK_WORDS);
+#if CRUISE_INPUT_RECORD
+    stackprof_track(xInputDump_handle, INPUT_DUMP_STACK_WORDS);
+#endif
+#if CRUISE_APERIODIC_SERVER
+    stackprof_track(server_task(xAperiodicServer), SERVER_STACK_WORDS);
+#endif
+#if CRUISE_WATCHDOG
+    stackprof_track(sup_task(), SUP_STACK_WORDS);
+#endif
+    stackprof_start(pdMS_TO_TICKS(STACKPROF_PERIOD_MS));
+
+    /* Cause-effect latency: Button (50 ms) -> Control (200 ms) -> Vehicle (100 ms) */
+    xBrakeChain = latency_chain_register("Brake->Throttle");
+    xGasChain = latency_chain_register("Gas->Throttle");
+
+    /* Startup cost of the chosen allocation mode; the static buffers show up in .bss instead of the heap */
+    startup_us = time_us_64() - startup_us;
+    printf("Startup: tasks created in %lu us (%s allocation, %d core%s, %s)\n",
+           (unsigned long)startup_us, CRUISE_STATIC_ALLOCATION ? "static" : "dynamic",
+           configNUMBER_OF_CORES, (configNUMBER_OF_CORES > 1) ? "s" : "", CRUISE_EDF ? "EDF" : "RM");
+#if CRUISE_INPUT_RECORD
+    printf("Input recording: %lu blocks in %s, SW_8 dumps\n", (unsigned long)xRecorder.count,
+           ((void *)xRecorder.blocks == (void *)PSRAM_BASE) ? "PSRAM" : "SRAM");
+#elif CRUISE_INPUT_REPLAY
+    printf("Input replay: %u blocks\n", (unsigned)(sizeof(xReplayBlocks) / sizeof(xReplayBlocks[0])));
+#endif
+#if CRUISE_WATCHDOG
+    if (sup_last_reset() != NULL) {
+        sup_report();       /* The last reset was the watchdog */
+    }
+#endif
+    heapmon_report();
+    heapmon_start(pdMS_TO_TICKS(HEAPMON_PERIOD_MS));
 
     vTaskStartScheduler();  /* Start the scheduler. */
     
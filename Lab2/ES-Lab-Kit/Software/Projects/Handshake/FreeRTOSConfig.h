@@ -43,7 +43,14 @@
 
 /* Scheduler Related */
 #define configUSE_PREEMPTION                    1
+#ifndef TICKLESS_IDLE
+#define TICKLESS_IDLE                           0
+#endif
+#if TICKLESS_IDLE
+#define configUSE_TICKLESS_IDLE                 2   /* Software/rtos/tickless.c */
+#else
 #define configUSE_TICKLESS_IDLE                 0
+#endif
 #define configUSE_IDLE_HOOK                     0
 #define configUSE_TICK_HOOK                     0
 #define configTICK_RATE_HZ                      ( ( TickType_t ) 1000 )
@@ -78,7 +85,11 @@
 #define configKERNEL_PROVIDED_STATIC_MEMORY     1
 
 /* Hook function related definitions. */
+#ifndef NDEBUG
+#define configCHECK_FOR_STACK_OVERFLOW          2   /* Debug builds: check the painted stack end */
+#else
 #define configCHECK_FOR_STACK_OVERFLOW          0
+#endif
 #define configUSE_MALLOC_FAILED_HOOK            0
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
@@ -106,6 +117,9 @@
 
 #if FREE_RTOS_KERNEL_SMP // set by the RP2040 SMP port of FreeRTOS
 /* SMP port only */
+#if TICKLESS_IDLE
+#define configNUMBER_OF_CORES                   1   /* The tick of core 0 is stopped in idle */
+#endif
 #ifndef configNUMBER_OF_CORES
 #define configNUMBER_OF_CORES                   2
 #endif
@@ -153,6 +167,10 @@ to exclude the API function. */
 #define configMAX_SYSCALL_INTERRUPT_PRIORITY    16
 #endif
 
+/* Tickless idle on a hardware timer alarm (Software/rtos/tickless.h) */
+#define appUSE_TICKLESS_IDLE                    TICKLESS_IDLE
+
 /* A header file that defines trace macro can be included here. */
+#include "rtos_hooks.h"
 
 #endif /* FREERTOS_CONFIG_H */
\ No newline at end of file
@@ -13,11 +13,15 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
+#include "pico/stdlib.h"
 #include "bsp.h"
+#include "tickless.h"
 
 #define STEP_TIME_MS 2000
 #define STEP_TICKS   pdMS_TO_TICKS(STEP_TIME_MS)
 
+#define DRIFT_REPORT_STEPS 30   /* Print the drift of the red releases once a minute */
+
 SemaphoreHandle_t semRedDone;
 SemaphoreHandle_t semGreenDone;
 
@@ -28,6 +32,12 @@ int main(void)
 {
     BSP_Init();             /* Initialize all components on the lab-kit. */
 
+#if TICKLESS_IDLE
+    if (tickless_init() != pdPASS) {
+        printf("No free hardware alarm, idling with the tick\n");
+    }
+#endif
+
     semRedDone  = xSemaphoreCreateBinary();
     semGreenDone = xSemaphoreCreateBinary();
 
@@ -61,6 +71,14 @@ void vTaskRed(void *pvParameters)
     TickType_t xLastWakeTime = xTaskGetTickCount();
     size_t idx = 0;
 
+    /* Release times in us: with the tick locked to the timer, the n-th release stays
+       n * STEP_TIME_MS after the first one, however long the core slept in between.
+       Checked by the host test host/tickless_test.c only; on hardware run for an hour
+       and check that min/max stay put */
+    uint64_t first_us = 0;
+    uint32_t steps = 0;
+    int32_t min_drift = 0, max_drift = 0;
+
     for (;;) {
         /* Set red LED according to pattern */
         BSP_SetLED(LED_RED, redState[idx]);
@@ -68,6 +86,22 @@ void vTaskRed(void *pvParameters)
         /* Wait exactly STEP_TIME_MS since previous wake */
         vTaskDelayUntil(&xLastWakeTime, STEP_TICKS);
 
+        uint64_t now = time_us_64();
+        if (steps == 0) {
+            first_us = now;
+        }
+        int32_t drift = (int32_t)(now - first_us - (uint64_t)steps * STEP_TIME_MS * 1000);
+        min_drift = (drift < min_drift) ? drift : min_drift;
+        max_drift = (drift > max_drift) ? drift : max_drift;
+        steps++;
+        if (steps % DRIFT_REPORT_STEPS == 0) {
+            printf("Drift after %lu steps: %ld us (min %ld, max %ld us)\n", (unsigned long)steps,
+                   (long)drift, (long)min_drift, (long)max_drift);
+#if TICKLESS_IDLE
+            tickless_report();
+#endif
+        }
+
         /* Notify green task that red period finished */
         xSemaphoreGive(semRedDone);
 
@@ -22,31 +22,39 @@
 int main()
 {
     BSP_Init();             /* Initialize all components on the lab-kit. */
-    
+
+    /* Each phase ends at an absolute time, so the time spent switching the LEDs does not
+       add up over the cycles. sleep_until() waits for a timer alarm with the core in WFE. */
+    absolute_time_t next = get_absolute_time();
+
     while (true) { 
         // Red for 3s
         BSP_SetLED(LED_RED, true);
         BSP_SetLED(LED_YELLOW, false);
         BSP_SetLED(LED_GREEN, false);
-        sleep_ms(3000);
+        next = delayed_by_ms(next, 3000);
+        sleep_until(next);
 
         // Red - Yellow for 1s
         BSP_SetLED(LED_RED, true);
         BSP_SetLED(LED_YELLOW, true);
         BSP_SetLED(LED_GREEN, false);
-        sleep_ms(1000);
+        next = delayed_by_ms(next, 1000);
+        sleep_until(next);
 
         // Green for 3s
         BSP_SetLED(LED_RED, false);
         BSP_SetLED(LED_YELLOW, false);
         BSP_SetLED(LED_GREEN, true);
-        sleep_ms(3000);
+        next = delayed_by_ms(next, 3000);
+        sleep_until(next);
 
         // Yellow for 1s
         BSP_SetLED(LED_RED, false);
         BSP_SetLED(LED_YELLOW, true);
         BSP_SetLED(LED_GREEN, false);
-        sleep_ms(1000);
+        next = delayed_by_ms(next, 1000);
+        sleep_until(next);
     }
 }
 /*-----------------------------------------------------------*/
@@ -0,0 +1,40 @@
+# Frame table of the cyclic executive (cruise/cyclic.h) from a firmware project's task table.
+#
+#   include(${CMAKE_CURRENT_LIST_DIR}/../../cmake/CyclicTable.cmake)
+#   cyclic_table(<target> ${CMAKE_CURRENT_LIST_DIR}/tasks.csv)
+#
+# Builds host/cyclic_gen with the native C compiler (HostTool.cmake) and writes the frame table
+# to cyclic_table.h in the build directory, which is added to the include path of the target.
+# The configuration stops if no frame size fits the table. The table is rebuilt whenever
+# tasks.csv changes.
+#
+# -DCYCLIC_FRAME_MS=<ms> forces a frame size instead of the largest feasible one.
+
+set(CYCLIC_FRAME_MS 0 CACHE STRING "Frame size of the cyclic executive in ms, 0 for the largest feasible")
+
+set(CYCLIC_TABLE_SOFTWARE_DIR ${CMAKE_CURRENT_LIST_DIR}/..)
+
+include(${CMAKE_CURRENT_LIST_DIR}/HostTool.cmake)
+
+function(cyclic_table target table)
+    set(header ${CMAKE_CURRENT_BINARY_DIR}/cyclic_table.h)
+
+    host_tool(cyclic_gen tool ${CYCLIC_TABLE_SOFTWARE_DIR}/host/cyclic_gen.c
+              ${CYCLIC_TABLE_SOFTWARE_DIR}/host/tasktable.c ${CYCLIC_TABLE_SOFTWARE_DIR}/cruise/rta.c)
+
+    execute_process(COMMAND ${tool} -f ${CYCLIC_FRAME_MS} -H ${header} ${table}
+                    RESULT_VARIABLE result
+                    OUTPUT_VARIABLE report
+                    ERROR_VARIABLE errors)
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${table})
+    target_include_directories(${target} PRIVATE ${CMAKE_CURRENT_BINARY_DIR})
+
+    if(result EQUAL 0)
+        message(STATUS "Cyclic table: ${header}")
+    elseif(result EQUAL 1)
+        message("${report}")    # Unformatted, the columns would be reflowed in an error
+        message(FATAL_ERROR "Cyclic table: no frame table for ${table}")
+    else()
+        message(FATAL_ERROR "Cyclic table: ${errors}")
+    endif()
+endfunction()
@@ -0,0 +1,41 @@
+# Native build of a host tool at configure time, shared by TaskSetCheck.cmake and CyclicTable.cmake.
+#
+#   host_tool(<name> <output variable> <sources>...)
+#
+# Builds the sources with the native C compiler (as the Pico SDK does for pioasm) into
+# <build>/<name>/<name>, unless the tool is newer than all sources, and sets the output variable
+# to the path of the tool. The include path has the cruise and host directories.
+
+include_guard(GLOBAL)
+
+set(HOST_TOOL_SOFTWARE_DIR ${CMAKE_CURRENT_LIST_DIR}/..)
+
+function(host_tool name output)
+    set(sources ${ARGN})
+    set(tool ${CMAKE_BINARY_DIR}/${name}/${name}${CMAKE_HOST_EXECUTABLE_SUFFIX})
+
+    # (Re)build the tool if the sources are newer
+    set(stale FALSE)
+    foreach(source ${sources})
+        if(NOT EXISTS ${tool} OR ${source} IS_NEWER_THAN ${tool})
+            set(stale TRUE)
+        endif()
+    endforeach()
+    if(stale)
+        find_program(HOST_TOOL_CC NAMES cc gcc clang)
+        if(NOT HOST_TOOL_CC)
+            message(FATAL_ERROR "${name}: no native C compiler (cc, gcc or clang) found")
+        endif()
+        file(MAKE_DIRECTORY ${CMAKE_BINARY_DIR}/${name})
+        execute_process(COMMAND ${HOST_TOOL_CC} -std=gnu11 -O2 -I${HOST_TOOL_SOFTWARE_DIR}/cruise
+                                -I${HOST_TOOL_SOFTWARE_DIR}/host ${sources} -o ${tool}
+                        RESULT_VARIABLE result
+                        ERROR_VARIABLE errors)
+        if(NOT result EQUAL 0)
+            message(FATAL_ERROR "${name}: build failed\n${errors}")
+        endif()
+    endif()
+
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${sources})
+    set(${output} ${tool} PARENT_SCOPE)
+endfunction()
@@ -0,0 +1,46 @@
+# Schedulability check of a firmware project's task table when the project is configured.
+#
+#   include(${CMAKE_CURRENT_LIST_DIR}/../../cmake/TaskSetCheck.cmake)
+#   task_set_check(<target> ${CMAKE_CURRENT_LIST_DIR}/tasks.csv)
+#
+# Builds host/rta_check with the native C compiler (HostTool.cmake), runs the
+# response-time analysis on the table and stops the configuration if a task can miss its
+# deadline. The periods, priorities and WCETs of the table are written to taskset.h in the
+# build directory, which is added to the include path of the target, so main() takes them
+# from the table instead of repeating them. The table is checked again whenever it changes.
+#
+# -DTASK_SET_CHECK_ENFORCE=OFF only warns, e.g. for overload experiments.
+
+option(TASK_SET_CHECK_ENFORCE "Stop the configuration if the task table is unschedulable" ON)
+
+set(TASK_SET_CHECK_SOFTWARE_DIR ${CMAKE_CURRENT_LIST_DIR}/..)
+
+include(${CMAKE_CURRENT_LIST_DIR}/HostTool.cmake)
+
+function(task_set_check target table)
+    set(header ${CMAKE_CURRENT_BINARY_DIR}/taskset.h)
+
+    host_tool(rta_check tool ${TASK_SET_CHECK_SOFTWARE_DIR}/host/rta_check.c
+              ${TASK_SET_CHECK_SOFTWARE_DIR}/host/tasktable.c ${TASK_SET_CHECK_SOFTWARE_DIR}/cruise/rta.c)
+
+    execute_process(COMMAND ${tool} -H ${header} ${table}
+                    RESULT_VARIABLE result
+                    OUTPUT_VARIABLE report
+                    ERROR_VARIABLE errors)
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${table})
+    target_include_directories(${target} PRIVATE ${CMAKE_CURRENT_BINARY_DIR})
+
+    if(result EQUAL 0)
+        message(STATUS "Task set check: ${table} is schedulable")
+    elseif(result EQUAL 1)
+        message("${report}")    # Unformatted, the columns would be reflowed in a warning or error
+        if(TASK_SET_CHECK_ENFORCE)
+            message(FATAL_ERROR "Task set check: ${table} is unschedulable. "
+                                "Fix the table, or configure with -DTASK_SET_CHECK_ENFORCE=OFF.")
+        else()
+            message(WARNING "Task set check: ${table} is unschedulable")
+        endif()
+    else()
+        message(FATAL_ERROR "Task set check: ${errors}")
+    endif()
+endfunction()
@@ -0,0 +1,41 @@
+/**
+ * @file blackboard.c
+ *
+ * @brief Shared state of the cruise-control tasks.
+ */
+
+#include "blackboard.h"
+
+void blackboard_init(blackboard_t *bb) {
+    const bb_pedals_t pedals = {0};
+    const bb_vehicle_t vehicle = {0};
+    const bb_control_t control = {0};
+
+    seqlock_init(&bb->pedals.lock, bb->pedals.copy, sizeof(pedals), &pedals);
+    seqlock_init(&bb->vehicle.lock, bb->vehicle.copy, sizeof(vehicle), &vehicle);
+    seqlock_init(&bb->control.lock, bb->control.copy, sizeof(control), &control);
+}
+
+void blackboard_write_pedals(blackboard_t *bb, const bb_pedals_t *pedals) {
+    seqlock_write(&bb->pedals.lock, bb->pedals.copy, sizeof(*pedals), pedals);
+}
+
+uint32_t blackboard_read_pedals(blackboard_t *bb, bb_pedals_t *pedals) {
+    return seqlock_read(&bb->pedals.lock, bb->pedals.copy, sizeof(*pedals), pedals);
+}
+
+void blackboard_write_vehicle(blackboard_t *bb, const bb_vehicle_t *vehicle) {
+    seqlock_write(&bb->vehicle.lock, bb->vehicle.copy, sizeof(*vehicle), vehicle);
+}
+
+uint32_t blackboard_read_vehicle(blackboard_t *bb, bb_vehicle_t *vehicle) {
+    return seqlock_read(&bb->vehicle.lock, bb->vehicle.copy, sizeof(*vehicle), vehicle);
+}
+
+void blackboard_write_control(blackboard_t *bb, const bb_control_t *control) {
+    seqlock_write(&bb->control.lock, bb->control.copy, sizeof(*control), control);
+}
+
+uint32_t blackboard_read_control(blackboard_t *bb, bb_control_t *control) {
+    return seqlock_read(&bb->control.lock, bb->control.copy, sizeof(*control), control);
+}
@@ -0,0 +1,117 @@
+/**
+ * @file blackboard.h
+ *
+ * @brief Shared state of the cruise-control tasks.
+ *
+ * Every task that produces data owns one section of the blackboard and
+ * publishes a complete, consistent snapshot of it in one call. Any task can
+ * copy a section at any time without blocking and without a kernel critical
+ * section (see seqlock.h). Each read also returns the generation of the
+ * section, i.e. the number of snapshots published so far.
+ */
+
+#ifndef BLACKBOARD_H
+#define BLACKBOARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "seqlock.h"
+
+/**
+ * @brief Pedal and button state, written by the Button task.
+ */
+typedef struct {
+    bool gas;                   /* Gas pedal pressed */
+    bool brake;                 /* Brake pedal pressed */
+    bool cruise;                /* Cruise control requested */
+    uint32_t gas_tag;           /* Capture time of the last gas press (latency.h) */
+    uint32_t brake_tag;         /* Capture time of the last brake press (latency.h) */
+} bb_pedals_t;
+
+/**
+ * @brief Vehicle state, written by the Vehicle task.
+ */
+typedef struct {
+    uint16_t velocity;          /* 0.1 m/s */
+    uint16_t position;          /* 0.1 m, 0..24000 */
+} bb_vehicle_t;
+
+/**
+ * @brief Controller output, written by the Control task.
+ */
+typedef struct {
+    uint16_t throttle;          /* 0..80 */
+    uint16_t target_velocity;   /* Cruise target in 0.1 m/s */
+    bool cruise_active;
+    uint32_t gas_tag;           /* Tag of the gas press the throttle reacted to */
+    uint32_t brake_tag;         /* Tag of the brake press the throttle reacted to */
+} bb_control_t;
+
+/**
+ * @brief Blackboard with one section per writer.
+ */
+typedef struct {
+    struct { seqlock_t lock; bb_pedals_t copy[2]; } pedals;
+    struct { seqlock_t lock; bb_vehicle_t copy[2]; } vehicle;
+    struct { seqlock_t lock; bb_control_t copy[2]; } control;
+} blackboard_t;
+
+/**
+ * @brief Clears all sections. Must be called before the tasks start.
+ *
+ * @param bb Blackboard.
+ */
+void blackboard_init(blackboard_t *bb);
+
+/**
+ * @brief Publishes the pedal section.
+ *
+ * @param bb Blackboard.
+ * @param pedals New snapshot.
+ */
+void blackboard_write_pedals(blackboard_t *bb, const bb_pedals_t *pedals);
+
+/**
+ * @brief Copies the pedal section.
+ *
+ * @param bb Blackboard.
+ * @param pedals Filled with the snapshot.
+ * @return uint32_t Generation of the snapshot.
+ */
+uint32_t blackboard_read_pedals(blackboard_t *bb, bb_pedals_t *pedals);
+
+/**
+ * @brief Publishes the vehicle section.
+ *
+ * @param bb Blackboard.
+ * @param vehicle New snapshot.
+ */
+void blackboard_write_vehicle(blackboard_t *bb, const bb_vehicle_t *vehicle);
+
+/**
+ * @brief Copies the vehicle section.
+ *
+ * @param bb Blackboard.
+ * @param vehicle Filled with the snapshot.
+ * @return uint32_t Generation of the snapshot.
+ */
+uint32_t blackboard_read_vehicle(blackboard_t *bb, bb_vehicle_t *vehicle);
+
+/**
+ * @brief Publishes the control section.
+ *
+ * @param bb Blackboard.
+ * @param control New snapshot.
+ */
+void blackboard_write_control(blackboard_t *bb, const bb_control_t *control);
+
+/**
+ * @brief Copies the control section.
+ *
+ * @param bb Blackboard.
+ * @param control Filled with the snapshot.
+ * @return uint32_t Generation of the snapshot.
+ */
+uint32_t blackboard_read_control(blackboard_t *bb, bb_control_t *control);
+
+#endif /* BLACKBOARD_H */
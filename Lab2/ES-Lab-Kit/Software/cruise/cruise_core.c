@@ -0,0 +1,186 @@
+/**
+ * @file cruise_core.c
+ *
+ * @brief Application logic of the cruise-control projects without any I/O.
+ */
+
+#include "cruise_core.h"
+
+const cruise_control_config_t cruise_control_lab = {
+    .throttle_max = 80,
+    .gas_step = 2,
+    .cruise_min_velocity = 250,
+    .error_band = 40,
+    .cruise_step = 3,
+    .pi = 0,
+    .segment_length = 4000,
+};
+
+void cruise_buttons_init(cruise_buttons_t *buttons, bool raw_cruise) {
+    buttons->prev_cruise = raw_cruise;
+    buttons->cruise = false;
+}
+
+bool cruise_buttons_step(cruise_buttons_t *buttons, bool raw_gas, bool raw_brake, bool raw_cruise,
+                         cruise_pedals_t *pedals) {
+    /* Negative edge of the cruise button (pressed -> raw goes from 1 to 0) */
+    bool pressed = (raw_cruise != buttons->prev_cruise) && (raw_cruise == false);
+
+    if (pressed) {
+        buttons->cruise = !buttons->cruise;
+    }
+    buttons->prev_cruise = raw_cruise;
+
+    pedals->gas = !raw_gas;
+    pedals->brake = !raw_brake;
+
+    /* Brake cancels cruise immediately */
+    if (pedals->brake) {
+        buttons->cruise = false;
+    }
+    pedals->cruise = buttons->cruise;
+
+    return pressed;
+}
+
+void cruise_control_init(cruise_control_t *control) {
+    control->throttle = 0;
+    control->target_velocity = 0;
+    control->cruise_active = false;
+    cruise_pi_reset(&control->pi, 0);
+}
+
+uint16_t cruise_control_step(const cruise_control_config_t *config, cruise_control_t *control,
+                             const cruise_pedals_t *pedals, uint16_t velocity, uint16_t position,
+                             bool fresh) {
+    bool was_active = control->cruise_active;
+    uint16_t throttle = control->throttle;
+
+    /* Cruise control toggle logic */
+    if (pedals->brake || pedals->gas) {
+        control->cruise_active = false;     /* brakes or gas deactivate cruise */
+    } else if (pedals->cruise && (velocity >= config->cruise_min_velocity)) {
+        if (!control->cruise_active) {
+            control->cruise_active = true;
+            control->target_velocity = velocity;    /* snapshot current velocity as target */
+        }
+    } else {
+        control->cruise_active = false;
+    }
+
+    /* Never hold a cruise throttle on a stale velocity */
+    if (!fresh) {
+        control->cruise_active = false;
+    }
+
+    if (pedals->brake) {
+        throttle = 0;
+    } else if (pedals->gas) {
+        throttle += config->gas_step;
+        if (throttle > config->throttle_max) {
+            throttle = config->throttle_max;
+        }
+    } else if (control->cruise_active && (config->pi != 0)) {
+        if (!was_active) {
+            cruise_pi_reset(&control->pi, throttle);    /* bumpless engagement */
+        }
+        throttle = cruise_pi_step(config->pi, &control->pi, position / config->segment_length,
+                                  control->target_velocity, velocity);
+    } else if (control->cruise_active) {
+        int32_t err = (int32_t)control->target_velocity - velocity;
+
+        /* simple proportional step adjust, keep the throttle within the band */
+        if (err > config->error_band) {
+            throttle = (throttle + config->cruise_step > config->throttle_max)
+                       ? config->throttle_max : throttle + config->cruise_step;
+        } else if (err < -(int32_t)config->error_band) {
+            throttle = (throttle > config->cruise_step) ? throttle - config->cruise_step : 0;
+        }
+    } else {
+        throttle = 0;
+    }
+
+    control->throttle = throttle;
+    return throttle;
+}
+
+/**
+ * @brief The function returns the new position depending on the input parameters.
+ *
+ * Unchanged from the lab code.
+ */
+static uint16_t adjust_position(uint16_t position, int16_t velocity,
+                                int8_t acceleration, uint16_t time_interval)
+{
+  int16_t new_position = position + velocity * time_interval / 1000
+    + acceleration / 2  * (time_interval / 1000) * (time_interval / 1000);
+
+  if (new_position > 24000) {
+    new_position -= 24000;
+  } else if (new_position < 0){
+    new_position += 24000;
+  }
+
+  return new_position;
+}
+
+/**
+ * @brief The function returns the new velocity depending on the input parameters.
+ *
+ * Unchanged from the lab code.
+ */
+static int16_t adjust_velocity(int16_t velocity, int8_t acceleration,
+                               bool brake_pedal, uint16_t time_interval)
+{
+  int16_t new_velocity;
+  uint8_t brake_retardation = 50;
+
+  if (brake_pedal == false) {
+    new_velocity = velocity  + (float) ((acceleration * time_interval) / 1000);
+    if (new_velocity <= 0) {
+        new_velocity = 0;
+    }
+  }
+  else {
+    if ((float) (brake_retardation * time_interval) / 1000 > velocity) {
+       new_velocity = 0;
+    }
+    else {
+      new_velocity = velocity - (float) brake_retardation * time_interval / 1000;
+    }
+  }
+
+  return new_velocity;
+}
+
+void cruise_vehicle_init(cruise_vehicle_t *vehicle, uint16_t position, uint16_t velocity) {
+    vehicle->position = position;
+    vehicle->velocity = velocity;
+    vehicle_model_init(&vehicle->model, position, velocity);
+}
+
+void cruise_vehicle_step(const cruise_vehicle_config_t *config, cruise_vehicle_t *vehicle,
+                         uint16_t throttle, bool brake, uint16_t interval_ms) {
+    const vehicle_model_t model = { .track = config->track, .substep_us = config->substep_us };
+    const terrain_segment_t *segment;
+    uint16_t wind_factor;
+    uint8_t retardation;
+    uint8_t acceleration;
+
+    if (config->substep_us != 0) {
+        vehicle_model_step(&model, &vehicle->model, throttle, brake, interval_ms * 1000u);
+        vehicle->position = vehicle_model_position(&vehicle->model);
+        vehicle->velocity = vehicle_model_velocity(&vehicle->model);
+        return;
+    }
+
+    /* Same types and wrap-arounds as the lab's vVehicleTask(), including position 24000 on the
+     * steep downhill, so the results are identical */
+    wind_factor = vehicle->velocity * vehicle->velocity / 10000 + 1;
+    segment = terrain_at(config->track, vehicle->position);
+    retardation = wind_factor + segment->grade + segment->wind;
+
+    acceleration = throttle / 2 - retardation;
+    vehicle->position = adjust_position(vehicle->position, vehicle->velocity, acceleration, interval_ms);
+    vehicle->velocity = adjust_velocity(vehicle->velocity, acceleration, brake, interval_ms);
+}
@@ -0,0 +1,165 @@
+/**
+ * @file cruise_core.h
+ *
+ * @brief Application logic of the cruise-control projects without any I/O.
+ *
+ * The three parts of the lab application, as plain functions on explicit
+ * state:
+ * - buttons: active-low pedal inputs and the cruise toggle on the falling
+ *   edge of its button (Button task),
+ * - control: the cruise state machine and the throttle, either the +-3
+ *   step controller or the PI controller of cruise_pi.h (Control task),
+ * - vehicle: the lab physics adjust_position()/adjust_velocity() with the
+ *   terrain of a track map, or the sub-stepped model of vehicle_model.h
+ *   (Vehicle task).
+ *
+ * The tasks only read their inputs, call one step function and publish the
+ * result. The same functions run in the host simulator (Software/host), so
+ * a whole drive can be replayed much faster than real time.
+ */
+
+#ifndef CRUISE_CORE_H
+#define CRUISE_CORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cruise_pi.h"
+#include "terrain.h"
+#include "vehicle_model.h"
+
+/**
+ * @brief Logical pedal state, pressed == true.
+ */
+typedef struct {
+    bool gas;
+    bool brake;
+    bool cruise;        /* Cruise control requested */
+} cruise_pedals_t;
+
+/**
+ * @brief Button state.
+ */
+typedef struct {
+    bool prev_cruise;   /* Last raw level of the cruise button */
+    bool cruise;        /* Cruise control requested */
+} cruise_buttons_t;
+
+/**
+ * @brief Control parameters.
+ */
+typedef struct {
+    uint16_t throttle_max;          /* Throttle range is 0..throttle_max */
+    uint16_t gas_step;              /* Throttle increase per job while the gas pedal is pressed */
+    uint16_t cruise_min_velocity;   /* Cruise control engages at or above, 0.1 m/s */
+    uint16_t error_band;            /* Step controller: no change within +-error_band, 0.1 m/s */
+    uint16_t cruise_step;           /* Step controller: throttle change outside the band */
+    const cruise_pi_config_t *pi;   /* PI controller instead of the step controller, or NULL */
+    uint16_t segment_length;        /* PI controller: track length per gain table entry, 0.1 m */
+} cruise_control_config_t;
+
+/**
+ * @brief Control state.
+ */
+typedef struct {
+    uint16_t throttle;
+    uint16_t target_velocity;   /* Velocity when cruise control engaged, 0.1 m/s */
+    bool cruise_active;
+    cruise_pi_state_t pi;
+} cruise_control_t;
+
+/**
+ * @brief Vehicle parameters.
+ */
+typedef struct {
+    const terrain_map_t *track;     /* Grade and wind */
+    uint32_t substep_us;            /* 0 for the lab physics, else the step of vehicle_model_step() */
+} cruise_vehicle_config_t;
+
+/**
+ * @brief Vehicle state.
+ */
+typedef struct {
+    uint16_t position;      /* 0.1 m */
+    uint16_t velocity;      /* 0.1 m/s */
+    vehicle_state_t model;  /* Only used with substep_us != 0 */
+} cruise_vehicle_t;
+
+/**
+ * @brief Control parameters of the lab: GAS_STEP 2, throttle 0..80, cruise
+ *        from 25 m/s, +-3 outside a +-4 m/s band.
+ */
+extern const cruise_control_config_t cruise_control_lab;
+
+/**
+ * @brief Initialises the button state.
+ *
+ * @param buttons Button state.
+ * @param raw_cruise Current raw level of the cruise button, so a button
+ *        held at startup does not toggle.
+ */
+void cruise_buttons_init(cruise_buttons_t *buttons, bool raw_cruise);
+
+/**
+ * @brief Evaluates one sample of the active-low buttons.
+ *
+ * The falling edge of the cruise button toggles the cruise request, the
+ * brake cancels it.
+ *
+ * @param buttons Button state, updated.
+ * @param raw_gas Raw level of the gas button.
+ * @param raw_brake Raw level of the brake button.
+ * @param raw_cruise Raw level of the cruise button.
+ * @param pedals Logical pedal state, written.
+ * @return bool true if the cruise button was pressed in this sample.
+ */
+bool cruise_buttons_step(cruise_buttons_t *buttons, bool raw_gas, bool raw_brake, bool raw_cruise,
+                         cruise_pedals_t *pedals);
+
+/**
+ * @brief Initialises the control state: throttle 0, cruise control off.
+ */
+void cruise_control_init(cruise_control_t *control);
+
+/**
+ * @brief Computes one control job.
+ *
+ * Gas or brake disengage cruise control. It engages on request once the
+ * velocity reaches cruise_min_velocity and holds the velocity at that
+ * moment. The brake sets the throttle to 0, the gas pedal raises it by
+ * gas_step.
+ *
+ * @param config Control parameters.
+ * @param control Control state, updated.
+ * @param pedals Pedal state.
+ * @param velocity Velocity in 0.1 m/s.
+ * @param position Position in 0.1 m, selects the PI gains.
+ * @param fresh false if the velocity was not updated since the last job;
+ *        cruise control then disengages instead of acting on stale data.
+ * @return uint16_t New throttle.
+ */
+uint16_t cruise_control_step(const cruise_control_config_t *config, cruise_control_t *control,
+                             const cruise_pedals_t *pedals, uint16_t velocity, uint16_t position,
+                             bool fresh);
+
+/**
+ * @brief Sets the vehicle state.
+ *
+ * @param vehicle Vehicle state.
+ * @param position Position in 0.1 m.
+ * @param velocity Velocity in 0.1 m/s.
+ */
+void cruise_vehicle_init(cruise_vehicle_t *vehicle, uint16_t position, uint16_t velocity);
+
+/**
+ * @brief Advances the vehicle by one period.
+ *
+ * @param config Vehicle parameters.
+ * @param vehicle Vehicle state, updated.
+ * @param throttle Throttle 0..80.
+ * @param brake Brake pedal pressed.
+ * @param interval_ms Period in ms.
+ */
+void cruise_vehicle_step(const cruise_vehicle_config_t *config, cruise_vehicle_t *vehicle,
+                         uint16_t throttle, bool brake, uint16_t interval_ms);
+
+#endif /* CRUISE_CORE_H */
@@ -0,0 +1,74 @@
+/**
+ * @file cruise_pi.c
+ *
+ * @brief Fixed-point PI cruise controller with anti-windup, rate limiting
+ *        and gain scheduling.
+ */
+
+#include "cruise_pi.h"
+
+/**
+ * @brief Gains per segment of the lab track. The uphill segments need more
+ *        gain to build up the holding throttle quickly; downhill the
+ *        throttle is zero most of the time anyway.
+ */
+static const cruise_pi_gains_t default_gains[] = {
+    { Q16(0.60), Q16(0.15) },   /* 0-4000: flat */
+    { Q16(0.80), Q16(0.20) },   /* 4000-8000: uphill */
+    { Q16(1.00), Q16(0.25) },   /* 8000-12000: steep uphill */
+    { Q16(0.60), Q16(0.15) },   /* 12000-16000: flat */
+    { Q16(0.60), Q16(0.15) },   /* 16000-20000: downhill */
+    { Q16(0.60), Q16(0.15) },   /* 20000-24000: steep downhill */
+};
+
+const cruise_pi_config_t cruise_pi_default = {
+    .gains = default_gains,
+    .segments = sizeof(default_gains) / sizeof(default_gains[0]),
+    .throttle_max = 80,
+    .rate_limit = 10,
+};
+
+static inline q16_t clamp(q16_t value, q16_t min, q16_t max) {
+    return (value < min) ? min : ((value > max) ? max : value);
+}
+
+void cruise_pi_reset(cruise_pi_state_t *state, uint16_t throttle) {
+    state->integrator = (q16_t)throttle << 16;
+    state->throttle = throttle;
+}
+
+uint16_t cruise_pi_step(const cruise_pi_config_t *config, cruise_pi_state_t *state,
+                        uint8_t segment, uint16_t target, uint16_t velocity) {
+    const cruise_pi_gains_t *g;
+    const q16_t max = (q16_t)config->throttle_max << 16;
+    int32_t err = (int32_t)target - (int32_t)velocity;
+    q16_t output;
+    int32_t throttle;
+    int32_t step;
+
+    if (segment >= config->segments) {
+        segment = config->segments - 1;
+    }
+    g = &config->gains[segment];
+
+    output = g->kp * err + state->integrator;
+
+    /* Anti-windup: integrate only if the output is not saturated in the
+     * direction the error would drive it. */
+    if (!((output >= max) && (err > 0)) && !((output <= 0) && (err < 0))) {
+        state->integrator = clamp(state->integrator + g->ki * err, 0, max);
+        output = g->kp * err + state->integrator;
+    }
+
+    /* Round to the nearest throttle step and limit the rate of change. */
+    throttle = (clamp(output, 0, max) + (1 << 15)) >> 16;
+    step = throttle - (int32_t)state->throttle;
+    if (step > (int32_t)config->rate_limit) {
+        throttle = state->throttle + config->rate_limit;
+    } else if (step < -(int32_t)config->rate_limit) {
+        throttle = state->throttle - config->rate_limit;
+    }
+
+    state->throttle = (uint16_t)throttle;
+    return state->throttle;
+}
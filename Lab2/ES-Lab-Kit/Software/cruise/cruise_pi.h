@@ -0,0 +1,89 @@
+/**
+ * @file cruise_pi.h
+ *
+ * @brief Fixed-point PI cruise controller with anti-windup, rate limiting
+ *        and gain scheduling.
+ *
+ * The controller computes the throttle from the velocity error:
+ *
+ *     throttle = kp * err + I,    I += ki * err
+ *
+ * Gains are in Q16 (65536 = 1.0) and are taken from a table indexed by the
+ * terrain segment the vehicle is on. The integrator is clamped to the
+ * throttle range and is frozen while the output saturates in the direction
+ * of the error (anti-windup). The output change per step is rate limited.
+ *
+ * cruise_pi_step() only reads its arguments and updates the state, so the
+ * controller can be run on the host against a vehicle model.
+ */
+
+#ifndef CRUISE_PI_H
+#define CRUISE_PI_H
+
+#include <stdint.h>
+
+/**
+ * @brief Signed Q16.16 fixed-point number.
+ */
+typedef int32_t q16_t;
+
+/**
+ * @brief Converts a constant to Q16, for initialisers.
+ */
+#define Q16(x)      ((q16_t)((x) * 65536.0 + ((x) >= 0 ? 0.5 : -0.5)))
+
+/**
+ * @brief Gains for one terrain segment, per controller step.
+ */
+typedef struct {
+    q16_t kp;       /* Throttle per 0.1 m/s of error */
+    q16_t ki;       /* Throttle per 0.1 m/s of error and step */
+} cruise_pi_gains_t;
+
+/**
+ * @brief Controller configuration.
+ */
+typedef struct {
+    const cruise_pi_gains_t *gains; /* One entry per segment */
+    uint8_t segments;               /* Number of entries in gains */
+    uint16_t throttle_max;          /* Output range is 0..throttle_max */
+    uint16_t rate_limit;            /* Maximum output change per step */
+} cruise_pi_config_t;
+
+/**
+ * @brief Controller state.
+ */
+typedef struct {
+    q16_t integrator;   /* Integral part in throttle units */
+    uint16_t throttle;  /* Last output */
+} cruise_pi_state_t;
+
+/**
+ * @brief Default gain table for the six 4000-unit segments of the lab
+ *        track (flat, uphill, steep uphill, flat, downhill, steep
+ *        downhill), tuned for a 200 ms step and also stable at 100 ms.
+ */
+extern const cruise_pi_config_t cruise_pi_default;
+
+/**
+ * @brief Resets the controller for bumpless engagement.
+ *
+ * @param state Controller state.
+ * @param throttle Throttle applied at engagement, becomes the integrator.
+ */
+void cruise_pi_reset(cruise_pi_state_t *state, uint16_t throttle);
+
+/**
+ * @brief Computes one controller step.
+ *
+ * @param config Controller configuration.
+ * @param state Controller state, updated.
+ * @param segment Terrain segment of the vehicle, clamped to the table.
+ * @param target Target velocity in 0.1 m/s.
+ * @param velocity Measured velocity in 0.1 m/s.
+ * @return uint16_t New throttle.
+ */
+uint16_t cruise_pi_step(const cruise_pi_config_t *config, cruise_pi_state_t *state,
+                        uint8_t segment, uint16_t target, uint16_t velocity);
+
+#endif /* CRUISE_PI_H */
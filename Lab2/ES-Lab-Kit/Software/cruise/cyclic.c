@@ -0,0 +1,127 @@
+/**
+ * @file cyclic.c
+ *
+ * @brief Table-driven cyclic executive and the job statistics to compare it
+ *        with the preemptive scheduler.
+ */
+
+#include "cyclic.h"
+
+void cyclic_init(cyclic_t *c, const cyclic_table_t *table, const cyclic_job_t *jobs, uint8_t tasks,
+                 cyclic_clock_t clock) {
+    c->table = table;
+    c->jobs = jobs;
+    c->clock = clock;
+    c->tasks = (tasks <= CYCLIC_MAX_TASKS) ? tasks : CYCLIC_MAX_TASKS;
+    c->frame = 0;
+    c->hyperperiod_start_us = 0;
+    c->frames_run = 0;
+    c->overruns = 0;
+    c->max_frame_us = 0;
+    c->busy_us = 0;
+    c->job_us = 0;
+    c->depth = 0;
+    for (uint8_t i = 0; i < CYCLIC_MAX_TASKS; i++) {
+        latstat_init(&c->stats[i].latency);
+        latstat_init(&c->stats[i].exec);
+    }
+}
+
+uint32_t cyclic_run_frame(cyclic_t *c, uint32_t start_us) {
+    const cyclic_table_t *t = c->table;
+    uint32_t entered_us = c->clock();
+    uint32_t next_us = start_us + t->frame_us;
+    uint32_t ended_us;
+
+    if (c->frame == 0) {
+        c->hyperperiod_start_us = start_us;
+    }
+    for (uint16_t i = t->first[c->frame]; i < t->first[c->frame + 1]; i++) {
+        const cyclic_entry_t *e = &t->entries[i];
+
+        cyclic_job_begin(c, e->task, c->hyperperiod_start_us + e->release_ms * 1000u);
+        c->jobs[e->task]();
+        cyclic_job_end(c);
+    }
+
+    ended_us = c->clock();
+    c->busy_us += ended_us - entered_us;
+    if (ended_us - start_us > c->max_frame_us) {
+        c->max_frame_us = ended_us - start_us;
+    }
+    if ((int32_t)(ended_us - next_us) > 0) {
+        c->overruns++;
+    }
+    c->frames_run++;
+    c->frame = (c->frame + 1u < t->frames) ? c->frame + 1u : 0;
+
+    return next_us;
+}
+
+void cyclic_restart(cyclic_t *c) {
+    c->frame = 0;
+}
+
+void cyclic_job_begin(cyclic_t *c, uint8_t task, uint32_t release_us) {
+    uint32_t now = c->clock();
+    int32_t latency = (int32_t)(now - release_us);
+
+    if ((task >= c->tasks) || (c->depth == CYCLIC_MAX_TASKS)) {
+        return;
+    }
+    /* A start before the release can only be a clock offset, count it as 0 */
+    latstat_add(&c->stats[task].latency, (latency > 0) ? (uint32_t)latency : 0);
+    c->running[c->depth++] = (cyclic_running_t){ .task = task, .start_us = now, .preempted_us = 0 };
+}
+
+void cyclic_job_end(cyclic_t *c) {
+    cyclic_running_t *r;
+    uint32_t gross;
+
+    if (c->depth == 0) {
+        return;
+    }
+    r = &c->running[--c->depth];
+    gross = c->clock() - r->start_us;
+    latstat_add(&c->stats[r->task].exec, gross - r->preempted_us);
+    c->job_us += gross - r->preempted_us;
+    if (c->depth > 0) {
+        c->running[c->depth - 1].preempted_us += gross;
+    }
+}
+
+static unsigned permille(uint64_t part, uint64_t whole) {
+    if ((whole == 0) || (part >= whole)) {
+        return (whole == 0) ? 0 : 1000u;
+    }
+    return (unsigned)(part * 1000u / whole);
+}
+
+void cyclic_report(const cyclic_t *c, const char *const names[], uint64_t elapsed_us, uint64_t busy_us,
+                   FILE *out) {
+    unsigned jobs = permille(c->job_us, elapsed_us);
+    unsigned busy = permille(busy_us, elapsed_us);
+    unsigned overhead = (busy > jobs) ? busy - jobs : 0;
+
+    fprintf(out, "%-12s %8s %21s %8s %21s\n", "Task", "Jobs", "Latency min/avg/max", "Jitter",
+            "Exec min/avg/max");
+    for (uint8_t i = 0; i < c->tasks; i++) {
+        const cyclic_stats_t *s = &c->stats[i];
+        uint32_t min_latency = (s->latency.count > 0) ? s->latency.min_us : 0;
+        uint32_t min_exec = (s->exec.count > 0) ? s->exec.min_us : 0;
+
+        fprintf(out, "%-12s %8lu %6lu/%6lu/%7lu %8lu %6lu/%6lu/%7lu\n", names[i],
+                (unsigned long)s->exec.count, (unsigned long)min_latency,
+                (unsigned long)latstat_avg(&s->latency), (unsigned long)s->latency.max_us,
+                (unsigned long)(s->latency.max_us - min_latency), (unsigned long)min_exec,
+                (unsigned long)latstat_avg(&s->exec), (unsigned long)s->exec.max_us);
+    }
+    if (c->table != NULL) {
+        fprintf(out, "Frames: %lu of %lu us, %lu overruns, longest %lu us\n", (unsigned long)c->frames_run,
+                (unsigned long)c->table->frame_us, (unsigned long)c->overruns,
+                (unsigned long)c->max_frame_us);
+    }
+    fprintf(out, "CPU: jobs %u.%u %%, overhead %u.%u %%, idle %u.%u %% of %llu ms\n", jobs / 10, jobs % 10,
+            overhead / 10, overhead % 10, (1000u - busy) / 10, (1000u - busy) % 10,
+            (unsigned long long)(elapsed_us / 1000u));
+}
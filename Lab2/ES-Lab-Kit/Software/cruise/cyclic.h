@@ -0,0 +1,173 @@
+/**
+ * @file cyclic.h
+ *
+ * @brief Table-driven cyclic executive and the job statistics to compare it
+ *        with the preemptive scheduler.
+ *
+ * The hyperperiod (the least common multiple of the periods) is divided into
+ * frames of equal length. The frame table, built offline by the host tool
+ * cyclic_gen from the task table, lists the jobs of every frame with their
+ * release time within the hyperperiod. A timer interrupt at every frame start
+ * calls cyclic_run_frame(), which runs the jobs of the frame to completion
+ * one after the other. There are no tasks, no stacks per task and no
+ * context switches; the only run-time decision is the frame index.
+ *
+ * The frame size f chosen by cyclic_gen satisfies the classic conditions:
+ * f divides the hyperperiod, every job fits into one frame (f >= C), and
+ * between the release and the deadline of every job there is a full frame
+ * (2f - gcd(f, T) <= D). A frame whose jobs end after the start of the next
+ * frame is counted as an overrun; the next frame then starts late, so the
+ * table is never left.
+ *
+ * The same statistics are kept for both schedulers: for every job the start
+ * latency (start - release), whose spread max - min is the release jitter,
+ * and the execution time without preemption by other recorded jobs. With
+ * the busy time of the CPU, cyclic_report() splits the load into the jobs
+ * and the scheduling overhead. In the preemptive build the tasks call
+ * cyclic_job_begin() and cyclic_job_end() themselves, in a critical section
+ * because a job may be preempted by another one.
+ */
+
+#ifndef CYCLIC_H
+#define CYCLIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "latstat.h"
+
+/**
+ * @brief Maximum number of tasks.
+ */
+#define CYCLIC_MAX_TASKS            8
+
+/**
+ * @brief One job of the frame table.
+ */
+typedef struct {
+    uint8_t task;               /* Index into the job functions */
+    uint16_t release_ms;        /* Release within the hyperperiod */
+} cyclic_entry_t;
+
+/**
+ * @brief Frame table, generated by cyclic_gen.
+ */
+typedef struct {
+    uint32_t frame_us;
+    uint16_t frames;            /* Frames per hyperperiod */
+    uint8_t tasks;
+    const uint16_t *first;      /* Jobs of frame i: entries[first[i]] .. entries[first[i + 1] - 1] */
+    const cyclic_entry_t *entries;
+} cyclic_table_t;
+
+/**
+ * @brief Job function, runs one job of a task to completion.
+ */
+typedef void (*cyclic_job_t)(void);
+
+/**
+ * @brief Free-running time in us, e.g. time_us_32().
+ */
+typedef uint32_t (*cyclic_clock_t)(void);
+
+/**
+ * @brief Statistics of one task.
+ */
+typedef struct {
+    latstat_t latency;          /* Start - release */
+    latstat_t exec;             /* Execution time without preemption */
+} cyclic_stats_t;
+
+/**
+ * @brief Job that has begun and not yet ended.
+ */
+typedef struct {
+    uint8_t task;
+    uint32_t start_us;
+    uint32_t preempted_us;      /* Time of the jobs that preempted it */
+} cyclic_running_t;
+
+/**
+ * @brief State of the executive.
+ */
+typedef struct {
+    const cyclic_table_t *table;
+    const cyclic_job_t *jobs;
+    cyclic_clock_t clock;
+    uint8_t tasks;
+    uint16_t frame;                 /* Next frame */
+    uint32_t hyperperiod_start_us;  /* Start of frame 0 */
+    uint32_t frames_run;
+    uint32_t overruns;              /* Frames that ended after the next frame start */
+    uint32_t max_frame_us;          /* Longest frame, dispatcher included */
+    uint64_t busy_us;               /* Time in cyclic_run_frame() */
+    uint64_t job_us;                /* Net execution time of all jobs */
+    cyclic_stats_t stats[CYCLIC_MAX_TASKS];
+    cyclic_running_t running[CYCLIC_MAX_TASKS];
+    uint8_t depth;                  /* Number of running jobs */
+} cyclic_t;
+
+/**
+ * @brief Initialises the executive and clears the statistics.
+ *
+ * @param c Executive.
+ * @param table Frame table, or NULL if only the job statistics are used.
+ * @param jobs Job function of each task, or NULL with table NULL.
+ * @param tasks Number of tasks, at most CYCLIC_MAX_TASKS.
+ * @param clock Time source of the statistics.
+ */
+void cyclic_init(cyclic_t *c, const cyclic_table_t *table, const cyclic_job_t *jobs, uint8_t tasks,
+                 cyclic_clock_t clock);
+
+/**
+ * @brief Runs the jobs of the next frame. Call at every frame start, e.g.
+ *        from a timer interrupt.
+ *
+ * @param c Executive.
+ * @param start_us Ideal start of this frame; the releases of its jobs are
+ *        counted from there.
+ * @return uint32_t Ideal start of the next frame, start_us + frame_us.
+ */
+uint32_t cyclic_run_frame(cyclic_t *c, uint32_t start_us);
+
+/**
+ * @brief Starts the next cyclic_run_frame() at frame 0, e.g. after the
+ *        executive was paused.
+ *
+ * @param c Executive.
+ */
+void cyclic_restart(cyclic_t *c);
+
+/**
+ * @brief Records the start of a job.
+ *
+ * @param c Executive.
+ * @param task Task index.
+ * @param release_us Release time of the job.
+ */
+void cyclic_job_begin(cyclic_t *c, uint8_t task, uint32_t release_us);
+
+/**
+ * @brief Records the end of the job begun last.
+ *
+ * @param c Executive.
+ */
+void cyclic_job_end(cyclic_t *c);
+
+/**
+ * @brief Prints the jobs, start latency, jitter and execution time of every
+ *        task, the frames and overruns, and the CPU time of the jobs and of
+ *        the scheduling overhead.
+ *
+ * @param c Executive.
+ * @param names Task names, one per task.
+ * @param elapsed_us Measurement time.
+ * @param busy_us Time the CPU was not idle within elapsed_us. For the cyclic
+ *        executive the time in the frame interrupt, which c->busy_us
+ *        underestimates by the interrupt entry and the re-arming of the timer.
+ * @param out Output stream.
+ */
+void cyclic_report(const cyclic_t *c, const char *const names[], uint64_t elapsed_us, uint64_t busy_us,
+                   FILE *out);
+
+#endif /* CYCLIC_H */
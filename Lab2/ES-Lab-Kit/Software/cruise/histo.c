@@ -0,0 +1,71 @@
+/**
+ * @file histo.c
+ *
+ * @brief Histogram of latency samples on a 1-2-5 scale.
+ */
+
+#include "histo.h"
+
+#define BAR_LENGTH          40u
+
+static const uint32_t limits[HISTO_BUCKETS - 1] = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000
+};
+
+void histo_init(histo_t *h) {
+    for (unsigned i = 0; i < HISTO_BUCKETS; i++) {
+        h->count[i] = 0;
+    }
+    latstat_init(&h->stat);
+}
+
+void histo_add(histo_t *h, uint32_t us) {
+    unsigned i = 0;
+
+    while ((i < HISTO_BUCKETS - 1) && (us >= limits[i])) {
+        i++;
+    }
+    h->count[i]++;
+    latstat_add(&h->stat, us);
+}
+
+uint32_t histo_limit(unsigned bucket) {
+    return (bucket < HISTO_BUCKETS - 1) ? limits[bucket] : UINT32_MAX;
+}
+
+void histo_print(const histo_t *h, FILE *out) {
+    unsigned first = HISTO_BUCKETS, last = 0;
+    uint32_t peak = 0;
+
+    if (h->stat.count == 0) {
+        fprintf(out, "  no samples\n");
+        return;
+    }
+    fprintf(out, "  %lu samples, min %lu us, avg %lu us, max %lu us, jitter %lu us\n",
+            (unsigned long)h->stat.count, (unsigned long)h->stat.min_us,
+            (unsigned long)latstat_avg(&h->stat), (unsigned long)h->stat.max_us,
+            (unsigned long)(h->stat.max_us - h->stat.min_us));
+    for (unsigned i = 0; i < HISTO_BUCKETS; i++) {
+        if (h->count[i] > 0) {
+            first = (i < first) ? i : first;
+            last = i;
+            peak = (h->count[i] > peak) ? h->count[i] : peak;
+        }
+    }
+    for (unsigned i = first; i <= last; i++) {
+        unsigned bar = (unsigned)((uint64_t)h->count[i] * BAR_LENGTH / peak);
+
+        if (i < HISTO_BUCKETS - 1) {
+            fprintf(out, "  < %5lu us %8lu", (unsigned long)limits[i], (unsigned long)h->count[i]);
+        } else {
+            fprintf(out, "  >=%5lu us %8lu", (unsigned long)limits[i - 1], (unsigned long)h->count[i]);
+        }
+        if (h->count[i] > 0) {
+            fputc(' ', out);
+        }
+        for (unsigned j = 0; j < bar; j++) {
+            fputc('#', out);
+        }
+        fputs(((h->count[i] > 0) && (bar == 0)) ? ".\n" : "\n", out);   /* Too few for a full character */
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ * @file histo.h
+ *
+ * @brief Histogram of latency samples on a 1-2-5 scale, e.g. for release
+ *        jitter.
+ *
+ * The bucket limits are 1, 2, 5, 10, 20, 50 ... 10000 us; the last bucket
+ * holds everything from 10 ms on. The scale resolves a few microseconds of
+ * interrupt latency as well as the up to one tick of a tick-based release
+ * in the same table. Min, average and max are kept exactly (latstat.h).
+ */
+
+#ifndef HISTO_H
+#define HISTO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "latstat.h"
+
+/**
+ * @brief Number of buckets.
+ */
+#define HISTO_BUCKETS               14
+
+/**
+ * @brief Histogram and exact statistics.
+ */
+typedef struct {
+    uint32_t count[HISTO_BUCKETS];
+    latstat_t stat;
+} histo_t;
+
+/**
+ * @brief Clears the histogram.
+ *
+ * @param h Histogram.
+ */
+void histo_init(histo_t *h);
+
+/**
+ * @brief Adds one sample.
+ *
+ * @param h Histogram.
+ * @param us Sample in us.
+ */
+void histo_add(histo_t *h, uint32_t us);
+
+/**
+ * @brief Returns the upper limit of a bucket.
+ *
+ * @param bucket Bucket index.
+ * @return uint32_t Limit in us (exclusive), UINT32_MAX for the last bucket.
+ */
+uint32_t histo_limit(unsigned bucket);
+
+/**
+ * @brief Prints min/avg/max and the buckets from the first to the last
+ *        non-empty one, with a bar of up to 40 characters.
+ *
+ * @param h Histogram.
+ * @param out Output stream.
+ */
+void histo_print(const histo_t *h, FILE *out);
+
+#endif /* HISTO_H */
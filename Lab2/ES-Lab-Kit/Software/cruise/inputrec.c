@@ -0,0 +1,254 @@
+/**
+ * @file inputrec.c
+ *
+ * @brief Compact recording of input snapshots for deterministic replay.
+ */
+
+#include <string.h>
+#include "inputrec.h"
+
+#define HAS_INPUTS      0x01u   /* Header: inputs changed, XOR follows */
+#define HAS_ACC         0x02u   /* Header: acceleration changed, deltas follow */
+#define FRAME_MAX       (1u + 5u + 5u + 3u * 3u)
+
+static uint8_t *put_varint(uint8_t *p, uint32_t value) {
+    while (value >= 0x80u) {
+        *p++ = (uint8_t)(value | 0x80u);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+static const uint8_t *get_varint(const uint8_t *p, const uint8_t *end, uint32_t *value) {
+    uint32_t result = 0;
+
+    for (unsigned shift = 0; (p < end) && (shift < 35u); shift += 7u) {
+        uint8_t byte = *p++;
+
+        result |= (uint32_t)(byte & 0x7Fu) << shift;
+        if ((byte & 0x80u) == 0) {
+            *value = result;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+/* Zigzag: small negative and positive deltas both become small numbers */
+static uint32_t zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1u);
+}
+
+/**
+ * @brief Encodes frame as delta to prev, returns the end of the encoding.
+ */
+static uint8_t *encode(uint8_t *p, const inputrec_frame_t *prev, const inputrec_frame_t *frame) {
+    uint8_t *header = p++;
+
+    *header = 0;
+    p = put_varint(p, frame->time_ms - prev->time_ms);
+    if (frame->inputs != prev->inputs) {
+        *header |= HAS_INPUTS;
+        p = put_varint(p, frame->inputs ^ prev->inputs);
+    }
+    if (memcmp(frame->acc, prev->acc, sizeof(frame->acc)) != 0) {
+        *header |= HAS_ACC;
+        for (int i = 0; i < 3; i++) {
+            p = put_varint(p, zigzag((int32_t)frame->acc[i] - prev->acc[i]));
+        }
+    }
+    return p;
+}
+
+static const uint8_t *decode(const uint8_t *p, const uint8_t *end, inputrec_frame_t *frame) {
+    uint8_t header;
+    uint32_t value;
+
+    if (p >= end) {
+        return NULL;
+    }
+    header = *p++;
+    if (((p = get_varint(p, end, &value)) == NULL)) {
+        return NULL;
+    }
+    frame->time_ms += value;
+    if (header & HAS_INPUTS) {
+        if ((p = get_varint(p, end, &value)) == NULL) {
+            return NULL;
+        }
+        frame->inputs ^= value;
+    }
+    if (header & HAS_ACC) {
+        for (int i = 0; i < 3; i++) {
+            if ((p = get_varint(p, end, &value)) == NULL) {
+                return NULL;
+            }
+            frame->acc[i] = (int16_t)(frame->acc[i] + unzigzag(value));
+        }
+    }
+    return p;
+}
+
+bool inputrec_init(inputrec_t *rec, void *buffer, size_t size) {
+    memset(rec, 0, sizeof(*rec));
+    if (size < sizeof(inputrec_block_t)) {
+        return false;
+    }
+    rec->blocks = buffer;
+    rec->count = (uint32_t)(size / sizeof(inputrec_block_t));
+    for (uint32_t i = 0; i < rec->count; i++) {
+        rec->blocks[i].seq = 0;
+    }
+    return true;
+}
+
+/**
+ * @brief Starts the next block, overwriting the oldest one.
+ */
+static void next_block(inputrec_t *rec) {
+    inputrec_block_t *block;
+
+    if (rec->seq != 0) {
+        rec->head = (rec->head + 1u == rec->count) ? 0 : rec->head + 1u;
+    }
+    block = &rec->blocks[rec->head];
+    block->used = 0;
+    block->frames = 0;
+    block->seq = ++rec->seq;
+    memset(&rec->prev, 0, sizeof(rec->prev));
+}
+
+void inputrec_add(inputrec_t *rec, const inputrec_frame_t *frame) {
+    uint8_t buffer[FRAME_MAX];
+    inputrec_block_t *block = &rec->blocks[rec->head];
+    size_t len;
+
+    if (rec->seq == 0) {
+        next_block(rec);
+        block = &rec->blocks[rec->head];
+    }
+
+    len = (size_t)(encode(buffer, &rec->prev, frame) - buffer);
+    if (block->used + len > sizeof(block->data)) {
+        next_block(rec);
+        block = &rec->blocks[rec->head];
+        len = (size_t)(encode(buffer, &rec->prev, frame) - buffer);
+    }
+
+    memcpy(&block->data[block->used], buffer, len);
+    block->used = (uint16_t)(block->used + len);
+    block->frames++;
+    rec->prev = *frame;
+    rec->frames++;
+}
+
+void inputrec_reader_init(inputrec_reader_t *reader, const inputrec_t *rec) {
+    uint32_t first = 0;
+    uint32_t blocks = rec->seq;
+
+    if (rec->seq > rec->count) {
+        first = (rec->head + 1u == rec->count) ? 0 : rec->head + 1u;
+        blocks = rec->count;
+    }
+    memset(reader, 0, sizeof(*reader));
+    reader->blocks = rec->blocks;
+    reader->count = rec->count;
+    reader->block = first;
+    reader->remaining = (blocks > 0) ? blocks - 1u : 0;
+    if (blocks == 0) {
+        reader->count = 0;  /* empty */
+    }
+}
+
+void inputrec_reader_init_blocks(inputrec_reader_t *reader, const inputrec_block_t *blocks,
+                                 uint32_t count) {
+    memset(reader, 0, sizeof(*reader));
+    reader->blocks = blocks;
+    reader->count = count;
+    reader->remaining = (count > 0) ? count - 1u : 0;
+}
+
+bool inputrec_read(inputrec_reader_t *reader, inputrec_frame_t *frame) {
+    const inputrec_block_t *block;
+    const uint8_t *p;
+
+    if (reader->count == 0) {
+        return false;
+    }
+
+    block = &reader->blocks[reader->block];
+    while (reader->offset >= block->used) {
+        if (reader->remaining == 0) {
+            return false;
+        }
+        reader->remaining--;
+        reader->block = (reader->block + 1u == reader->count) ? 0 : reader->block + 1u;
+        reader->offset = 0;
+        memset(&reader->prev, 0, sizeof(reader->prev));
+        block = &reader->blocks[reader->block];
+    }
+
+    p = decode(&block->data[reader->offset], &block->data[block->used], &reader->prev);
+    if (p == NULL) {
+        return false;
+    }
+    reader->offset = (uint16_t)(p - block->data);
+    *frame = reader->prev;
+    return true;
+}
+
+void inputrec_dump(const inputrec_t *rec, FILE *out) {
+    inputrec_reader_t reader;
+
+    inputrec_reader_init(&reader, rec);
+    fprintf(out, "IR begin %lu frames\n", (unsigned long)rec->frames);
+    for (uint32_t n = 0; (reader.count > 0) && (n <= reader.remaining); n++) {
+        uint32_t i = (reader.block + n) % rec->count;
+        const inputrec_block_t *block = &rec->blocks[i];
+
+        fprintf(out, "IR %lu %u ", (unsigned long)block->seq, block->frames);
+        for (uint16_t b = 0; b < block->used; b++) {
+            fprintf(out, "%02x", block->data[b]);
+        }
+        fprintf(out, "\n");
+    }
+    fprintf(out, "IR end\n");
+}
+
+static int hex_digit(char c) {
+    if ((c >= '0') && (c <= '9')) {
+        return c - '0';
+    }
+    if ((c >= 'a') && (c <= 'f')) {
+        return c - 'a' + 10;
+    }
+    if ((c >= 'A') && (c <= 'F')) {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+bool inputrec_parse_line(const char *line, inputrec_block_t *block) {
+    unsigned long seq;
+    unsigned frames;
+    int start = 0;
+
+    if ((sscanf(line, "IR %lu %u %n", &seq, &frames, &start) != 2) || (start == 0) || (seq == 0)) {
+        return false;
+    }
+    memset(block, 0, sizeof(*block));
+    block->seq = (uint32_t)seq;
+    block->frames = (uint16_t)frames;
+    for (const char *p = line + start; (hex_digit(p[0]) >= 0) && (hex_digit(p[1]) >= 0); p += 2) {
+        if (block->used == sizeof(block->data)) {
+            return false;
+        }
+        block->data[block->used++] = (uint8_t)(hex_digit(p[0]) << 4 | hex_digit(p[1]));
+    }
+    return true;
+}
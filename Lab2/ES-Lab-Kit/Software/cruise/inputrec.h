@@ -0,0 +1,160 @@
+/**
+ * @file inputrec.h
+ *
+ * @brief Compact recording of input snapshots for deterministic replay.
+ *
+ * A frame is one sample of all inputs of the lab kit: the raw levels of
+ * the buttons and switches and the accelerometer. Frames are stored as
+ * deltas to the previous frame: a header byte, the time difference and only
+ * the fields that changed, as variable-length integers. A frame without
+ * changes takes two bytes.
+ *
+ * The recording is a ring of fixed-size blocks. Every block starts from an
+ * all-zero frame, so it can be decoded on its own. When the ring is full
+ * the oldest block is overwritten. The buffer can be SRAM or PSRAM.
+ *
+ * inputrec_dump() prints the blocks as text lines ("IR ..."), which
+ * inputrec_parse_line() reads back on the host. Replaying the frames in
+ * place of the hardware gives the application exactly the recorded inputs
+ * at every job.
+ */
+
+#ifndef INPUTREC_H
+#define INPUTREC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @brief Bits of inputrec_frame_t.inputs: raw levels, buttons are active-low.
+ */
+enum {
+    INPUTREC_SW_5,      /* Brake */
+    INPUTREC_SW_6,      /* Cruise */
+    INPUTREC_SW_7,      /* Gas */
+    INPUTREC_SW_8,
+    INPUTREC_SW_10,     /* Switches SW_10..SW_17 */
+    INPUTREC_SW_11,
+    INPUTREC_SW_12,
+    INPUTREC_SW_13,
+    INPUTREC_SW_14,
+    INPUTREC_SW_15,
+    INPUTREC_SW_16,
+    INPUTREC_SW_17,
+    INPUTREC_INPUTS
+};
+
+/**
+ * @brief Size of one block in bytes.
+ */
+#define INPUTREC_BLOCK_SIZE     256u
+
+/**
+ * @brief One input snapshot.
+ */
+typedef struct {
+    uint32_t time_ms;
+    uint32_t inputs;        /* Bit INPUTREC_SW_x = raw level of SW_x */
+    int16_t acc[3];         /* Acceleration x, y, z in mg */
+} inputrec_frame_t;
+
+/**
+ * @brief Block of the ring.
+ */
+typedef struct {
+    uint32_t seq;           /* Block number, starting at 1; 0 = unused */
+    uint16_t used;          /* Bytes in data */
+    uint16_t frames;        /* Frames in data */
+    uint8_t data[INPUTREC_BLOCK_SIZE - 8u];
+} inputrec_block_t;
+
+/**
+ * @brief Recorder.
+ */
+typedef struct {
+    inputrec_block_t *blocks;
+    uint32_t count;         /* Blocks in the ring */
+    uint32_t head;          /* Block being written */
+    uint32_t seq;           /* Number of the head block */
+    uint32_t frames;        /* Frames recorded in total */
+    inputrec_frame_t prev;  /* Last frame of the head block */
+} inputrec_t;
+
+/**
+ * @brief Reader, frames from the oldest to the newest.
+ */
+typedef struct {
+    const inputrec_block_t *blocks;
+    uint32_t count;         /* Blocks in the ring */
+    uint32_t block;         /* Block being read */
+    uint32_t remaining;     /* Blocks after the current one */
+    uint16_t offset;        /* Read position in the block */
+    inputrec_frame_t prev;
+} inputrec_reader_t;
+
+/**
+ * @brief Initialises a recorder.
+ *
+ * @param rec Recorder.
+ * @param buffer Buffer, aligned to 4 bytes.
+ * @param size Size of the buffer, at least one block.
+ * @return bool false if the buffer is too small.
+ */
+bool inputrec_init(inputrec_t *rec, void *buffer, size_t size);
+
+/**
+ * @brief Appends a frame, overwriting the oldest block if the ring is full.
+ *
+ * @param rec Recorder.
+ * @param frame Frame.
+ */
+void inputrec_add(inputrec_t *rec, const inputrec_frame_t *frame);
+
+/**
+ * @brief Starts reading a recorder from its oldest block.
+ *
+ * @param reader Reader.
+ * @param rec Recorder.
+ */
+void inputrec_reader_init(inputrec_reader_t *reader, const inputrec_t *rec);
+
+/**
+ * @brief Starts reading blocks that are ordered oldest first, e.g. a dump
+ *        compiled into the firmware.
+ *
+ * @param reader Reader.
+ * @param blocks Blocks.
+ * @param count Number of blocks.
+ */
+void inputrec_reader_init_blocks(inputrec_reader_t *reader, const inputrec_block_t *blocks,
+                                 uint32_t count);
+
+/**
+ * @brief Reads the next frame.
+ *
+ * @param reader Reader.
+ * @param frame Frame, written.
+ * @return bool false at the end of the recording or on a corrupt block.
+ */
+bool inputrec_read(inputrec_reader_t *reader, inputrec_frame_t *frame);
+
+/**
+ * @brief Prints all blocks, oldest first: "IR <seq> <frames> <hex data>".
+ *
+ * @param rec Recorder. It must not be written during the dump.
+ * @param out Output, stdout for the UART.
+ */
+void inputrec_dump(const inputrec_t *rec, FILE *out);
+
+/**
+ * @brief Parses one line of inputrec_dump().
+ *
+ * @param line Line.
+ * @param block Block, written.
+ * @return bool false if the line is not a block.
+ */
+bool inputrec_parse_line(const char *line, inputrec_block_t *block);
+
+#endif /* INPUTREC_H */
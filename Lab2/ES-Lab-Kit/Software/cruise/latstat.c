@@ -0,0 +1,32 @@
+/**
+ * @file latstat.c
+ *
+ * @brief Min/avg/max accumulator for latency samples.
+ */
+
+#include "latstat.h"
+
+void latstat_init(latstat_t *s) {
+    s->count = 0;
+    s->min_us = UINT32_MAX;
+    s->max_us = 0;
+    s->sum_us = 0;
+}
+
+void latstat_add(latstat_t *s, uint32_t us) {
+    s->count++;
+    s->sum_us += us;
+    if (us < s->min_us) {
+        s->min_us = us;
+    }
+    if (us > s->max_us) {
+        s->max_us = us;
+    }
+}
+
+uint32_t latstat_avg(const latstat_t *s) {
+    if (s->count == 0) {
+        return 0;
+    }
+    return (uint32_t)(s->sum_us / s->count);
+}
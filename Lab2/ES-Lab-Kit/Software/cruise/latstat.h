@@ -0,0 +1,45 @@
+/**
+ * @file latstat.h
+ *
+ * @brief Min/avg/max accumulator for latency samples.
+ */
+
+#ifndef LATSTAT_H
+#define LATSTAT_H
+
+#include <stdint.h>
+
+/**
+ * @brief Accumulated latency samples in us.
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+} latstat_t;
+
+/**
+ * @brief Clears the accumulator.
+ *
+ * @param s Accumulator.
+ */
+void latstat_init(latstat_t *s);
+
+/**
+ * @brief Adds one sample.
+ *
+ * @param s Accumulator.
+ * @param us Latency in us.
+ */
+void latstat_add(latstat_t *s, uint32_t us);
+
+/**
+ * @brief Returns the average of all samples.
+ *
+ * @param s Accumulator.
+ * @return uint32_t Average in us, 0 if there are no samples.
+ */
+uint32_t latstat_avg(const latstat_t *s);
+
+#endif /* LATSTAT_H */
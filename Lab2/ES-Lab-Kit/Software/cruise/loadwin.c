@@ -0,0 +1,98 @@
+/**
+ * @file loadwin.c
+ *
+ * @brief Sliding-window CPU utilisation and deadline-miss accounting.
+ */
+
+#include <string.h>
+#include "loadwin.h"
+
+/**
+ * @brief Width of one slot per level in us (1 ms, 10 ms, 100 ms).
+ */
+static const uint32_t slot_width_us[LOADWIN_LEVELS] = {
+    LOADWIN_BASE_US,
+    LOADWIN_BASE_US * LOADWIN_SLOTS,
+    LOADWIN_BASE_US * LOADWIN_SLOTS * LOADWIN_SLOTS
+};
+
+/**
+ * @brief Pushes a completed slot into a level and cascades to the next
+ *        level every time the ring wraps around.
+ */
+static void push_slot(loadwin_t *lw, loadwin_level_t level, uint32_t busy, uint32_t misses) {
+    while (level < LOADWIN_LEVELS) {
+        loadwin_ring_t *r = &lw->ring[level];
+
+        r->busy_sum += busy - r->busy[r->head];
+        r->miss_sum += misses - r->misses[r->head];
+        r->busy[r->head] = busy;
+        r->misses[r->head] = misses;
+
+        if (++r->head < LOADWIN_SLOTS) {
+            return;
+        }
+        /* The ring now holds exactly one slot of the next level. */
+        r->head = 0;
+        busy = r->busy_sum;
+        misses = r->miss_sum;
+        level++;
+    }
+}
+
+void loadwin_init(loadwin_t *lw) {
+    memset(lw, 0, sizeof(*lw));
+}
+
+void loadwin_add(loadwin_t *lw, uint32_t busy_us, uint32_t elapsed_us) {
+    if (busy_us > elapsed_us) {
+        busy_us = elapsed_us;
+    }
+
+    while (elapsed_us > 0) {
+        uint32_t room = LOADWIN_BASE_US - lw->slot_elapsed_us;
+        uint32_t chunk = (elapsed_us < room) ? elapsed_us : room;
+        /* Share of the busy time that falls into this chunk. */
+        uint32_t busy = (chunk == elapsed_us) ? busy_us
+                      : (uint32_t)(((uint64_t)busy_us * chunk) / elapsed_us);
+
+        lw->slot_elapsed_us += chunk;
+        lw->slot_busy_us += busy;
+        elapsed_us -= chunk;
+        busy_us -= busy;
+
+        if (lw->slot_elapsed_us == LOADWIN_BASE_US) {
+            push_slot(lw, LOADWIN_10MS, lw->slot_busy_us, lw->slot_misses);
+            lw->slot_elapsed_us = 0;
+            lw->slot_busy_us = 0;
+            lw->slot_misses = 0;
+        }
+    }
+}
+
+void loadwin_add_miss(loadwin_t *lw) {
+    if (lw->slot_misses < UINT16_MAX) {
+        lw->slot_misses++;
+    }
+}
+
+uint16_t loadwin_utilisation(const loadwin_t *lw, loadwin_level_t level) {
+    uint32_t window_us = slot_width_us[level] * LOADWIN_SLOTS;
+
+    return (uint16_t)(((uint64_t)lw->ring[level].busy_sum * 1000u) / window_us);
+}
+
+uint32_t loadwin_misses(const loadwin_t *lw, loadwin_level_t level) {
+    return lw->ring[level].miss_sum;
+}
+
+bool loadwin_check(const loadwin_t *lw, const loadwin_limits_t *limits, bool overloaded) {
+    uint16_t util = loadwin_utilisation(lw, limits->level);
+    uint32_t misses = loadwin_misses(lw, limits->level);
+
+    if (!overloaded) {
+        return (util >= limits->enter_permille) ||
+               ((limits->miss_limit > 0) && (misses >= limits->miss_limit));
+    }
+    return !((util < limits->exit_permille) && (misses == 0));
+}
@@ -0,0 +1,129 @@
+/**
+ * @file loadwin.h
+ *
+ * @brief Sliding-window CPU utilisation and deadline-miss accounting.
+ *
+ * The windows are built as a cascade of rings: ten 1 ms slots form the
+ * 10 ms window, ten 10 ms slots the 100 ms window and ten 100 ms slots the
+ * 1 s window. Every ring keeps a running sum, so reading a window is O(1)
+ * and adding a sample costs one slot update per completed millisecond.
+ */
+
+#ifndef LOADWIN_H
+#define LOADWIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Number of slots in each window ring.
+ */
+#define LOADWIN_SLOTS       10u
+
+/**
+ * @brief Width of one slot of the shortest window in microseconds.
+ */
+#define LOADWIN_BASE_US     1000u
+
+/**
+ * @brief Enum used to select one of the sliding windows.
+ */
+typedef enum {
+    LOADWIN_10MS = 0,
+    LOADWIN_100MS,
+    LOADWIN_1S,
+    LOADWIN_LEVELS
+} loadwin_level_t;
+
+/**
+ * @brief Ring of completed slots of one window.
+ */
+typedef struct {
+    uint32_t busy[LOADWIN_SLOTS];   /* Busy time per slot in us */
+    uint32_t misses[LOADWIN_SLOTS]; /* Deadline misses per slot */
+    uint32_t busy_sum;              /* Sum of busy[] */
+    uint32_t miss_sum;              /* Sum of misses[] */
+    uint8_t  head;                  /* Next slot to overwrite */
+} loadwin_ring_t;
+
+/**
+ * @brief Sliding-window state.
+ */
+typedef struct {
+    loadwin_ring_t ring[LOADWIN_LEVELS];
+    uint32_t slot_elapsed_us;       /* Time accumulated in the open 1 ms slot */
+    uint32_t slot_busy_us;          /* Busy time accumulated in the open slot */
+    uint16_t slot_misses;           /* Misses reported in the open slot */
+} loadwin_t;
+
+/**
+ * @brief Overload thresholds.
+ *
+ * The system enters overload when the utilisation of the selected window
+ * reaches enter_permille or when the window holds at least miss_limit
+ * deadline misses. It leaves overload when the utilisation drops below
+ * exit_permille and the window holds no misses.
+ */
+typedef struct {
+    loadwin_level_t level;          /* Window used for both tests */
+    uint16_t enter_permille;        /* Utilisation that raises overload */
+    uint16_t exit_permille;         /* Utilisation that clears overload */
+    uint16_t miss_limit;            /* Misses that raise overload, 0 disables */
+} loadwin_limits_t;
+
+/**
+ * @brief Clears all windows.
+ *
+ * @param lw Window state.
+ */
+void loadwin_init(loadwin_t *lw);
+
+/**
+ * @brief Adds a measurement interval to the windows.
+ *
+ * The busy time is spread evenly over the interval, so intervals that span
+ * several slots (e.g. after a long idle period) are handled correctly.
+ *
+ * @param lw Window state.
+ * @param busy_us Busy (non-idle) time within the interval in us.
+ * @param elapsed_us Length of the interval in us.
+ */
+void loadwin_add(loadwin_t *lw, uint32_t busy_us, uint32_t elapsed_us);
+
+/**
+ * @brief Records one deadline miss in the currently open slot.
+ *
+ * @param lw Window state.
+ */
+void loadwin_add_miss(loadwin_t *lw);
+
+/**
+ * @brief Returns the utilisation of a window.
+ *
+ * @param lw Window state.
+ * @param level Window to read.
+ * @return uint16_t Utilisation in permille (0..1000).
+ */
+uint16_t loadwin_utilisation(const loadwin_t *lw, loadwin_level_t level);
+
+/**
+ * @brief Returns the number of deadline misses within a window.
+ *
+ * @param lw Window state.
+ * @param level Window to read.
+ * @return uint32_t Number of misses.
+ */
+uint32_t loadwin_misses(const loadwin_t *lw, loadwin_level_t level);
+
+/**
+ * @brief Evaluates the overload thresholds with hysteresis.
+ *
+ * @param lw Window state.
+ * @param limits Thresholds.
+ * @param overloaded Current overload state.
+ * @return true The system is (still) overloaded.
+ * @return false The system is (again) in normal operation.
+ */
+bool loadwin_check(const loadwin_t *lw, const loadwin_limits_t *limits, bool overloaded);
+
+#endif /* LOADWIN_H */
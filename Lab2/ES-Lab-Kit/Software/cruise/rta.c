@@ -0,0 +1,87 @@
+/**
+ * @file rta.c
+ *
+ * @brief Response-time analysis of periodic tasks under fixed-priority
+ *        preemptive scheduling.
+ */
+
+#include "rta.h"
+
+uint32_t rta_deadline(const rta_task_t *task) {
+    return (task->deadline_us != 0) ? task->deadline_us : task->period_us;
+}
+
+bool rta_response_times(const rta_task_t *tasks, size_t count, uint32_t *response_us) {
+    bool feasible = true;
+
+    for (size_t i = 0; i < count; i++) {
+        uint64_t deadline = rta_deadline(&tasks[i]);
+        uint64_t response = (uint64_t)tasks[i].wcet_us + tasks[i].blocking_us;
+        uint64_t previous = 0;
+
+        while ((response != previous) && (response <= deadline)) {
+            previous = response;
+            response = (uint64_t)tasks[i].wcet_us + tasks[i].blocking_us;
+            for (size_t j = 0; j < count; j++) {
+                if ((j != i) && (tasks[j].priority >= tasks[i].priority)) {
+                    response += (previous + tasks[j].period_us - 1) / tasks[j].period_us * tasks[j].wcet_us;
+                }
+            }
+        }
+        response_us[i] = (response > UINT32_MAX) ? UINT32_MAX : (uint32_t)response;
+        if (response > deadline) {
+            feasible = false;
+        }
+    }
+    return feasible;
+}
+
+double rta_utilization(const rta_task_t *tasks, size_t count) {
+    double utilization = 0.0;
+
+    for (size_t i = 0; i < count; i++) {
+        utilization += (double)tasks[i].wcet_us / tasks[i].period_us;
+    }
+    return utilization;
+}
+
+double rta_rm_bound(size_t count) {
+    double root = 1.5;
+
+    if (count == 0) {
+        return 1.0;
+    }
+    /* 2^(1/n) by Newton's method on root^n = 2, without libm */
+    for (int i = 0; i < 50; i++) {
+        double power = 1.0;
+
+        for (size_t k = 1; k < count; k++) {
+            power *= root;
+        }
+        root -= (power * root - 2.0) / (count * power);
+    }
+    return count * (root - 1.0);
+}
+
+/**
+ * @brief true if task a is more urgent than task b under the policy.
+ */
+static bool more_urgent(const rta_task_t *a, const rta_task_t *b, rta_policy_t policy) {
+    return (policy == RTA_RATE_MONOTONIC) ? (a->period_us < b->period_us)
+                                          : (rta_deadline(a) < rta_deadline(b));
+}
+
+void rta_assign_priorities(rta_task_t *tasks, size_t count, rta_policy_t policy, uint32_t lowest) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t less_urgent = 0;
+
+        /* Rank = number of less urgent tasks; ties keep the table order */
+        for (size_t j = 0; j < count; j++) {
+            if ((j != i) && (more_urgent(&tasks[i], &tasks[j], policy) ||
+                             (!more_urgent(&tasks[j], &tasks[i], policy) && (i < j)))) {
+                less_urgent++;
+            }
+        }
+        tasks[i].priority = lowest + less_urgent;
+    }
+}
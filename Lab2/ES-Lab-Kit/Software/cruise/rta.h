@@ -0,0 +1,102 @@
+/**
+ * @file rta.h
+ *
+ * @brief Response-time analysis of periodic tasks under fixed-priority
+ *        preemptive scheduling.
+ *
+ * The worst-case response time of task i is the smallest fixed point of
+ *
+ *     R = C(i) + B(i) + sum over higher-priority tasks j of ceil(R / T(j)) C(j)
+ *
+ * with the period T, the worst-case execution time C and the blocking B by
+ * lower-priority tasks (e.g. the longest critical section under priority
+ * inheritance). Tasks of the same priority are counted as interference of
+ * each other, as FreeRTOS time-slices them. The analysis is exact for
+ * independent tasks with deadlines up to their periods, released at the
+ * same time.
+ *
+ * Rate-monotonic (shortest period first) priorities are optimal for
+ * deadlines equal to the periods, deadline-monotonic (shortest deadline
+ * first) for deadlines up to the periods. The Liu & Layland bound
+ * n (2^(1/n) - 1) is only sufficient: a task set above it may still be
+ * schedulable.
+ */
+
+#ifndef RTA_H
+#define RTA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief One periodic task. Times in us.
+ */
+typedef struct {
+    const char *name;
+    uint32_t period_us;
+    uint32_t wcet_us;
+    uint32_t deadline_us;       /* Relative deadline, 0 for the period */
+    uint32_t blocking_us;       /* Longest blocking by lower-priority tasks */
+    uint32_t priority;          /* As in FreeRTOS: higher value, higher priority */
+} rta_task_t;
+
+/**
+ * @brief Priority assignment policies.
+ */
+typedef enum {
+    RTA_RATE_MONOTONIC,         /* Shortest period first */
+    RTA_DEADLINE_MONOTONIC,     /* Shortest deadline first */
+} rta_policy_t;
+
+/**
+ * @brief Returns the relative deadline of a task.
+ *
+ * @param task Task.
+ * @return uint32_t Deadline in us.
+ */
+uint32_t rta_deadline(const rta_task_t *task);
+
+/**
+ * @brief Computes the worst-case response times of all tasks.
+ *
+ * The iteration of a task stops as soon as its response time exceeds the
+ * deadline; the returned value is then the first one above the deadline.
+ *
+ * @param tasks Task set.
+ * @param count Number of tasks.
+ * @param response_us Response times in us, one per task.
+ * @return bool true if every task meets its deadline.
+ */
+bool rta_response_times(const rta_task_t *tasks, size_t count, uint32_t *response_us);
+
+/**
+ * @brief Returns the processor utilisation sum C / T.
+ *
+ * @param tasks Task set.
+ * @param count Number of tasks.
+ * @return double Utilisation, 1.0 = 100 %.
+ */
+double rta_utilization(const rta_task_t *tasks, size_t count);
+
+/**
+ * @brief Returns the Liu & Layland utilisation bound n (2^(1/n) - 1).
+ *
+ * @param count Number of tasks.
+ * @return double Bound, 1.0 for one task.
+ */
+double rta_rm_bound(size_t count);
+
+/**
+ * @brief Assigns the priorities lowest .. lowest + count - 1 by period or
+ *        deadline. Tasks with equal periods or deadlines keep the order of
+ *        the table, the first one gets the higher priority.
+ *
+ * @param tasks Task set, the priorities are overwritten.
+ * @param count Number of tasks.
+ * @param policy Rate or deadline monotonic.
+ * @param lowest Priority of the least urgent task.
+ */
+void rta_assign_priorities(rta_task_t *tasks, size_t count, rta_policy_t policy, uint32_t lowest);
+
+#endif /* RTA_H */
@@ -0,0 +1,48 @@
+/**
+ * @file seqlock.c
+ *
+ * @brief Single-writer sequence lock with two copies of the protected data.
+ */
+
+#include <string.h>
+#include "seqlock.h"
+
+/**
+ * @brief Address of copy 0 or 1.
+ */
+static inline unsigned char *copy_at(const void *copies, size_t size, uint32_t index) {
+    return (unsigned char *)copies + (index & 1u) * size;
+}
+
+void seqlock_init(seqlock_t *sl, void *copies, size_t size, const void *value) {
+    memcpy(copy_at(copies, size, 0), value, size);
+    memcpy(copy_at(copies, size, 1), value, size);
+    atomic_store_explicit(&sl->seq, 0, memory_order_release);
+}
+
+void seqlock_write(seqlock_t *sl, void *copies, size_t size, const void *value) {
+    uint32_t seq = atomic_load_explicit(&sl->seq, memory_order_relaxed);
+
+    /* Odd: readers switch to copy 1 while copy 0 is written. The store
+     * releases the previous write, the fence keeps the copy behind it. */
+    atomic_store_explicit(&sl->seq, seq + 1, memory_order_release);
+    atomic_thread_fence(memory_order_release);
+    memcpy(copy_at(copies, size, 0), value, size);
+
+    /* Even: readers switch to the new copy 0 while copy 1 is written. */
+    atomic_store_explicit(&sl->seq, seq + 2, memory_order_release);
+    atomic_thread_fence(memory_order_release);
+    memcpy(copy_at(copies, size, 1), value, size);
+}
+
+uint32_t seqlock_read(seqlock_t *sl, const void *copies, size_t size, void *value) {
+    uint32_t seq;
+
+    do {
+        seq = atomic_load_explicit(&sl->seq, memory_order_acquire);
+        memcpy(value, copy_at(copies, size, seq), size);
+        atomic_thread_fence(memory_order_acquire);
+    } while (atomic_load_explicit(&sl->seq, memory_order_relaxed) != seq);
+
+    return seq >> 1;
+}
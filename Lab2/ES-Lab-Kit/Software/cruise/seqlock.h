@@ -0,0 +1,65 @@
+/**
+ * @file seqlock.h
+ *
+ * @brief Single-writer sequence lock with two copies of the protected data.
+ *
+ * The writer updates the two copies one after the other and increments the
+ * sequence counter before each update. The counter tells a reader which copy
+ * is stable at the moment, so a reader never waits for a writer. It only
+ * retries if a complete half of a write happened during its copy, which
+ * requires the writer to run while the reader is preempted.
+ *
+ * This matters with fixed-priority scheduling: a classic seqlock reader that
+ * preempts the writer in the middle of an update would spin until the
+ * lower-priority writer runs again, i.e. forever on a single core.
+ *
+ * The number of completed writes is returned as generation, so readers can
+ * detect stale data.
+ */
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+/**
+ * @brief Sequence counter, twice the generation plus one during a write.
+ */
+typedef struct {
+    _Atomic uint32_t seq;
+} seqlock_t;
+
+/**
+ * @brief Initialises the lock and both copies.
+ *
+ * @param sl Lock.
+ * @param copies Array of two objects of the given size.
+ * @param size Size of one object in bytes.
+ * @param value Initial value.
+ */
+void seqlock_init(seqlock_t *sl, void *copies, size_t size, const void *value);
+
+/**
+ * @brief Publishes a new value. Only one task may write a lock.
+ *
+ * @param sl Lock.
+ * @param copies Array of two objects of the given size.
+ * @param size Size of one object in bytes.
+ * @param value New value.
+ */
+void seqlock_write(seqlock_t *sl, void *copies, size_t size, const void *value);
+
+/**
+ * @brief Copies a consistent value.
+ *
+ * @param sl Lock.
+ * @param copies Array of two objects of the given size.
+ * @param size Size of one object in bytes.
+ * @param value Filled with the value.
+ * @return uint32_t Generation of the value (number of writes before it).
+ */
+uint32_t seqlock_read(seqlock_t *sl, const void *copies, size_t size, void *value);
+
+#endif /* SEQLOCK_H */
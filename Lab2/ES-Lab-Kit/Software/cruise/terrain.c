@@ -0,0 +1,87 @@
+/**
+ * @file terrain.c
+ *
+ * @brief Track profile as a table of segments with O(1) position lookup.
+ */
+
+#include "terrain.h"
+
+const terrain_segment_t terrain_lab_track[] = {
+    {     0,   0, 0 },  /* even ground */
+    {  4000,   8, 0 },  /* uphill */
+    {  8000,  16, 0 },  /* steep uphill */
+    { 12000,   0, 0 },  /* even ground */
+    { 16000,  -8, 0 },  /* downhill */
+    { 20000, -16, 0 },  /* steep downhill */
+};
+
+const uint16_t terrain_lab_track_count = sizeof(terrain_lab_track) / sizeof(terrain_lab_track[0]);
+
+bool terrain_init(terrain_map_t *map, const terrain_segment_t *segments, uint16_t count,
+                  uint16_t length, uint16_t *index, uint16_t index_len) {
+    uint32_t min_segment = length;
+    uint32_t buckets;
+    uint8_t shift = 0;
+    uint16_t seg = 0;
+
+    if ((count == 0) || (segments[0].start != 0) || (segments[count - 1].start >= length)) {
+        return false;
+    }
+
+    /* Shortest segment, which also checks the order. */
+    for (uint16_t i = 0; i < count; i++) {
+        uint32_t end = (i + 1u < count) ? segments[i + 1].start : length;
+
+        if (end <= segments[i].start) {
+            return false;
+        }
+        if (end - segments[i].start < min_segment) {
+            min_segment = end - segments[i].start;
+        }
+    }
+
+    /* Widest power-of-two bucket that fits into the shortest segment. */
+    while ((2u << shift) <= min_segment) {
+        shift++;
+    }
+    buckets = ((uint32_t)length + (1u << shift) - 1u) >> shift;
+    if (buckets > index_len) {
+        return false;
+    }
+
+    for (uint32_t b = 0; b < buckets; b++) {
+        uint32_t position = b << shift;
+
+        while ((seg + 1u < count) && (segments[seg + 1].start <= position)) {
+            seg++;
+        }
+        index[b] = seg;
+    }
+
+    map->segments = segments;
+    map->count = count;
+    map->length = length;
+    map->index = index;
+    map->shift = shift;
+    return true;
+}
+
+uint16_t terrain_segment_at(const terrain_map_t *map, uint16_t position) {
+    uint16_t seg;
+
+    /* The lab's adjust_position() wraps only beyond the length, so the
+     * length itself is still on the last segment. */
+    if (position == map->length) {
+        return map->count - 1;
+    }
+    if (position > map->length) {
+        position %= map->length;
+    }
+
+    /* The bucket starts in segment seg and ends at most in the next one. */
+    seg = map->index[position >> map->shift];
+    if ((seg + 1u < map->count) && (position >= map->segments[seg + 1].start)) {
+        seg++;
+    }
+    return seg;
+}
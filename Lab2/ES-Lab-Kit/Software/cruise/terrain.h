@@ -0,0 +1,98 @@
+/**
+ * @file terrain.h
+ *
+ * @brief Track profile as a table of segments with O(1) position lookup.
+ *
+ * A track is a sorted table of segments, each with a start position, a
+ * grade and a constant wind. terrain_init() builds an index that maps every
+ * bucket of 2^shift position units to the segment the bucket starts in.
+ * The bucket width is chosen not larger than the shortest segment, so a
+ * bucket overlaps at most two segments and a lookup is one table read and
+ * one comparison, independent of the number of segments.
+ *
+ * The segment table is only read. It can be const data in flash, or a copy
+ * in RAM or PSRAM for tracks loaded at runtime.
+ */
+
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief One track segment. It ends where the next segment starts.
+ */
+typedef struct {
+    uint16_t start;     /* Start position in 0.1 m */
+    int8_t grade;       /* Retardation by the slope in 0.1 m/s^2, negative downhill */
+    int8_t wind;        /* Retardation by a constant head wind in 0.1 m/s^2 */
+} terrain_segment_t;
+
+/**
+ * @brief Track with its lookup index.
+ */
+typedef struct {
+    const terrain_segment_t *segments;
+    uint16_t count;         /* Number of segments */
+    uint16_t length;        /* Track length in 0.1 m, positions are 0..length */
+    const uint16_t *index;  /* First segment of every bucket */
+    uint8_t shift;          /* Bucket width is 2^shift */
+} terrain_map_t;
+
+/**
+ * @brief The 2400 m lab track: flat, uphill, steep uphill, flat, downhill,
+ *        steep downhill (4000 units each).
+ */
+extern const terrain_segment_t terrain_lab_track[];
+
+/**
+ * @brief Number of segments of terrain_lab_track.
+ */
+extern const uint16_t terrain_lab_track_count;
+
+/**
+ * @brief Number of index entries needed for a track.
+ *
+ * @param length Track length in 0.1 m.
+ * @param min_segment Length of the shortest segment in 0.1 m.
+ */
+#define TERRAIN_INDEX_LEN(length, min_segment)  (2u * (length) / (min_segment) + 1u)
+
+/**
+ * @brief Builds the lookup index of a track.
+ *
+ * @param map Map to initialise.
+ * @param segments Segments sorted by start, the first one starting at 0.
+ * @param count Number of segments.
+ * @param length Track length in 0.1 m.
+ * @param index Buffer for the index.
+ * @param index_len Number of entries in the buffer, see TERRAIN_INDEX_LEN().
+ * @return bool false if the table is not sorted or the buffer is too small.
+ */
+bool terrain_init(terrain_map_t *map, const terrain_segment_t *segments, uint16_t count,
+                  uint16_t length, uint16_t *index, uint16_t index_len);
+
+/**
+ * @brief Returns the number of the segment at a position.
+ *
+ * @param map Initialised map.
+ * @param position Position in 0.1 m, 0..length (length is the end of the
+ *        last segment) or wrapped to the track length beyond it.
+ * @return uint16_t Segment number.
+ */
+uint16_t terrain_segment_at(const terrain_map_t *map, uint16_t position);
+
+/**
+ * @brief Returns the segment at a position.
+ *
+ * @param map Initialised map.
+ * @param position Position in 0.1 m, 0..length (length is the end of the
+ *        last segment) or wrapped to the track length beyond it.
+ * @return const terrain_segment_t* Segment.
+ */
+static inline const terrain_segment_t *terrain_at(const terrain_map_t *map, uint16_t position) {
+    return &map->segments[terrain_segment_at(map, position)];
+}
+
+#endif /* TERRAIN_H */
@@ -0,0 +1,77 @@
+/**
+ * @file vehicle_model.c
+ *
+ * @brief Fixed-point vehicle dynamics with a configurable integration step.
+ */
+
+#include "vehicle_model.h"
+
+#define Q16_ONE     (1 << 16)
+#define US_PER_S    1000000
+
+void vehicle_model_init(vehicle_state_t *state, uint16_t position, uint16_t velocity) {
+    state->velocity = (int32_t)velocity << 16;
+    state->position = (uint32_t)position << 16;
+}
+
+/**
+ * @brief Acceleration in 0.1 m/s^2, Q16.
+ */
+static int32_t acceleration(const vehicle_model_t *model, const vehicle_state_t *state,
+                            uint16_t throttle, bool brake) {
+    const terrain_segment_t *segment;
+    int64_t drag;
+
+    if (brake) {
+        return -VEHICLE_MODEL_BRAKE * Q16_ONE;
+    }
+
+    /* v^2 / 10000 in Q16: (v * v) is Q32, so shift back by 16 first. */
+    drag = ((int64_t)state->velocity * state->velocity >> 16) / 10000;
+    if (state->velocity < 0) {
+        drag = -drag;
+    }
+
+    segment = terrain_at(model->track, vehicle_model_position(state));
+
+    return (int32_t)throttle * (Q16_ONE / 2) - (int32_t)drag - Q16_ONE
+           - ((int32_t)segment->grade + segment->wind) * Q16_ONE;
+}
+
+/**
+ * @brief Integrates one step of dt_us.
+ */
+static void substep(const vehicle_model_t *model, vehicle_state_t *state,
+                    uint16_t throttle, bool brake, uint32_t dt_us) {
+    const int64_t length = (int64_t)model->track->length << 16;
+    int32_t v0 = state->velocity;
+    int32_t v1 = v0 + (int32_t)((int64_t)acceleration(model, state, throttle, brake) * dt_us / US_PER_S);
+    int64_t position;
+
+    if (v1 < 0) {
+        v1 = 0;     /* Neither drag nor brakes drive the vehicle backwards. */
+    }
+
+    position = (int64_t)state->position + ((int64_t)v0 + v1) * dt_us / (2 * US_PER_S);
+    if (position >= length) {
+        position -= length;
+    } else if (position < 0) {
+        position += length;
+    }
+
+    state->velocity = v1;
+    state->position = (uint32_t)position;
+}
+
+void vehicle_model_step(const vehicle_model_t *model, vehicle_state_t *state,
+                        uint16_t throttle, bool brake, uint32_t interval_us) {
+    uint32_t steps = interval_us / model->substep_us;
+    uint32_t rest = interval_us % model->substep_us;
+
+    while (steps-- > 0) {
+        substep(model, state, throttle, brake, model->substep_us);
+    }
+    if (rest > 0) {
+        substep(model, state, throttle, brake, rest);
+    }
+}
@@ -0,0 +1,81 @@
+/**
+ * @file vehicle_model.h
+ *
+ * @brief Fixed-point vehicle dynamics with a configurable integration step.
+ *
+ * Same physics as adjust_position()/adjust_velocity() of the lab code:
+ *
+ *     a = throttle / 2 - (v^2 / 10000 + 1) - grade - wind      [0.1 m/s^2]
+ *
+ * with a constant 5 m/s^2 deceleration instead while braking, and the
+ * velocity limited to >= 0. The state is kept in Q16 and integrated with a
+ * fixed sub-step (e.g. 1 ms) in a loop, so one call per task period gives
+ * the accuracy of a much higher task rate. Position uses the trapezoidal
+ * rule, which is exact within a sub-step of constant acceleration. The
+ * drag term is computed in 64 bits and cannot overflow.
+ */
+
+#ifndef VEHICLE_MODEL_H
+#define VEHICLE_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "terrain.h"
+
+/**
+ * @brief Deceleration while braking in 0.1 m/s^2.
+ */
+#define VEHICLE_MODEL_BRAKE         50
+
+/**
+ * @brief Model parameters.
+ */
+typedef struct {
+    const terrain_map_t *track;     /* Grade and wind, also sets the track length */
+    uint32_t substep_us;            /* Integration step */
+} vehicle_model_t;
+
+/**
+ * @brief Vehicle state in Q16.
+ */
+typedef struct {
+    int32_t velocity;       /* 0.1 m/s, Q16 */
+    uint32_t position;      /* 0.1 m, Q16, 0..track length */
+} vehicle_state_t;
+
+/**
+ * @brief Sets the state.
+ *
+ * @param state State.
+ * @param position Position in 0.1 m.
+ * @param velocity Velocity in 0.1 m/s.
+ */
+void vehicle_model_init(vehicle_state_t *state, uint16_t position, uint16_t velocity);
+
+/**
+ * @brief Advances the state by an interval in sub-steps.
+ *
+ * @param model Model parameters.
+ * @param state State, updated.
+ * @param throttle Throttle 0..80, ignored while braking.
+ * @param brake Brake pedal pressed.
+ * @param interval_us Interval to simulate.
+ */
+void vehicle_model_step(const vehicle_model_t *model, vehicle_state_t *state,
+                        uint16_t throttle, bool brake, uint32_t interval_us);
+
+/**
+ * @brief Returns the velocity rounded to 0.1 m/s.
+ */
+static inline uint16_t vehicle_model_velocity(const vehicle_state_t *state) {
+    return (uint16_t)((state->velocity + (1 << 15)) >> 16);
+}
+
+/**
+ * @brief Returns the position truncated to 0.1 m.
+ */
+static inline uint16_t vehicle_model_position(const vehicle_state_t *state) {
+    return (uint16_t)(state->position >> 16);
+}
+
+#endif /* VEHICLE_MODEL_H */
@@ -0,0 +1,172 @@
+/**
+ * @file cruise_fleet.c
+ *
+ * @brief Batch simulation of many vehicles on different tracks and with
+ *        different driver profiles (see fleet.h).
+ *
+ *     cruise_fleet [-n vehicles] [-t seconds] [-d step_ms] [-o final.csv]
+ *
+ * Vehicle i drives on track i % 8 (the lab track with its grades scaled
+ * by 0, 0.5, 1 and 1.5, without and with a head wind) with driver profile
+ * i % 4:
+ * - 0: constant throttle,
+ * - 1: constant throttle, brakes for the last third of the run,
+ * - 2: throttle on and off every 10 s,
+ * - 3: throttle for the first half, then coasting.
+ * The throttle is 20..80 depending on i. The speed of the simulation goes
+ * to stderr.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "fleet.h"
+
+#define TRACKS              8u
+#define TRACK_LENGTH        24000u
+#define TRACK_MIN_SEGMENT   4000u
+#define SEGMENTS            6u
+
+static terrain_segment_t segments[TRACKS][SEGMENTS];
+static uint16_t track_index[TRACKS][TERRAIN_INDEX_LEN(TRACK_LENGTH, TRACK_MIN_SEGMENT)];
+static terrain_map_t tracks[TRACKS];
+
+static int init_tracks(void) {
+    for (unsigned t = 0; t < TRACKS; t++) {
+        for (unsigned s = 0; s < SEGMENTS; s++) {
+            segments[t][s].start = terrain_lab_track[s].start;
+            segments[t][s].grade = (int8_t)(terrain_lab_track[s].grade * (int)(t % 4u) / 2);
+            segments[t][s].wind = (int8_t)(t / 4u);
+        }
+        if (!terrain_init(&tracks[t], segments[t], SEGMENTS, TRACK_LENGTH, track_index[t],
+                          sizeof(track_index[t]) / sizeof(track_index[t][0]))) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Sets the inputs of all vehicles for the second that starts at t_s.
+ */
+static void drive(fleet_t *fleet, uint32_t t_s, uint32_t run_s) {
+    for (size_t i = 0; i < fleet->count; i++) {
+        float throttle = (float)(20u + (i * 7u) % 61u);
+        float brake = 0.0f;
+
+        switch (i % 4u) {
+        case 1:
+            if (3u * t_s >= 2u * run_s) {
+                throttle = 0.0f;
+                brake = 1.0f;
+            }
+            break;
+        case 2:
+            if ((t_s / 10u) % 2u != 0) {
+                throttle = 0.0f;
+            }
+            break;
+        case 3:
+            if (2u * t_s >= run_s) {
+                throttle = 0.0f;
+            }
+            break;
+        default:
+            break;
+        }
+        fleet->throttle[i] = throttle;
+        fleet->brake[i] = brake;
+    }
+}
+
+static void usage(const char *name) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -n n     vehicles (default 100000)\n"
+            "  -t s     simulated time in s (default 60)\n"
+            "  -d ms    step in ms (default 1)\n"
+            "  -o file  write the final state of every vehicle as CSV\n",
+            name);
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long count = 100000;
+    unsigned long run_s = 60;
+    double step_ms = 1.0;
+    const char *path = NULL;
+    fleet_t fleet;
+    struct timespec start, stop;
+    double elapsed, steps, sum = 0.0;
+    float max = 0.0f;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:t:d:o:h")) != -1) {
+        switch (opt) {
+        case 'n':
+            count = strtoul(optarg, NULL, 0);
+            break;
+        case 't':
+            run_s = strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            step_ms = strtod(optarg, NULL);
+            break;
+        case 'o':
+            path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if ((optind != argc) || (count == 0) || (run_s == 0) || (step_ms <= 0.0) || (step_ms > 1000.0)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if ((init_tracks() != 0) || (fleet_init(&fleet, count, &tracks[0]) != 0)) {
+        fprintf(stderr, "%s: out of memory or invalid track\n", argv[0]);
+        return 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        fleet_set_track(&fleet, i, &tracks[i % TRACKS]);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t t_s = 0; t_s < run_s; t_s++) {
+        drive(&fleet, t_s, (uint32_t)run_s);
+        for (double t_ms = 0.0; t_ms < 1000.0; t_ms += step_ms) {
+            fleet_step(&fleet, (float)step_ms);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    elapsed = (double)(stop.tv_sec - start.tv_sec) + (double)(stop.tv_nsec - start.tv_nsec) * 1e-9;
+    steps = (double)count * run_s * (1000.0 / step_ms);
+
+    for (size_t i = 0; i < count; i++) {
+        sum += fleet.velocity[i];
+        max = (fleet.velocity[i] > max) ? fleet.velocity[i] : max;
+    }
+    fprintf(stderr, "%lu vehicles x %.0f steps of %.3g ms in %.3f s: %.1f M vehicle-steps/s\n",
+            count, steps / count, step_ms, elapsed, steps / elapsed * 1e-6);
+    fprintf(stderr, "final velocity: mean %.1f, max %.1f (0.1 m/s)\n", sum / count, max);
+
+    if (path != NULL) {
+        FILE *out = fopen(path, "w");
+
+        if (out == NULL) {
+            perror(path);
+            return 1;
+        }
+        fprintf(out, "vehicle,track,profile,velocity,position\n");
+        for (size_t i = 0; i < count; i++) {
+            fprintf(out, "%zu,%zu,%zu,%.2f,%.1f\n", i, i % TRACKS, i % 4u,
+                    fleet.velocity[i], fleet.position[i]);
+        }
+        fclose(out);
+    }
+
+    fleet_free(&fleet);
+    return 0;
+}
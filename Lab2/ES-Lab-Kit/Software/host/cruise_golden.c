@@ -0,0 +1,348 @@
+/**
+ * @file cruise_golden.c
+ *
+ * @brief Golden-trajectory check of the cruise-control variants.
+ *
+ *     cruise_golden [options] [filter ...]
+ *
+ * Runs every scenario of the golden directory (scenario.txt, a script of
+ * sim.h) with the application logic and wiring of every project and
+ * compares the trace with the stored scenario.variant.csv (the CSV format
+ * of cruise_sim). Pedals, cruise state and throttle must match, velocity,
+ * target velocity and position within the tolerances. For each case the
+ * first divergence is printed; the exit code is 1 if any case fails.
+ *
+ * With -u the golden files are written from the current code instead.
+ * Review the change of the trajectories (e.g. with git diff) before
+ * committing them.
+ *
+ * A filter runs only the cases whose "scenario/variant" contains it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "sim.h"
+
+#ifndef GOLDEN_DIR
+#define GOLDEN_DIR          "golden"
+#endif
+#define TRACK_LENGTH        24000   /* The position wraps here */
+
+/**
+ * @brief Logic and wiring of the firmware projects. All run the tasks at
+ *        50/200/100 ms.
+ */
+typedef struct {
+    const char *name;
+    bool queues;            /* Queue wiring: Control gets no position */
+    bool pi;                /* CRUISE_USE_PI_CONTROLLER */
+    uint32_t substep_us;    /* CRUISE_USE_VEHICLE_MODEL, 0 = lab physics */
+} variant_t;
+
+static const variant_t variants[] = {
+    { "queues",      true,  false, 0 },     /* CruiseControlBasic, CdnA and CdnC: the same logic */
+    { "overload",    false, false, 0 },     /* CruiseControlOverload */
+    { "overload_pi", false, true,  1000 },  /* ... with both CMake options ON */
+};
+
+static const char *const scenarios[] = { "cruise_lap", "brake_cancel", "buttons", "vehicle_stall" };
+
+/**
+ * @brief Allowed deviation from the golden trace.
+ */
+typedef struct {
+    uint32_t throttle;
+    uint32_t velocity;      /* Also the target velocity, 0.1 m/s */
+    uint32_t position;      /* 0.1 m, across the wrap of the track */
+} tolerance_t;
+
+/**
+ * @brief Trace of one run.
+ */
+typedef struct {
+    sim_sample_t *samples;
+    size_t count;
+    size_t capacity;
+    bool failed;            /* Out of memory */
+} trace_t;
+
+static void collect(const sim_sample_t *sample, void *arg) {
+    trace_t *trace = arg;
+
+    if (trace->count == trace->capacity) {
+        size_t capacity = (trace->capacity == 0) ? 1024 : 2 * trace->capacity;
+        sim_sample_t *more = realloc(trace->samples, capacity * sizeof(*more));
+
+        if (more == NULL) {
+            trace->failed = true;
+            return;
+        }
+        trace->samples = more;
+        trace->capacity = capacity;
+    }
+    trace->samples[trace->count++] = *sample;
+}
+
+static void write_trace(FILE *out, const trace_t *trace) {
+    fprintf(out, "time_ms,gas,brake,cruise,cruise_active,throttle,velocity,target_velocity,position\n");
+    for (size_t i = 0; i < trace->count; i++) {
+        const sim_sample_t *s = &trace->samples[i];
+
+        fprintf(out, "%lu,%d,%d,%d,%d,%u,%u,%u,%u\n",
+                (unsigned long)s->time_ms, s->pedals.gas, s->pedals.brake, s->pedals.cruise,
+                s->cruise_active, s->throttle, s->velocity, s->target_velocity, s->position);
+    }
+}
+
+/**
+ * @brief Reads a trace written by write_trace().
+ */
+static int read_trace(const char *path, trace_t *trace) {
+    FILE *in = fopen(path, "r");
+    char line[128];
+
+    if (in == NULL) {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), in) != NULL) {
+        unsigned long time_ms;
+        unsigned gas, brake, cruise, active, throttle, velocity, target, position;
+
+        if (sscanf(line, "%lu,%u,%u,%u,%u,%u,%u,%u,%u", &time_ms, &gas, &brake, &cruise, &active,
+                   &throttle, &velocity, &target, &position) != 9) {
+            continue;   /* header */
+        }
+        collect(&(sim_sample_t){
+                    .time_ms = (uint32_t)time_ms,
+                    .pedals = { gas != 0, brake != 0, cruise != 0 },
+                    .throttle = (uint16_t)throttle,
+                    .velocity = (uint16_t)velocity,
+                    .position = (uint16_t)position,
+                    .target_velocity = (uint16_t)target,
+                    .cruise_active = active != 0,
+                }, trace);
+    }
+    fclose(in);
+    return trace->failed ? -1 : 0;
+}
+
+static uint32_t distance(uint32_t a, uint32_t b) {
+    return (a > b) ? a - b : b - a;
+}
+
+static uint32_t track_distance(uint32_t a, uint32_t b) {
+    uint32_t d = distance(a, b);
+
+    return (d > TRACK_LENGTH / 2) ? TRACK_LENGTH - d : d;
+}
+
+/**
+ * @brief Compares a trace with the golden one.
+ *
+ * @return const char* NULL if it matches, else the name of the first diverging
+ *         value; *at is the sample.
+ */
+static const char *compare(const trace_t *run, const trace_t *golden, const tolerance_t *tol,
+                           size_t *at) {
+    size_t count = (run->count < golden->count) ? run->count : golden->count;
+
+    for (size_t i = 0; i < count; i++) {
+        const sim_sample_t *r = &run->samples[i];
+        const sim_sample_t *g = &golden->samples[i];
+
+        *at = i;
+        if (r->time_ms != g->time_ms) {
+            return "time_ms";
+        }
+        if ((r->pedals.gas != g->pedals.gas) || (r->pedals.brake != g->pedals.brake) ||
+            (r->pedals.cruise != g->pedals.cruise)) {
+            return "pedals";
+        }
+        if (r->cruise_active != g->cruise_active) {
+            return "cruise_active";
+        }
+        if (distance(r->throttle, g->throttle) > tol->throttle) {
+            return "throttle";
+        }
+        if (distance(r->velocity, g->velocity) > tol->velocity) {
+            return "velocity";
+        }
+        if (distance(r->target_velocity, g->target_velocity) > tol->velocity) {
+            return "target_velocity";
+        }
+        if (track_distance(r->position, g->position) > tol->position) {
+            return "position";
+        }
+    }
+    *at = count;
+    return (run->count != golden->count) ? "length" : NULL;
+}
+
+static void print_sample(const char *label, const trace_t *trace, size_t i) {
+    if (i >= trace->count) {
+        printf("    %-7s (end of trace)\n", label);
+        return;
+    }
+    const sim_sample_t *s = &trace->samples[i];
+
+    printf("    %-7s t=%lu gas=%d brake=%d cruise=%d active=%d throttle=%u velocity=%u target=%u position=%u\n",
+           label, (unsigned long)s->time_ms, s->pedals.gas, s->pedals.brake, s->pedals.cruise,
+           s->cruise_active, s->throttle, s->velocity, s->target_velocity, s->position);
+}
+
+/**
+ * @brief Runs one case.
+ *
+ * @return int 0 if it passed or was written, 1 if it diverged, -1 on errors.
+ */
+static int run_case(const char *dir, const char *scenario, const variant_t *variant,
+                    const tolerance_t *tol, bool update) {
+    char path[512];
+    sim_script_t script;
+    sim_config_t config;
+    trace_t run = { 0 }, golden = { 0 };
+    const char *diverged;
+    size_t at;
+    int result = -1;
+
+    snprintf(path, sizeof(path), "%s/%s.txt", dir, scenario);
+    if (sim_script_load(path, &script) != 0) {
+        return -1;
+    }
+
+    sim_config_lab(&config);
+    config.queues = variant->queues;
+    config.control.pi = variant->pi ? &cruise_pi_default : NULL;
+    config.vehicle.substep_us = variant->substep_us;
+    sim_run(&config, &script, collect, &run);
+    sim_script_free(&script);
+    if (run.failed) {
+        fprintf(stderr, "out of memory\n");
+        goto out;
+    }
+
+    snprintf(path, sizeof(path), "%s/%s.%s.csv", dir, scenario, variant->name);
+    if (update) {
+        FILE *out = fopen(path, "w");
+
+        if (out == NULL) {
+            perror(path);
+            goto out;
+        }
+        write_trace(out, &run);
+        fclose(out);
+        printf("wrote %s/%s (%zu samples)\n", scenario, variant->name, run.count);
+        result = 0;
+        goto out;
+    }
+
+    if (read_trace(path, &golden) != 0) {
+        goto out;
+    }
+    diverged = compare(&run, &golden, tol, &at);
+    if (diverged == NULL) {
+        printf("ok    %s/%s (%zu samples)\n", scenario, variant->name, run.count);
+        result = 0;
+    } else {
+        printf("FAIL  %s/%s: %s diverges at sample %zu of %zu\n", scenario, variant->name,
+               diverged, at, golden.count);
+        if (at > 0) {
+            print_sample("last ok", &golden, at - 1);
+        }
+        print_sample("golden", &golden, at);
+        print_sample("now", &run, at);
+        result = 1;
+    }
+
+out:
+    free(run.samples);
+    free(golden.samples);
+    return result;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr,
+            "usage: %s [options] [filter ...]\n"
+            "  -d dir   golden directory (default %s)\n"
+            "  -u       write the golden files from the current code\n"
+            "  -t n     throttle tolerance (default 0)\n"
+            "  -v n     velocity tolerance in 0.1 m/s (default 2)\n"
+            "  -x n     position tolerance in 0.1 m (default 20)\n",
+            name, GOLDEN_DIR);
+}
+
+static bool selected(const char *scenario, const variant_t *variant, char *filters[], int count) {
+    char name[128];
+
+    if (count == 0) {
+        return true;
+    }
+    snprintf(name, sizeof(name), "%s/%s", scenario, variant->name);
+    for (int i = 0; i < count; i++) {
+        if (strstr(name, filters[i]) != NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char *argv[]) {
+    const char *dir = GOLDEN_DIR;
+    tolerance_t tol = { .throttle = 0, .velocity = 2, .position = 20 };
+    bool update = false;
+    unsigned cases = 0, failed = 0, errors = 0;
+    struct timespec start, stop;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:ut:v:x:h")) != -1) {
+        switch (opt) {
+        case 'd':
+            dir = optarg;
+            break;
+        case 'u':
+            update = true;
+            break;
+        case 't':
+            tol.throttle = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'v':
+            tol.velocity = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'x':
+            tol.position = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++) {
+        for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++) {
+            if (!selected(scenarios[s], &variants[v], &argv[optind], argc - optind)) {
+                continue;
+            }
+            switch (run_case(dir, scenarios[s], &variants[v], &tol, update)) {
+            case 0:
+                break;
+            case 1:
+                failed++;
+                break;
+            default:
+                errors++;
+                break;
+            }
+            cases++;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    printf("%u cases, %u failed, %u errors in %.1f ms\n", cases, failed, errors,
+           (double)(stop.tv_sec - start.tv_sec) * 1e3 + (double)(stop.tv_nsec - start.tv_nsec) * 1e-6);
+    return ((failed + errors) != 0) ? 1 : 0;
+}
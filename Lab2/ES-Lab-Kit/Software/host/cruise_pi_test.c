@@ -0,0 +1,169 @@
+/**
+ * @file cruise_pi_test.c
+ *
+ * @brief Host test of the PI cruise controller on every segment of the lab
+ *        track.
+ *
+ *     cruise_pi_test [-v]
+ *
+ * The vehicle (lab physics, 100 ms) drives laps of the lab track with
+ * cruise_pi_default at 200 ms, for targets from 25 to 50 m/s. The first lap
+ * brings the controller into steady state. On the following laps every
+ * segment entry is a disturbance (change of grade) and the test measures,
+ * per segment:
+ * - overshoot: the largest deviation from the target within the segment,
+ * - settling time: from the segment entry until the velocity stays within
+ *   SETTLE_BAND of the target for the rest of the segment.
+ *
+ * Both must stay within the limits of the segment. -v prints the worst
+ * values per segment. Exit code 1 if a limit is exceeded.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cruise_core.h"
+
+#define TRACK_LENGTH        24000   /* 0.1 m */
+#define SEGMENT_LENGTH      4000    /* 0.1 m, one gain table entry */
+#define SEGMENTS            (TRACK_LENGTH / SEGMENT_LENGTH)
+#define VEHICLE_PERIOD_MS   100
+#define CONTROL_PERIOD_MS   200
+#define SETTLE_BAND         15      /* 0.1 m/s */
+#define LAPS                4
+
+/**
+ * @brief Limits per segment, a little above the values of cruise_pi_default.
+ *
+ * The physics truncates accelerations below 1 m/s^2 per 100 ms, so the
+ * velocity stays up to about 1.2 m/s off the target, hence the settling
+ * band of 1.5 m/s. The controller has no brake: when the vehicle comes too
+ * fast from a slope onto flat ground (segments 0 and 3), the throttle goes
+ * to 0 within the rate limit and the vehicle then only slows down by its
+ * drag, about 0.1 m/s per 100 ms.
+ */
+typedef struct {
+    int overshoot;          /* 0.1 m/s */
+    uint32_t settling_ms;
+} limits_t;
+
+static const limits_t limits[SEGMENTS] = {
+    { 20, 6000 },   /* flat, after steep downhill: 1.6 m/s, 4.6 s */
+    { 15, 1000 },   /* uphill: 1.2 m/s, within the band */
+    { 10, 1000 },   /* steep uphill: 0.6 m/s, within the band */
+    { 25, 6000 },   /* flat, after steep uphill: 2.2 m/s, 4.8 s */
+    { 16, 1000 },   /* downhill: 1.3 m/s, within the band */
+    { 16, 1000 },   /* steep downhill: 1.3 m/s, within the band */
+};
+
+/**
+ * @brief Worst values seen per segment.
+ */
+typedef struct {
+    int overshoot;
+    uint32_t settling_ms;
+    uint16_t overshoot_target;
+    uint16_t settling_target;
+} result_t;
+
+static terrain_map_t track;
+static uint16_t track_index[TERRAIN_INDEX_LEN(TRACK_LENGTH, SEGMENT_LENGTH)];
+
+/**
+ * @brief Drives LAPS laps at one target and updates the worst values.
+ */
+static void run(uint16_t target, result_t results[SEGMENTS]) {
+    const cruise_vehicle_config_t vehicle_config = { .track = &track, .substep_us = 0 };
+    cruise_vehicle_t vehicle;
+    cruise_pi_state_t pi;
+    uint16_t throttle = 0;
+    unsigned laps = 0;
+    unsigned segment = 0;
+    uint32_t t_ms = 0;
+    uint32_t entry_ms = 0;
+    uint32_t last_out_ms = 0;   /* Last time outside the band in this segment */
+    int overshoot = 0;
+
+    cruise_vehicle_init(&vehicle, 0, target);
+    cruise_pi_reset(&pi, throttle);
+
+    while (laps < LAPS) {
+        unsigned now_segment;
+        int error;
+
+        if (t_ms % CONTROL_PERIOD_MS == 0) {
+            throttle = cruise_pi_step(&cruise_pi_default, &pi, vehicle.position / SEGMENT_LENGTH,
+                                      target, vehicle.velocity);
+        }
+        cruise_vehicle_step(&vehicle_config, &vehicle, throttle, false, VEHICLE_PERIOD_MS);
+        t_ms += VEHICLE_PERIOD_MS;
+
+        now_segment = terrain_segment_at(&track, vehicle.position);
+        if (now_segment != segment) {
+            /* Segment done; the first lap only settles the controller */
+            if (laps > 0) {
+                result_t *r = &results[segment];
+                uint32_t settling_ms = last_out_ms - entry_ms;
+
+                if (overshoot > r->overshoot) {
+                    r->overshoot = overshoot;
+                    r->overshoot_target = target;
+                }
+                if (settling_ms > r->settling_ms) {
+                    r->settling_ms = settling_ms;
+                    r->settling_target = target;
+                }
+            }
+            if (now_segment < segment) {
+                laps++;
+            }
+            segment = now_segment;
+            entry_ms = t_ms;
+            last_out_ms = t_ms;
+            overshoot = 0;
+        }
+
+        error = abs((int)vehicle.velocity - (int)target);
+        if (error > overshoot) {
+            overshoot = error;
+        }
+        if (error > SETTLE_BAND) {
+            last_out_ms = t_ms;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    bool verbose = (argc > 1) && (strcmp(argv[1], "-v") == 0);
+    result_t results[SEGMENTS] = {0};
+    int failures = 0;
+
+    terrain_init(&track, terrain_lab_track, terrain_lab_track_count, TRACK_LENGTH,
+                 track_index, sizeof(track_index) / sizeof(track_index[0]));
+
+    for (uint16_t target = 250; target <= 500; target += 10) {
+        run(target, results);
+    }
+
+    for (unsigned s = 0; s < SEGMENTS; s++) {
+        const result_t *r = &results[s];
+        bool ok = (r->overshoot <= limits[s].overshoot) && (r->settling_ms <= limits[s].settling_ms);
+
+        if (verbose || !ok) {
+            printf("Segment %u: overshoot %d (limit %d) at target %u, settling %lu ms (limit %lu) at target %u%s\n",
+                   s, r->overshoot, limits[s].overshoot, r->overshoot_target,
+                   (unsigned long)r->settling_ms, (unsigned long)limits[s].settling_ms,
+                   r->settling_target, ok ? "" : "  FAILED");
+        }
+        if (!ok) {
+            failures++;
+        }
+    }
+
+    if (failures > 0) {
+        printf("cruise_pi_test: %d segments out of limits\n", failures);
+        return 1;
+    }
+    printf("cruise_pi_test: passed\n");
+    return 0;
+}
@@ -0,0 +1,238 @@
+/**
+ * @file cruise_sim.c
+ *
+ * @brief Command-line driver of the cruise-control simulation.
+ *
+ * Runs an input script (see sim.h) through the application logic of
+ * cruise_core.h and writes one CSV line per Vehicle job:
+ *
+ *     cruise_sim [options] script.txt > trace.csv
+ *
+ * The run time and the simulation speed go to stderr.
+ *
+ * With -r the input is a recording dumped by the firmware or by -R (see
+ * inputrec.h) instead of a script. -R and -c record the Button samples of
+ * the run, as dump or as C header with the blocks for the replay mode of
+ * the firmware.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "sim.h"
+
+#define RECORD_BLOCKS   4096u   /* 1 MB, like the PSRAM buffer of the firmware */
+
+/**
+ * @brief CSV output state.
+ */
+typedef struct {
+    FILE *out;
+    uint32_t every;     /* Write every n-th sample */
+    uint32_t count;
+} csv_t;
+
+static void usage(const char *name) {
+    fprintf(stderr,
+            "usage: %s [options] script.txt|recording.txt|-\n"
+            "  -o file  write the CSV trace to file instead of stdout\n"
+            "  -e n     write only every n-th Vehicle job (default 1)\n"
+            "  -q       no trace, only the summary\n"
+            "  -r       the input is a recording (\"IR\" lines) instead of a script\n"
+            "  -R file  record the inputs and write the dump to file\n"
+            "  -c file  record the inputs and write them as C header for the replay\n"
+            "  -p       PI controller (cruise_pi_default) instead of the step controller\n"
+            "  -m us    sub-stepped vehicle model with step us instead of the lab physics\n"
+            "  -g n     throttle step of the gas pedal (default 2)\n"
+            "  -b n     error band of the step controller in 0.1 m/s (default 40)\n"
+            "  -B ms    Button period (default 50)\n"
+            "  -C ms    Control period (default 200)\n"
+            "  -V ms    Vehicle period (default 100)\n",
+            name);
+}
+
+static void write_sample(const sim_sample_t *s, void *arg) {
+    csv_t *csv = arg;
+
+    if (++csv->count < csv->every) {
+        return;
+    }
+    csv->count = 0;
+    fprintf(csv->out, "%lu,%d,%d,%d,%d,%u,%u,%u,%u\n",
+            (unsigned long)s->time_ms, s->pedals.gas, s->pedals.brake, s->pedals.cruise,
+            s->cruise_active, s->throttle, s->velocity, s->target_velocity, s->position);
+}
+
+/**
+ * @brief Writes a recording as C header with the blocks in xReplayBlocks[].
+ */
+static int write_header(const char *path, const inputrec_t *rec) {
+    inputrec_reader_t reader;
+    FILE *out = fopen(path, "w");
+
+    if (out == NULL) {
+        perror(path);
+        return -1;
+    }
+    inputrec_reader_init(&reader, rec);
+    fprintf(out, "/* Generated by cruise_sim -c: %lu frames. */\n\n", (unsigned long)rec->frames);
+    fprintf(out, "static const inputrec_block_t xReplayBlocks[] = {\n");
+    for (uint32_t n = 0; (reader.count > 0) && (n <= reader.remaining); n++) {
+        const inputrec_block_t *block = &rec->blocks[(reader.block + n) % rec->count];
+
+        fprintf(out, "    { %luu, %uu, %uu, {", (unsigned long)block->seq, block->used, block->frames);
+        for (uint16_t b = 0; b < block->used; b++) {
+            fprintf(out, "%s0x%02x,", (b % 16u == 0) ? "\n        " : " ", block->data[b]);
+        }
+        fprintf(out, "\n    } },\n");
+    }
+    fprintf(out, "};\n");
+    return fclose(out);
+}
+
+/**
+ * @brief Parses a positive number option.
+ */
+static uint32_t positive(const char *name, int opt, const char *arg) {
+    char *end;
+    unsigned long value = strtoul(arg, &end, 0);
+
+    if ((*end != '\0') || (value == 0) || (value > 0xFFFFu)) {
+        fprintf(stderr, "%s: -%c expects a number 1..65535\n", name, opt);
+        exit(2);
+    }
+    return (uint32_t)value;
+}
+
+int main(int argc, char *argv[]) {
+    sim_config_t config;
+    sim_script_t script;
+    sim_result_t result;
+    csv_t csv = { .out = stdout, .every = 1, .count = 0 };
+    bool quiet = false;
+    bool recording = false;
+    const char *dump_path = NULL;
+    const char *header_path = NULL;
+    inputrec_t record;
+    struct timespec start, stop;
+    double elapsed;
+    int opt;
+
+    sim_config_lab(&config);
+
+    while ((opt = getopt(argc, argv, "o:e:qrR:c:pm:g:b:B:C:V:h")) != -1) {
+        switch (opt) {
+        case 'o':
+            csv.out = fopen(optarg, "w");
+            if (csv.out == NULL) {
+                perror(optarg);
+                return 1;
+            }
+            break;
+        case 'e':
+            csv.every = positive(argv[0], opt, optarg);
+            break;
+        case 'q':
+            quiet = true;
+            break;
+        case 'r':
+            recording = true;
+            break;
+        case 'R':
+            dump_path = optarg;
+            break;
+        case 'c':
+            header_path = optarg;
+            break;
+        case 'p':
+            config.control.pi = &cruise_pi_default;
+            break;
+        case 'm':
+            config.vehicle.substep_us = positive(argv[0], opt, optarg);
+            break;
+        case 'g':
+            config.control.gas_step = (uint16_t)positive(argv[0], opt, optarg);
+            break;
+        case 'b':
+            config.control.error_band = (uint16_t)positive(argv[0], opt, optarg);
+            break;
+        case 'B':
+            config.button_period_ms = positive(argv[0], opt, optarg);
+            break;
+        case 'C':
+            config.control_period_ms = positive(argv[0], opt, optarg);
+            break;
+        case 'V':
+            config.vehicle_period_ms = positive(argv[0], opt, optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 2;
+    }
+    if ((recording ? sim_script_load_recording(argv[optind], config.button_period_ms, &script)
+                   : sim_script_load(argv[optind], &script)) != 0) {
+        return 1;
+    }
+    if ((dump_path != NULL) || (header_path != NULL)) {
+        size_t size = RECORD_BLOCKS * sizeof(inputrec_block_t);
+        void *buffer = malloc(size);
+
+        if ((buffer == NULL) || !inputrec_init(&record, buffer, size)) {
+            fprintf(stderr, "%s: out of memory\n", argv[0]);
+            return 1;
+        }
+        config.record = &record;
+    }
+
+    if (!quiet) {
+        fprintf(csv.out, "time_ms,gas,brake,cruise,cruise_active,throttle,velocity,target_velocity,position\n");
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    result = sim_run(&config, &script, quiet ? NULL : write_sample, &csv);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    elapsed = (double)(stop.tv_sec - start.tv_sec) + (double)(stop.tv_nsec - start.tv_nsec) * 1e-9;
+    if (elapsed <= 0.0) {
+        elapsed = 1e-9;     /* below the clock resolution */
+    }
+
+    fprintf(stderr, "simulated %.1f s: %llu jobs in %.3f ms (%.1f M ticks/s, %.0fx real time)\n",
+            script.end_ms / 1000.0, (unsigned long long)result.jobs, elapsed * 1e3,
+            script.end_ms / elapsed * 1e-6, script.end_ms / 1000.0 / elapsed);
+
+    if (config.record != NULL) {
+        FILE *out;
+
+        if (record.seq > record.count) {
+            fprintf(stderr, "warning: recording buffer full, the start of the run is lost\n");
+        }
+        if (dump_path != NULL) {
+            out = (strcmp(dump_path, "-") == 0) ? stdout : fopen(dump_path, "w");
+            if (out == NULL) {
+                perror(dump_path);
+                return 1;
+            }
+            inputrec_dump(&record, out);
+            if (out != stdout) {
+                fclose(out);
+            }
+        }
+        if ((header_path != NULL) && (write_header(header_path, &record) != 0)) {
+            return 1;
+        }
+        free(record.blocks);
+    }
+
+    sim_script_free(&script);
+    if (csv.out != stdout) {
+        fclose(csv.out);
+    }
+    return 0;
+}
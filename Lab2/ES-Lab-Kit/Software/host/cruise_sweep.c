@@ -0,0 +1,520 @@
+/**
+ * @file cruise_sweep.c
+ *
+ * @brief Parallel parameter sweep of the cruise-control application.
+ *
+ * Simulates every combination of gas step, error band and task periods
+ * with an input script (see sim.h) on a pool of threads and scores the
+ * cruise phase, from the engagement of cruise control to the next pedal:
+ *
+ * - settling: the phase is cut into disturbances, the engagement (a step
+ *   of the target) and every entry into a new terrain segment. For each
+ *   one, the settling time is the time until the velocity stays within
+ *   +-tolerance of the target until the next disturbance. The score is
+ *   the longest of them; a point with a disturbance that does not settle
+ *   before the next one has not settled. The disturbance that is cut off
+ *   by the end of the phase only counts if it has settled,
+ * - overshoot: maximum velocity above the target,
+ * - effort: sum of all throttle changes, i.e. how busy the actuator is,
+ * - feasible: all tasks meet their deadlines by response-time analysis
+ *   with the given execution times (rate-monotonic priorities).
+ *
+ * Each settled and feasible point gets the Pareto rank 1 + number of such
+ * points that are at least as good in all three objectives and better in
+ * one. The Pareto
+ * front (rank 1) is written as CSV, sorted by settling time:
+ *
+ *     cruise_sweep [options] script.txt > pareto.csv
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "rta.h"
+#include "sim.h"
+
+/**
+ * @brief Swept parameters.
+ */
+typedef enum {
+    PARAM_GAS_STEP,
+    PARAM_ERROR_BAND,
+    PARAM_BUTTON_MS,
+    PARAM_CONTROL_MS,
+    PARAM_VEHICLE_MS,
+    PARAMS
+} param_t;
+
+/**
+ * @brief Tasks of the schedulability test, Display has a fixed period.
+ */
+typedef enum {
+    TASK_BUTTON,
+    TASK_CONTROL,
+    TASK_VEHICLE,
+    TASK_DISPLAY,
+    TASKS
+} task_t;
+
+#define DISPLAY_PERIOD_MS   500u
+
+/**
+ * @brief Values of one parameter: first, first + step, ... <= last.
+ */
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+    uint32_t step;
+} range_t;
+
+/**
+ * @brief One point of the sweep and its score.
+ */
+typedef struct {
+    uint32_t param[PARAMS];
+    bool settled;           /* Every disturbance settled */
+    bool feasible;
+    uint32_t settling_ms;   /* Longest settling time of a disturbance */
+    uint32_t settling_avg_ms;
+    uint32_t disturbances;  /* Disturbances scored */
+    uint32_t overshoot;     /* 0.1 m/s */
+    uint32_t effort;        /* Sum of |throttle change| */
+    double rms_error;       /* 0.1 m/s */
+    double utilization;
+    uint32_t rank;          /* Pareto rank, 0 if not settled or not feasible */
+} point_t;
+
+/**
+ * @brief Work shared by the threads.
+ */
+typedef struct {
+    const sim_config_t *base;
+    const sim_script_t *script;
+    const uint32_t *wcet_us;
+    uint16_t tolerance;
+    point_t *points;
+    size_t count;
+    atomic_size_t next;     /* Next point to simulate */
+} sweep_t;
+
+/**
+ * @brief Score accumulated over the samples of one run.
+ */
+typedef struct {
+    uint16_t tolerance;
+    uint32_t vehicle_ms;
+    const terrain_map_t *track;
+    bool engaged;
+    bool done;              /* A pedal ended the cruise phase */
+    uint16_t segment;       /* Terrain segment of the last sample */
+    uint32_t disturbance_ms;    /* Start of the current disturbance */
+    uint32_t last_out_ms;   /* End of the last sample out of tolerance */
+    uint32_t last_ms;       /* End of the last sample of the phase */
+    uint32_t disturbances;
+    uint32_t unsettled;
+    uint32_t settling_max_ms;
+    uint64_t settling_sum_ms;
+    uint16_t prev_throttle;
+    int32_t overshoot;
+    uint32_t effort;
+    double sum_sq;
+    uint32_t samples;
+} score_t;
+
+/**
+ * @brief Scores the current disturbance, which ends at end_ms.
+ *
+ * @param last true if the end of the phase cuts it off: it is only scored
+ *        if it has settled.
+ */
+static void end_disturbance(score_t *score, uint32_t end_ms, bool last) {
+    bool settled = score->last_out_ms < end_ms;
+    uint32_t settling_ms = score->last_out_ms - score->disturbance_ms;
+
+    if (last && !settled) {
+        return;
+    }
+    if (!settled) {
+        score->unsettled++;
+    }
+    if (settling_ms > score->settling_max_ms) {
+        score->settling_max_ms = settling_ms;
+    }
+    score->settling_sum_ms += settling_ms;
+    score->disturbances++;
+}
+
+static void start_disturbance(score_t *score, uint32_t time_ms) {
+    score->disturbance_ms = time_ms;
+    score->last_out_ms = time_ms;
+}
+
+static void score_sample(const sim_sample_t *s, void *arg) {
+    score_t *score = arg;
+    uint16_t segment;
+    int32_t error;
+
+    if (score->done) {
+        return;
+    }
+    segment = terrain_segment_at(score->track, s->position);
+    if (!score->engaged) {
+        if (!s->cruise_active) {
+            return;
+        }
+        score->engaged = true;
+        score->segment = segment;
+        start_disturbance(score, s->time_ms);
+        score->prev_throttle = s->throttle;
+    } else if (s->pedals.gas || s->pedals.brake) {
+        end_disturbance(score, score->last_ms, true);
+        score->done = true;
+        return;
+    } else if (segment != score->segment) {
+        end_disturbance(score, s->time_ms, false);
+        score->segment = segment;
+        start_disturbance(score, s->time_ms);
+    }
+
+    error = (int32_t)s->velocity - s->target_velocity;
+    if (!s->cruise_active || (abs(error) > score->tolerance)) {
+        score->last_out_ms = s->time_ms + score->vehicle_ms;
+    }
+    if (error > score->overshoot) {
+        score->overshoot = error;
+    }
+    score->effort += (uint32_t)abs((int32_t)s->throttle - score->prev_throttle);
+    score->prev_throttle = s->throttle;
+    score->sum_sq += (double)error * error;
+    score->samples++;
+    score->last_ms = s->time_ms + score->vehicle_ms;
+}
+
+/**
+ * @brief Response-time analysis with rate-monotonic priorities and
+ *        deadlines equal to the periods (rta.h).
+ *
+ * @return bool true if every task meets its deadline.
+ */
+static bool schedulable(const uint32_t period_ms[TASKS], const uint32_t wcet_us[TASKS],
+                        double *utilization) {
+    rta_task_t tasks[TASKS];
+    uint32_t response_us[TASKS];
+
+    for (int i = 0; i < TASKS; i++) {
+        tasks[i] = (rta_task_t){ .period_us = period_ms[i] * 1000u, .wcet_us = wcet_us[i] };
+    }
+    /* Higher priority: shorter period, ties in the order of the lab */
+    rta_assign_priorities(tasks, TASKS, RTA_RATE_MONOTONIC, 1);
+
+    *utilization = rta_utilization(tasks, TASKS);
+    return rta_response_times(tasks, TASKS, response_us);
+}
+
+static void evaluate(const sweep_t *sweep, point_t *point) {
+    sim_config_t config = *sweep->base;
+    score_t score = {
+        .tolerance = sweep->tolerance,
+        .vehicle_ms = point->param[PARAM_VEHICLE_MS],
+        .track = sweep->base->vehicle.track,
+    };
+    uint32_t period_ms[TASKS];
+
+    config.control.gas_step = (uint16_t)point->param[PARAM_GAS_STEP];
+    config.control.error_band = (uint16_t)point->param[PARAM_ERROR_BAND];
+    config.button_period_ms = point->param[PARAM_BUTTON_MS];
+    config.control_period_ms = point->param[PARAM_CONTROL_MS];
+    config.vehicle_period_ms = point->param[PARAM_VEHICLE_MS];
+
+    sim_run(&config, sweep->script, score_sample, &score);
+    if (score.engaged && !score.done) {
+        end_disturbance(&score, score.last_ms, true);
+    }
+
+    period_ms[TASK_BUTTON] = config.button_period_ms;
+    period_ms[TASK_CONTROL] = config.control_period_ms;
+    period_ms[TASK_VEHICLE] = config.vehicle_period_ms;
+    period_ms[TASK_DISPLAY] = DISPLAY_PERIOD_MS;
+    point->feasible = schedulable(period_ms, sweep->wcet_us, &point->utilization);
+
+    point->settled = (score.disturbances > 0) && (score.unsettled == 0);
+    point->settling_ms = score.settling_max_ms;
+    point->settling_avg_ms = (score.disturbances > 0) ? (uint32_t)(score.settling_sum_ms / score.disturbances) : 0;
+    point->disturbances = score.disturbances;
+    point->overshoot = (uint32_t)score.overshoot;
+    point->effort = score.effort;
+    point->rms_error = (score.samples > 0) ? sqrt(score.sum_sq / score.samples) : 0.0;
+}
+
+static void *worker(void *arg) {
+    sweep_t *sweep = arg;
+    size_t i;
+
+    while ((i = atomic_fetch_add_explicit(&sweep->next, 1, memory_order_relaxed)) < sweep->count) {
+        evaluate(sweep, &sweep->points[i]);
+    }
+    return NULL;
+}
+
+/**
+ * @brief true if a is at least as good as b in all objectives and better in one.
+ */
+static bool dominates(const point_t *a, const point_t *b) {
+    bool no_worse = (a->settling_ms <= b->settling_ms) && (a->overshoot <= b->overshoot) &&
+                    (a->effort <= b->effort);
+    bool better = (a->settling_ms < b->settling_ms) || (a->overshoot < b->overshoot) ||
+                  (a->effort < b->effort);
+
+    return no_worse && better;
+}
+
+static bool valid(const point_t *p) {
+    return p->settled && p->feasible;
+}
+
+static void rank(point_t *points, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        points[i].rank = valid(&points[i]) ? 1 : 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!valid(&points[i])) {
+            continue;
+        }
+        for (size_t j = 0; j < count; j++) {
+            if (valid(&points[j]) && dominates(&points[j], &points[i])) {
+                points[i].rank++;
+            }
+        }
+    }
+}
+
+static int by_rank(const void *a, const void *b) {
+    const point_t *p = a;
+    const point_t *q = b;
+    uint32_t rp = (p->rank == 0) ? UINT32_MAX : p->rank;
+    uint32_t rq = (q->rank == 0) ? UINT32_MAX : q->rank;
+
+    if (rp != rq) {
+        return (rp < rq) ? -1 : 1;
+    }
+    if (p->settling_ms != q->settling_ms) {
+        return (p->settling_ms < q->settling_ms) ? -1 : 1;
+    }
+    if (p->overshoot != q->overshoot) {
+        return (p->overshoot < q->overshoot) ? -1 : 1;
+    }
+    return (p->effort < q->effort) ? -1 : (p->effort > q->effort);
+}
+
+static void write_points(FILE *out, const point_t *points, size_t count, bool front_only) {
+    fprintf(out, "rank,gas_step,error_band,button_ms,control_ms,vehicle_ms,"
+                 "settling_ms,settling_avg_ms,disturbances,overshoot,effort,rms_error,utilization,"
+                 "settled,feasible\n");
+    for (size_t i = 0; i < count; i++) {
+        const point_t *p = &points[i];
+
+        if (front_only && (p->rank != 1)) {
+            continue;
+        }
+        fprintf(out, "%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%.1f,%.3f,%d,%d\n",
+                (unsigned long)p->rank, (unsigned long)p->param[PARAM_GAS_STEP],
+                (unsigned long)p->param[PARAM_ERROR_BAND], (unsigned long)p->param[PARAM_BUTTON_MS],
+                (unsigned long)p->param[PARAM_CONTROL_MS], (unsigned long)p->param[PARAM_VEHICLE_MS],
+                (unsigned long)p->settling_ms, (unsigned long)p->settling_avg_ms,
+                (unsigned long)p->disturbances, (unsigned long)p->overshoot, (unsigned long)p->effort,
+                p->rms_error, p->utilization, p->settled, p->feasible);
+    }
+}
+
+static void usage(const char *name) {
+    fprintf(stderr,
+            "usage: %s [options] script.txt|-\n"
+            "ranges are first[:last[:step]], all values >= 1\n"
+            "  -g range  throttle step of the gas pedal (default 1:8)\n"
+            "  -b range  error band of the step controller in 0.1 m/s (default 10:80:10)\n"
+            "  -B range  Button period in ms (default 25:100:25)\n"
+            "  -C range  Control period in ms (default 100:400:50)\n"
+            "  -V range  Vehicle period in ms (default 50:200:50)\n"
+            "  -t n      settling tolerance in 0.1 m/s (default 40)\n"
+            "  -w list   execution times in us of Button,Control,Vehicle,Display\n"
+            "            (default 1000,2000,1000,20000)\n"
+            "  -p        PI controller (cruise_pi_default) instead of the step controller\n"
+            "  -m us     sub-stepped vehicle model with step us instead of the lab physics\n"
+            "  -j n      threads (default: online CPUs)\n"
+            "  -o file   write the Pareto front to file instead of stdout\n"
+            "  -a file   also write all points, ranked\n",
+            name);
+}
+
+static int parse_range(const char *arg, range_t *range) {
+    unsigned long first, last, step = 1;
+    int n = sscanf(arg, "%lu:%lu:%lu", &first, &last, &step);
+
+    if (n == 1) {
+        last = first;
+    }
+    if ((n < 1) || (first == 0) || (last < first) || (last > 0xFFFFu) || (step == 0)) {
+        return -1;
+    }
+    range->first = (uint32_t)first;
+    range->last = (uint32_t)last;
+    range->step = (uint32_t)step;
+    return 0;
+}
+
+static size_t range_count(const range_t *range) {
+    return (range->last - range->first) / range->step + 1;
+}
+
+int main(int argc, char *argv[]) {
+    static const char param_opts[] = "gbBCV";     /* in the order of param_t */
+    range_t range[PARAMS] = {
+        [PARAM_GAS_STEP] = { 1, 8, 1 },
+        [PARAM_ERROR_BAND] = { 10, 80, 10 },
+        [PARAM_BUTTON_MS] = { 25, 100, 25 },
+        [PARAM_CONTROL_MS] = { 100, 400, 50 },
+        [PARAM_VEHICLE_MS] = { 50, 200, 50 },
+    };
+    uint32_t wcet_us[TASKS] = { 1000, 2000, 1000, 20000 };
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned long tolerance = 40;
+    FILE *out = stdout;
+    const char *all_path = NULL;
+    sim_config_t config;
+    sim_script_t script;
+    sweep_t sweep;
+    pthread_t *pool;
+    struct timespec start, stop;
+    double elapsed;
+    size_t front = 0;
+    int opt;
+
+    sim_config_lab(&config);
+
+    while ((opt = getopt(argc, argv, "g:b:B:C:V:t:w:pm:j:o:a:h")) != -1) {
+        const char *p = strchr(param_opts, opt);
+
+        if (p != NULL) {
+            if (parse_range(optarg, &range[p - param_opts]) != 0) {
+                fprintf(stderr, "%s: invalid range -%c %s\n", argv[0], opt, optarg);
+                return 2;
+            }
+            continue;
+        }
+        switch (opt) {
+        case 't':
+            tolerance = strtoul(optarg, NULL, 0);
+            break;
+        case 'w':
+            if (sscanf(optarg, "%u,%u,%u,%u", &wcet_us[TASK_BUTTON], &wcet_us[TASK_CONTROL],
+                       &wcet_us[TASK_VEHICLE], &wcet_us[TASK_DISPLAY]) != TASKS) {
+                fprintf(stderr, "%s: -w expects four execution times\n", argv[0]);
+                return 2;
+            }
+            break;
+        case 'p':
+            config.control.pi = &cruise_pi_default;
+            break;
+        case 'm':
+            config.vehicle.substep_us = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'j':
+            threads = strtol(optarg, NULL, 0);
+            break;
+        case 'o':
+            out = fopen(optarg, "w");
+            if (out == NULL) {
+                perror(optarg);
+                return 1;
+            }
+            break;
+        case 'a':
+            all_path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (sim_script_load(argv[optind], &script) != 0) {
+        return 1;
+    }
+
+    /* All combinations, the first parameter varies slowest */
+    sweep.count = 1;
+    for (int i = 0; i < PARAMS; i++) {
+        sweep.count *= range_count(&range[i]);
+    }
+    sweep.points = calloc(sweep.count, sizeof(point_t));
+    pool = calloc((size_t)threads, sizeof(pthread_t));
+    if ((sweep.points == NULL) || (pool == NULL)) {
+        perror("calloc");
+        return 1;
+    }
+    for (size_t n = 0; n < sweep.count; n++) {
+        size_t rest = n;
+
+        for (int i = PARAMS - 1; i >= 0; i--) {
+            sweep.points[n].param[i] = range[i].first + (uint32_t)(rest % range_count(&range[i])) * range[i].step;
+            rest /= range_count(&range[i]);
+        }
+    }
+    sweep.base = &config;
+    sweep.script = &script;
+    sweep.wcet_us = wcet_us;
+    sweep.tolerance = (uint16_t)tolerance;
+    atomic_init(&sweep.next, 0);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long t = 0; t < threads; t++) {
+        if (pthread_create(&pool[t], NULL, worker, &sweep) != 0) {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+    for (long t = 0; t < threads; t++) {
+        pthread_join(pool[t], NULL);
+    }
+    rank(sweep.points, sweep.count);
+    qsort(sweep.points, sweep.count, sizeof(point_t), by_rank);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    elapsed = (double)(stop.tv_sec - start.tv_sec) + (double)(stop.tv_nsec - start.tv_nsec) * 1e-9;
+
+    write_points(out, sweep.points, sweep.count, true);
+    if (all_path != NULL) {
+        FILE *all = fopen(all_path, "w");
+
+        if (all == NULL) {
+            perror(all_path);
+            return 1;
+        }
+        write_points(all, sweep.points, sweep.count, false);
+        fclose(all);
+    }
+
+    for (size_t n = 0; n < sweep.count; n++) {
+        front += (sweep.points[n].rank == 1);
+    }
+    fprintf(stderr, "%zu points on %ld threads in %.3f s, %zu on the Pareto front\n",
+            sweep.count, threads, elapsed, front);
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    free(pool);
+    free(sweep.points);
+    sim_script_free(&script);
+    return 0;
+}
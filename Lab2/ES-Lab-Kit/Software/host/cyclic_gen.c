@@ -0,0 +1,315 @@
+/**
+ * @file cyclic_gen.c
+ *
+ * @brief Builds the frame table of the cyclic executive (cyclic.h) from a
+ *        project's task table.
+ *
+ *     cyclic_gen [options] tasks.csv
+ *
+ * The hyperperiod H is the least common multiple of the periods. Unless
+ * given with -f, the frame size f is the largest divisor of H (in ms) that
+ * satisfies
+ *
+ *     f >= C(i)                       every job fits into one frame,
+ *     2f - gcd(f, T(i)) <= D(i)       a full frame lies between the release
+ *                                     and the deadline of every job,
+ *
+ * and for which the jobs can be placed: every job of the hyperperiod, in
+ * the order of the deadlines, goes into the earliest frame that starts at
+ * or after its release, ends by its deadline and still has room for its
+ * WCET. Larger frames mean fewer timer interrupts; a smaller f is tried if
+ * the placement fails.
+ *
+ * The tool prints the WCET sum and slack of every frame. The exit code is 1
+ * if no frame size works, e.g. because a job is longer than the shortest
+ * period allows; such a task has to be split into several job functions.
+ *
+ * CyclicTable.cmake runs the tool when a firmware project is configured and
+ * includes the header written with -H.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "cyclic.h"
+#include "rta.h"
+#include "tasktable.h"
+
+#define MAX_FRAMES          1000
+#define MAX_JOBS            4096
+
+/**
+ * @brief One job of the hyperperiod, times in ms.
+ */
+typedef struct {
+    uint8_t task;
+    uint32_t release_ms;
+    uint32_t deadline_ms;       /* Absolute */
+    uint32_t wcet_us;
+} job_t;
+
+/**
+ * @brief Frame table being built.
+ */
+typedef struct {
+    uint32_t hyperperiod_ms;
+    uint32_t frame_ms;
+    uint32_t frames;
+    uint32_t count;             /* Jobs */
+    job_t jobs[MAX_JOBS];       /* Sorted by deadline */
+    uint32_t frame_of[MAX_JOBS];
+    uint32_t load_us[MAX_FRAMES];
+} plan_t;
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t r = a % b;
+
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+static int by_deadline(const void *a, const void *b) {
+    const job_t *x = a, *y = b;
+
+    if (x->deadline_ms != y->deadline_ms) {
+        return (x->deadline_ms < y->deadline_ms) ? -1 : 1;
+    }
+    if (x->release_ms != y->release_ms) {
+        return (x->release_ms < y->release_ms) ? -1 : 1;
+    }
+    return (int)x->task - (int)y->task;
+}
+
+/**
+ * @brief Checks the frame conditions of frame size f for all tasks.
+ */
+static bool frame_fits(const tasktable_t *table, uint32_t f) {
+    for (size_t i = 0; i < table->count; i++) {
+        const rta_task_t *t = &table->tasks[i];
+        uint32_t period_ms = t->period_us / 1000u;
+
+        if ((t->wcet_us > f * 1000u) || (2u * f - gcd(f, period_ms) > rta_deadline(t) / 1000u)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Places the jobs into frames of size f.
+ *
+ * @return bool false if a job finds no frame with room.
+ */
+static bool place(plan_t *plan, uint32_t f) {
+    plan->frame_ms = f;
+    plan->frames = plan->hyperperiod_ms / f;
+    memset(plan->load_us, 0, sizeof(plan->load_us));
+
+    for (uint32_t j = 0; j < plan->count; j++) {
+        const job_t *job = &plan->jobs[j];
+        uint32_t frame = (job->release_ms + f - 1u) / f;
+
+        while (((frame + 1u) * f <= job->deadline_ms) && (plan->load_us[frame] + job->wcet_us > f * 1000u)) {
+            frame++;
+        }
+        if ((frame + 1u) * f > job->deadline_ms) {
+            return false;
+        }
+        plan->frame_of[j] = frame;
+        plan->load_us[frame] += job->wcet_us;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes CYCLIC_FRAME_US, CYCLIC_FRAMES, CYCLIC_TASK_<NAME> and the
+ *        frame table cyclic_table.
+ */
+static void write_header(FILE *out, const char *source, const tasktable_t *table, const plan_t *plan) {
+    uint32_t entries = 0;
+
+    fprintf(out, "/* Generated by cyclic_gen from %s, do not edit. */\n\n", source);
+    fprintf(out, "#ifndef CYCLIC_TABLE_H\n#define CYCLIC_TABLE_H\n\n#include \"cyclic.h\"\n\n");
+    fprintf(out, "#define CYCLIC_HYPERPERIOD_MS %luu\n", (unsigned long)plan->hyperperiod_ms);
+    fprintf(out, "#define CYCLIC_FRAME_US %luu\n", (unsigned long)(plan->frame_ms * 1000u));
+    fprintf(out, "#define CYCLIC_FRAMES %luu\n", (unsigned long)plan->frames);
+    fprintf(out, "#define CYCLIC_TASKS %zuu\n\n", table->count);
+    for (size_t i = 0; i < table->count; i++) {
+        char macro[TASKTABLE_NAME_LENGTH];
+
+        fprintf(out, "#define CYCLIC_TASK_%s %zuu\n", tasktable_macro(table->names[i], macro), i);
+    }
+
+    fprintf(out, "\nstatic const char *const cyclic_task_names[CYCLIC_TASKS] = {");
+    for (size_t i = 0; i < table->count; i++) {
+        fprintf(out, "%s\"%s\"", (i == 0) ? " " : ", ", table->names[i]);
+    }
+    fprintf(out, " };\n");
+
+    fprintf(out, "\nstatic const uint16_t cyclic_first[CYCLIC_FRAMES + 1] = {");
+    for (uint32_t frame = 0; frame <= plan->frames; frame++) {
+        fprintf(out, "%s%lu", ((frame % 10u) == 0) ? "\n    " : " ", (unsigned long)entries);
+        for (uint32_t j = 0; (frame < plan->frames) && (j < plan->count); j++) {
+            entries += (plan->frame_of[j] == frame) ? 1u : 0u;
+        }
+        fputc((frame < plan->frames) ? ',' : '\n', out);
+    }
+    fprintf(out, "};\n");
+
+    fprintf(out, "\nstatic const cyclic_entry_t cyclic_entries[%lu] = {\n", (unsigned long)entries);
+    for (uint32_t frame = 0; frame < plan->frames; frame++) {
+        fprintf(out, "    /* Frame %lu */", (unsigned long)frame);
+        for (uint32_t j = 0; j < plan->count; j++) {
+            if (plan->frame_of[j] == frame) {
+                fprintf(out, " { %u, %lu },", (unsigned)plan->jobs[j].task,
+                        (unsigned long)plan->jobs[j].release_ms);
+            }
+        }
+        fputc('\n', out);
+    }
+    fprintf(out, "};\n");
+
+    fprintf(out, "\nstatic const cyclic_table_t cyclic_table = {\n"
+                 "    CYCLIC_FRAME_US, CYCLIC_FRAMES, CYCLIC_TASKS, cyclic_first, cyclic_entries\n};\n");
+    fprintf(out, "\n#endif /* CYCLIC_TABLE_H */\n");
+}
+
+static void usage(const char *name) {
+    fprintf(stderr,
+            "usage: %s [options] tasks.csv\n"
+            "  -f ms     frame size instead of the largest feasible one\n"
+            "  -H file   write the frame table as C header\n"
+            "  -q        print only failures\n",
+            name);
+}
+
+int main(int argc, char *argv[]) {
+    static tasktable_t table;
+    static plan_t plan;
+    const char *header_out = NULL;
+    uint32_t frame_ms = 0, max_wcet_us = 0;
+    bool quiet = false, feasible = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:H:qh")) != -1) {
+        switch (opt) {
+        case 'f':
+            frame_ms = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'H':
+            header_out = optarg;
+            break;
+        case 'q':
+            quiet = true;
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (tasktable_read(argv[optind], &table) != 0) {
+        return 2;
+    }
+    if ((table.count == 0) || (table.count > CYCLIC_MAX_TASKS)) {
+        fprintf(stderr, "%s: 1 to %d tasks expected\n", argv[optind], CYCLIC_MAX_TASKS);
+        return 2;
+    }
+
+    plan.hyperperiod_ms = 1;
+    for (size_t i = 0; i < table.count; i++) {
+        uint32_t period_ms = table.tasks[i].period_us / 1000u;
+
+        plan.hyperperiod_ms = plan.hyperperiod_ms / gcd(plan.hyperperiod_ms, period_ms) * period_ms;
+        max_wcet_us = (table.tasks[i].wcet_us > max_wcet_us) ? table.tasks[i].wcet_us : max_wcet_us;
+        if (plan.hyperperiod_ms > UINT16_MAX) {
+            fprintf(stderr, "%s: hyperperiod above %u ms\n", argv[optind], UINT16_MAX);
+            return 2;
+        }
+    }
+
+    /* All jobs of one hyperperiod, sorted by deadline */
+    plan.count = 0;
+    for (size_t i = 0; i < table.count; i++) {
+        const rta_task_t *t = &table.tasks[i];
+        uint32_t period_ms = t->period_us / 1000u;
+
+        for (uint32_t release = 0; release < plan.hyperperiod_ms; release += period_ms) {
+            if (plan.count == MAX_JOBS) {
+                fprintf(stderr, "%s: more than %d jobs per hyperperiod\n", argv[optind], MAX_JOBS);
+                return 2;
+            }
+            plan.jobs[plan.count++] = (job_t){ .task = (uint8_t)i, .release_ms = release,
+                                               .deadline_ms = release + rta_deadline(t) / 1000u,
+                                               .wcet_us = t->wcet_us };
+        }
+    }
+    qsort(plan.jobs, plan.count, sizeof(plan.jobs[0]), by_deadline);
+
+    if (frame_ms != 0) {
+        if ((plan.hyperperiod_ms % frame_ms) != 0) {
+            fprintf(stderr, "%s: frame of %lu ms does not divide the hyperperiod of %lu ms\n", argv[optind],
+                    (unsigned long)frame_ms, (unsigned long)plan.hyperperiod_ms);
+            return 2;
+        }
+        if (!frame_fits(&table, frame_ms)) {
+            printf("Frame of %lu ms violates f >= C or 2f - gcd(f, T) <= D\n", (unsigned long)frame_ms);
+        } else {
+            feasible = place(&plan, frame_ms);
+        }
+    } else {
+        for (uint32_t f = plan.hyperperiod_ms; (f > 0) && !feasible; f--) {
+            if (((plan.hyperperiod_ms % f) == 0) && (plan.hyperperiod_ms / f <= MAX_FRAMES) &&
+                frame_fits(&table, f)) {
+                feasible = place(&plan, f);
+            }
+        }
+    }
+
+    if (!quiet || !feasible) {
+        printf("Hyperperiod %lu ms, %lu jobs, longest WCET %lu us\n", (unsigned long)plan.hyperperiod_ms,
+               (unsigned long)plan.count, (unsigned long)max_wcet_us);
+    }
+    if (feasible && !quiet) {
+        uint32_t min_slack = UINT32_MAX;
+
+        printf("%5s %8s %5s %10s %10s\n", "Frame", "Start", "Jobs", "WCET (us)", "Slack (us)");
+        for (uint32_t frame = 0; frame < plan.frames; frame++) {
+            uint32_t jobs = 0;
+
+            for (uint32_t j = 0; j < plan.count; j++) {
+                jobs += (plan.frame_of[j] == frame) ? 1u : 0u;
+            }
+            printf("%5lu %8lu %5lu %10lu %10lu\n", (unsigned long)frame, (unsigned long)(frame * plan.frame_ms),
+                   (unsigned long)jobs, (unsigned long)plan.load_us[frame],
+                   (unsigned long)(plan.frame_ms * 1000u - plan.load_us[frame]));
+            if (plan.frame_ms * 1000u - plan.load_us[frame] < min_slack) {
+                min_slack = plan.frame_ms * 1000u - plan.load_us[frame];
+            }
+        }
+        printf("%s: %lu frames of %lu ms, minimum slack %lu us\n", argv[optind], (unsigned long)plan.frames,
+               (unsigned long)plan.frame_ms, (unsigned long)min_slack);
+    } else if (!feasible) {
+        printf("%s: NO FRAME TABLE, split the longest jobs or relax the deadlines\n", argv[optind]);
+    }
+
+    if (feasible && (header_out != NULL)) {
+        FILE *out = fopen(header_out, "w");
+
+        if (out == NULL) {
+            perror(header_out);
+            return 2;
+        }
+        write_header(out, argv[optind], &table, &plan);
+        fclose(out);
+    }
+    return feasible ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+/**
+ * @file cyclic_test.c
+ *
+ * @brief Host test of the cyclic executive of cyclic.h with a simulated
+ *        clock.
+ *
+ * The job functions advance the clock by their execution time, so every
+ * latency and execution time is known exactly. The test checks:
+ * - overrun detection: a frame whose jobs end after the next frame start is
+ *   counted, one that ends on time is not,
+ * - the releases and start latencies across the hyperperiod and across the
+ *   wrap of the 32-bit clock,
+ * - the accounting of nested jobs in cyclic_job_begin()/cyclic_job_end():
+ *   a job's execution time excludes the jobs that preempted it.
+ *
+ * Exit code 1 if a check fails.
+ */
+
+#include <stdio.h>
+#include "cyclic.h"
+
+#define FRAME_US        10000u
+#define ISR_US          7u      /* Frame start to the first clock read */
+
+static int failures;
+static uint32_t now_us;
+static uint32_t exec_us[3];     /* Execution time of the next job of each task */
+
+static uint32_t fake_clock(void) {
+    return now_us;
+}
+
+static void job0(void) { now_us += exec_us[0]; }
+static void job1(void) { now_us += exec_us[1]; }
+static void job2(void) { now_us += exec_us[2]; }
+
+static const cyclic_job_t jobs[] = { job0, job1, job2 };
+
+/*
+ * Hyperperiod 40 ms in 4 frames of 10 ms:
+ *   task 0 every 10 ms, task 1 every 20 ms, task 2 every 40 ms (released at 0, placed in frame 1).
+ */
+static const cyclic_entry_t entries[] = {
+    { 0, 0 }, { 1, 0 },         /* frame 0 */
+    { 0, 10 }, { 2, 0 },        /* frame 1 */
+    { 0, 20 }, { 1, 20 },       /* frame 2 */
+    { 0, 30 },                  /* frame 3 */
+};
+static const uint16_t first[] = { 0, 2, 4, 6, 7 };
+static const cyclic_table_t table = {
+    .frame_us = FRAME_US,
+    .frames = 4,
+    .tasks = 3,
+    .first = first,
+    .entries = entries,
+};
+
+static void check(const char *what, uint64_t value, uint64_t expected) {
+    if (value != expected) {
+        printf("cyclic_test.c: %s is %llu, expected %llu\n", what, (unsigned long long)value,
+               (unsigned long long)expected);
+        failures++;
+    }
+}
+
+/**
+ * @brief Runs frames with the ISR latency, as the alarm interrupt of the firmware.
+ */
+static uint32_t run_frames(cyclic_t *c, uint32_t start_us, unsigned frames) {
+    for (unsigned i = 0; i < frames; i++) {
+        now_us = start_us + ISR_US;
+        start_us = cyclic_run_frame(c, start_us);
+    }
+    return start_us;
+}
+
+static void test_overrun(void) {
+    cyclic_t c;
+    uint32_t start_us = 0;
+
+    cyclic_init(&c, &table, jobs, 3, fake_clock);
+
+    /* Frame 1 holds task 0 and task 2: 4 ms + 6 ms + ISR_US ends just after the next start */
+    exec_us[0] = 4000;
+    exec_us[1] = 1000;
+    exec_us[2] = 6000;
+    start_us = run_frames(&c, start_us, 1);
+    check("overruns after frame 0", c.overruns, 0);
+    start_us = run_frames(&c, start_us, 1);
+    check("overruns after frame 1", c.overruns, 1);
+    check("longest frame", c.max_frame_us, ISR_US + 10000);
+
+    /* Ending exactly at the next frame start is no overrun */
+    exec_us[2] = 6000 - ISR_US;
+    start_us = run_frames(&c, start_us, 4);
+    check("overruns after frame 1 of the next hyperperiod", c.overruns, 1);
+    check("frames run", c.frames_run, 6);
+    check("next frame", c.frame, 2);
+    check("longest frame", c.max_frame_us, ISR_US + 10000);
+    check("busy time", c.busy_us, 5000 + 10000 + 5000 + 4000 + 5000 + 9993);
+    check("job time", c.job_us, c.busy_us);
+    (void)start_us;
+}
+
+static void test_releases(uint32_t start_us) {
+    cyclic_t c;
+
+    cyclic_init(&c, &table, jobs, 3, fake_clock);
+    exec_us[0] = 300;
+    exec_us[1] = 200;
+    exec_us[2] = 500;
+
+    /* Three hyperperiods, starting a little before the clock wraps */
+    start_us = run_frames(&c, start_us, 3 * 4);
+
+    check("frames run", c.frames_run, 12);
+    check("overruns", c.overruns, 0);
+
+    /* Task 0 is first in every frame: ISR_US after its release */
+    check("task 0 jobs", c.stats[0].latency.count, 12);
+    check("task 0 min latency", c.stats[0].latency.min_us, ISR_US);
+    check("task 0 max latency", c.stats[0].latency.max_us, ISR_US);
+
+    /* Task 1 follows task 0 in frames 0 and 2 */
+    check("task 1 jobs", c.stats[1].latency.count, 6);
+    check("task 1 min latency", c.stats[1].latency.min_us, ISR_US + 300);
+    check("task 1 max latency", c.stats[1].latency.max_us, ISR_US + 300);
+
+    /* Task 2 is released at 0 and runs in frame 1 after task 0 */
+    check("task 2 jobs", c.stats[2].latency.count, 3);
+    check("task 2 min latency", c.stats[2].latency.min_us, FRAME_US + ISR_US + 300);
+    check("task 2 max latency", c.stats[2].latency.max_us, FRAME_US + ISR_US + 300);
+
+    check("task 0 exec", c.stats[0].exec.max_us, 300);
+    check("task 2 exec", c.stats[2].exec.min_us, 500);
+    check("job time", c.job_us, 12 * 300 + 6 * 200 + 3 * 500);
+    (void)start_us;
+}
+
+static void test_nesting(void) {
+    cyclic_t c;
+
+    cyclic_init(&c, NULL, NULL, 3, fake_clock);
+
+    /* Task 0 from 1000 to 1300, preempted by task 1 (1100..1200), itself preempted by task 2 (1150..1170) */
+    now_us = 1000;
+    cyclic_job_begin(&c, 0, 990);
+    now_us = 1100;
+    cyclic_job_begin(&c, 1, 1100);
+    now_us = 1150;
+    cyclic_job_begin(&c, 2, 1140);
+    now_us = 1170;
+    cyclic_job_end(&c);
+    now_us = 1200;
+    cyclic_job_end(&c);
+    now_us = 1300;
+    cyclic_job_end(&c);
+
+    check("depth", c.depth, 0);
+    check("task 0 latency", c.stats[0].latency.max_us, 10);
+    check("task 2 latency", c.stats[2].latency.max_us, 10);
+    check("task 2 exec", c.stats[2].exec.max_us, 20);
+    check("task 1 exec", c.stats[1].exec.max_us, 80);
+    check("task 0 exec", c.stats[0].exec.max_us, 200);
+    check("job time", c.job_us, 300);
+
+    /* An end without a begin and an unknown task are ignored */
+    cyclic_job_end(&c);
+    cyclic_job_begin(&c, 3, now_us);
+    check("depth after unknown task", c.depth, 0);
+
+    /* A start before the release counts as latency 0 */
+    cyclic_job_begin(&c, 2, now_us + 50);
+    cyclic_job_end(&c);
+    check("task 2 min latency", c.stats[2].latency.min_us, 0);
+}
+
+int main(void) {
+    test_overrun();
+    test_releases(0);
+    test_releases(UINT32_MAX - 25000u);     /* Wraps in the first hyperperiod */
+    test_nesting();
+
+    if (failures > 0) {
+        printf("cyclic_test: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("cyclic_test: passed\n");
+    return 0;
+}
@@ -0,0 +1,24 @@
+/**
+ * @file FreeRTOS.h
+ *
+ * @brief Host stand-in for the kernel configuration that rtos/tickless.c
+ *        needs; the functions are implemented by tickless_test.c.
+ */
+
+#ifndef FAKE_FREERTOS_H
+#define FAKE_FREERTOS_H
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+
+#define pdPASS                  1
+#define pdFAIL                  0
+#define configTICK_RATE_HZ      ( ( TickType_t ) 1000 )
+#define configNUMBER_OF_CORES   1
+#define pdMS_TO_TICKS(ms)       ( ( TickType_t ) ( ( ( uint64_t ) ( ms ) * configTICK_RATE_HZ ) / 1000u ) )
+
+#define appUSE_TICKLESS_IDLE    1
+
+#endif /* FAKE_FREERTOS_H */
@@ -0,0 +1,24 @@
+/**
+ * @file scb.h
+ *
+ * @brief Host stand-in for the interrupt control and state register, with
+ *        the same write tracking as systick.h.
+ */
+
+#ifndef FAKE_HARDWARE_STRUCTS_SCB_H
+#define FAKE_HARDWARE_STRUCTS_SCB_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t icsr;
+} armv8m_scb_hw_t;
+
+#define M33_ICSR_PENDSTSET_BITS     0x04000000u
+#define M33_ICSR_PENDSTCLR_BITS     0x02000000u
+
+armv8m_scb_hw_t *fake_scb_hw(void);
+
+#define scb_hw (fake_scb_hw())
+
+#endif /* FAKE_HARDWARE_STRUCTS_SCB_H */
@@ -0,0 +1,29 @@
+/**
+ * @file systick.h
+ *
+ * @brief Host stand-in for the SysTick registers.
+ *
+ * Every use of systick_hw calls fake_systick_hw() first, which applies the
+ * writes made since the previous use to the model and refreshes the
+ * counter, so a test can model the SysTick behind plain struct accesses.
+ */
+
+#ifndef FAKE_HARDWARE_STRUCTS_SYSTICK_H
+#define FAKE_HARDWARE_STRUCTS_SYSTICK_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t csr;
+    uint32_t rvr;
+    uint32_t cvr;
+    uint32_t calib;
+} systick_hw_t;
+
+#define M33_SYST_CSR_ENABLE_BITS    0x00000001u
+
+systick_hw_t *fake_systick_hw(void);
+
+#define systick_hw (fake_systick_hw())
+
+#endif /* FAKE_HARDWARE_STRUCTS_SYSTICK_H */
@@ -0,0 +1,18 @@
+/**
+ * @file sync.h
+ *
+ * @brief Host stand-in for the interrupt masking and barriers used by
+ *        rtos/tickless.c.
+ */
+
+#ifndef FAKE_HARDWARE_SYNC_H
+#define FAKE_HARDWARE_SYNC_H
+
+#include <stdint.h>
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+void __dsb(void);
+void __wfi(void);
+
+#endif /* FAKE_HARDWARE_SYNC_H */
@@ -0,0 +1,19 @@
+/**
+ * @file timer.h
+ *
+ * @brief Host stand-in for the hardware alarm API used by rtos/tickless.c.
+ */
+
+#ifndef FAKE_HARDWARE_TIMER_H
+#define FAKE_HARDWARE_TIMER_H
+
+#include "pico/stdlib.h"
+
+typedef void (*hardware_alarm_callback_t)(uint alarm_num);
+
+int hardware_alarm_claim_unused(bool required);
+void hardware_alarm_set_callback(uint alarm_num, hardware_alarm_callback_t callback);
+bool hardware_alarm_set_target(uint alarm_num, absolute_time_t t);
+void hardware_alarm_cancel(uint alarm_num);
+
+#endif /* FAKE_HARDWARE_TIMER_H */
@@ -0,0 +1,23 @@
+/**
+ * @file stdlib.h
+ *
+ * @brief Host stand-in for the Pico SDK types and time functions used by
+ *        rtos/tickless.c.
+ */
+
+#ifndef FAKE_PICO_STDLIB_H
+#define FAKE_PICO_STDLIB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+uint64_t time_us_64(void);
+
+static inline absolute_time_t from_us_since_boot(uint64_t us) {
+    return us;
+}
+
+#endif /* FAKE_PICO_STDLIB_H */
@@ -0,0 +1,21 @@
+/**
+ * @file task.h
+ *
+ * @brief Host stand-in for the task API used by rtos/tickless.c.
+ */
+
+#ifndef FAKE_TASK_H
+#define FAKE_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef enum {
+    eAbortSleep = 0,
+    eStandardSleep,
+} eSleepModeStatus;
+
+eSleepModeStatus eTaskConfirmSleepModeStatus(void);
+TickType_t xTaskGetTickCount(void);
+void vTaskStepTick(TickType_t xTicksToJump);
+
+#endif /* FAKE_TASK_H */
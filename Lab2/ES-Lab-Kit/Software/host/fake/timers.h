@@ -0,0 +1,17 @@
+/**
+ * @file timers.h
+ *
+ * @brief Host stand-in for the timer service API used by rtos/tickless.c.
+ */
+
+#ifndef FAKE_TIMERS_H
+#define FAKE_TIMERS_H
+
+#include "FreeRTOS.h"
+
+typedef void (*PendedFunction_t)(void *, uint32_t);
+
+BaseType_t xTimerPendFunctionCall(PendedFunction_t xFunctionToPend, void *pvParameter1,
+                                  uint32_t ulParameter2, TickType_t xTicksToWait);
+
+#endif /* FAKE_TIMERS_H */
@@ -0,0 +1,129 @@
+/**
+ * @file fleet.c
+ *
+ * @brief Batch simulation of many independent vehicles.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "fleet.h"
+
+#define FLEET_ALIGN     64u     /* Cache line, also enough for AVX-512 */
+#define BRAKE           50.0f   /* Deceleration while braking, 0.1 m/s^2 */
+
+static float *alloc_floats(size_t count) {
+    size_t size = (count * sizeof(float) + FLEET_ALIGN - 1) / FLEET_ALIGN * FLEET_ALIGN;
+    float *array = aligned_alloc(FLEET_ALIGN, size);
+
+    if (array != NULL) {
+        memset(array, 0, size);
+    }
+    return array;
+}
+
+int fleet_init(fleet_t *fleet, size_t count, const terrain_map_t *track) {
+    memset(fleet, 0, sizeof(*fleet));
+    fleet->count = count;
+    fleet->velocity = alloc_floats(count);
+    fleet->position = alloc_floats(count);
+    fleet->length = alloc_floats(count);
+    fleet->throttle = alloc_floats(count);
+    fleet->brake = alloc_floats(count);
+    fleet->resist = alloc_floats(count);
+    fleet->seg_start = alloc_floats(count);
+    fleet->seg_end = alloc_floats(count);
+    fleet->track = calloc(count, sizeof(*fleet->track));
+
+    if ((fleet->velocity == NULL) || (fleet->position == NULL) || (fleet->length == NULL) ||
+        (fleet->throttle == NULL) || (fleet->brake == NULL) || (fleet->resist == NULL) ||
+        (fleet->seg_start == NULL) || (fleet->seg_end == NULL) || (fleet->track == NULL)) {
+        fleet_free(fleet);
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        fleet_set_track(fleet, i, track);
+    }
+    return 0;
+}
+
+void fleet_free(fleet_t *fleet) {
+    free(fleet->velocity);
+    free(fleet->position);
+    free(fleet->length);
+    free(fleet->throttle);
+    free(fleet->brake);
+    free(fleet->resist);
+    free(fleet->seg_start);
+    free(fleet->seg_end);
+    free(fleet->track);
+    memset(fleet, 0, sizeof(*fleet));
+}
+
+/**
+ * @brief Caches the segment a vehicle is on.
+ */
+static void lookup_segment(fleet_t *fleet, size_t i) {
+    const terrain_map_t *track = fleet->track[i];
+    uint16_t seg = terrain_segment_at(track, (uint16_t)fleet->position[i]);
+    const terrain_segment_t *segment = &track->segments[seg];
+
+    fleet->resist[i] = (float)(segment->grade + segment->wind);
+    fleet->seg_start[i] = (float)segment->start;
+    fleet->seg_end[i] = (seg + 1u < track->count) ? (float)track->segments[seg + 1].start
+                                                   : (float)track->length;
+}
+
+void fleet_set_track(fleet_t *fleet, size_t i, const terrain_map_t *track) {
+    fleet->track[i] = track;
+    fleet->length[i] = (float)track->length;
+    lookup_segment(fleet, i);
+}
+
+/**
+ * @brief Updates the vehicles that left their segment, rare at small steps.
+ */
+static void update_segments(fleet_t *fleet) {
+    const float *restrict position = fleet->position;
+    const float *restrict seg_start = fleet->seg_start;
+    const float *restrict seg_end = fleet->seg_end;
+
+    for (size_t i = 0; i < fleet->count; i++) {
+        if ((position[i] < seg_start[i]) || (position[i] >= seg_end[i])) {
+            lookup_segment(fleet, i);
+        }
+    }
+}
+
+/**
+ * @brief Integrates all vehicles, branch-free for the vectoriser.
+ */
+static void integrate(fleet_t *fleet, float dt_ms) {
+    const size_t count = fleet->count;
+    const float dt = dt_ms * 0.001f;
+    float *restrict velocity = __builtin_assume_aligned(fleet->velocity, FLEET_ALIGN);
+    float *restrict position = __builtin_assume_aligned(fleet->position, FLEET_ALIGN);
+    const float *restrict length = __builtin_assume_aligned(fleet->length, FLEET_ALIGN);
+    const float *restrict throttle = __builtin_assume_aligned(fleet->throttle, FLEET_ALIGN);
+    const float *restrict brake = __builtin_assume_aligned(fleet->brake, FLEET_ALIGN);
+    const float *restrict resist = __builtin_assume_aligned(fleet->resist, FLEET_ALIGN);
+
+    for (size_t i = 0; i < count; i++) {
+        float v0 = velocity[i];
+        float drive = throttle[i] * 0.5f - (v0 * v0 * 0.0001f + 1.0f) - resist[i];
+        float a = drive + brake[i] * (-BRAKE - drive);  /* brake is 0 or 1 */
+        float v1 = v0 + a * dt;
+        float p;
+
+        v1 = (v1 > 0.0f) ? v1 : 0.0f;
+        p = position[i] + (v0 + v1) * 0.5f * dt;
+        p -= (p >= length[i]) ? length[i] : 0.0f;
+
+        velocity[i] = v1;
+        position[i] = p;
+    }
+}
+
+void fleet_step(fleet_t *fleet, float dt_ms) {
+    integrate(fleet, dt_ms);
+    update_segments(fleet);
+}
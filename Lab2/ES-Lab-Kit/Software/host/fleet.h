@@ -0,0 +1,78 @@
+/**
+ * @file fleet.h
+ *
+ * @brief Batch simulation of many independent vehicles.
+ *
+ * The vehicles are stored as a struct of arrays, one array per state
+ * variable, and advance with the physics of the Vehicle task:
+ *
+ *     a = throttle / 2 - (v^2 / 10000 + 1) - grade - wind      [0.1 m/s^2]
+ *
+ * with a constant 5 m/s^2 deceleration instead while braking and the
+ * velocity limited to >= 0. Like vehicle_model.h, the position uses the
+ * trapezoidal rule.
+ *
+ * fleet_step() integrates all vehicles in one loop without branches, so the
+ * compiler vectorises it with SSE/AVX. Every vehicle caches grade and wind
+ * of its current segment with the segment's bounds; a second loop only
+ * looks up the track again for the few vehicles that left their segment.
+ * The state is in float: the int64 divisions of the Q16 model have no SIMD
+ * form.
+ */
+
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "terrain.h"
+
+/**
+ * @brief Fleet state. Inputs are written by the caller between steps.
+ */
+typedef struct {
+    size_t count;
+    float *velocity;        /* 0.1 m/s */
+    float *position;        /* 0.1 m, 0..length */
+    float *length;          /* Track length, 0.1 m */
+    float *throttle;        /* Input, 0..80 */
+    float *brake;           /* Input, 1.0 while braking, else 0.0 */
+    float *resist;          /* Grade + wind of the current segment, 0.1 m/s^2 */
+    float *seg_start;       /* Bounds of the current segment, 0.1 m */
+    float *seg_end;
+    const terrain_map_t **track;
+} fleet_t;
+
+/**
+ * @brief Allocates a fleet, all vehicles at rest at position 0 on track.
+ *
+ * @param fleet Fleet.
+ * @param count Number of vehicles.
+ * @param track Initial track of all vehicles, see fleet_set_track().
+ * @return int 0, or -1 if out of memory.
+ */
+int fleet_init(fleet_t *fleet, size_t count, const terrain_map_t *track);
+
+/**
+ * @brief Frees a fleet.
+ */
+void fleet_free(fleet_t *fleet);
+
+/**
+ * @brief Places a vehicle on a track.
+ *
+ * @param fleet Fleet.
+ * @param i Vehicle.
+ * @param track Track, must stay valid while the fleet is used.
+ */
+void fleet_set_track(fleet_t *fleet, size_t i, const terrain_map_t *track);
+
+/**
+ * @brief Advances all vehicles by one step.
+ *
+ * @param fleet Fleet.
+ * @param dt_ms Step in ms.
+ */
+void fleet_step(fleet_t *fleet, float dt_ms);
+
+#endif /* FLEET_H */
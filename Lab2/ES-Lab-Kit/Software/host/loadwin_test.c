@@ -0,0 +1,180 @@
+/**
+ * @file loadwin_test.c
+ *
+ * @brief Host test of the sliding windows of loadwin.h: the 1 ms -> 10 ms
+ *        -> 100 ms -> 1 s cascade, intervals that span several slots, the
+ *        deadline-miss counts and the hysteresis of loadwin_check().
+ *
+ * Exit code 1 if a check fails.
+ */
+
+#include <stdio.h>
+#include "loadwin.h"
+
+static int failures;
+
+#define CHECK_EQ(actual, expected) \
+    check_eq(__LINE__, #actual, (long)(actual), (long)(expected))
+
+static void check_eq(int line, const char *what, long actual, long expected) {
+    if (actual != expected) {
+        printf("loadwin_test.c:%d: %s is %ld, expected %ld\n", line, what, actual, expected);
+        failures++;
+    }
+}
+
+/**
+ * @brief Adds n milliseconds with busy_us of load in each.
+ */
+static void run_ms(loadwin_t *lw, uint32_t n, uint32_t busy_us) {
+    for (uint32_t i = 0; i < n; i++) {
+        loadwin_add(lw, busy_us, LOADWIN_BASE_US);
+    }
+}
+
+static void test_cascade(void) {
+    loadwin_t lw;
+
+    loadwin_init(&lw);
+
+    /* Nothing reaches a window before its first slot is complete */
+    run_ms(&lw, 9, 500);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_10MS), 450);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_100MS), 0);
+
+    /* The 10th ms completes the 10 ms ring, which becomes one 100 ms slot */
+    run_ms(&lw, 1, 500);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_10MS), 500);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_100MS), 50);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_1S), 0);
+
+    /* 100 ms fill the 100 ms window and give the first 1 s slot */
+    run_ms(&lw, 90, 500);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_100MS), 500);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_1S), 50);
+
+    run_ms(&lw, 900, 500);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_1S), 500);
+
+    /* 100 ms idle: the short windows empty, the 1 s window loses a tenth */
+    run_ms(&lw, 100, 0);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_10MS), 0);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_100MS), 0);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_1S), 450);
+
+    /* Fully busy: every window ends at 1000 permille */
+    run_ms(&lw, 1000, LOADWIN_BASE_US);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_10MS), 1000);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_100MS), 1000);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_1S), 1000);
+}
+
+static void test_intervals(void) {
+    loadwin_t lw;
+
+    loadwin_init(&lw);
+
+    /* One interval over 10 slots spreads its busy time evenly */
+    loadwin_add(&lw, 3000, 10 * LOADWIN_BASE_US);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_10MS), 300);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_100MS), 30);
+
+    /* Intervals that do not fall on slot boundaries */
+    loadwin_init(&lw);
+    for (uint32_t i = 0; i < 40; i++) {
+        loadwin_add(&lw, 100, 250);
+    }
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_10MS), 400);
+
+    /* Busy time beyond the interval is clamped */
+    loadwin_init(&lw);
+    loadwin_add(&lw, 20000, 10 * LOADWIN_BASE_US);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_10MS), 1000);
+
+    /* A long idle interval (e.g. after tickless sleep) clears all windows */
+    run_ms(&lw, 1000, LOADWIN_BASE_US);
+    loadwin_add(&lw, 0, 2000 * LOADWIN_BASE_US);
+    CHECK_EQ(loadwin_utilisation(&lw, LOADWIN_1S), 0);
+}
+
+static void test_misses(void) {
+    loadwin_t lw;
+
+    loadwin_init(&lw);
+
+    /* A miss counts when its slot is complete */
+    loadwin_add_miss(&lw);
+    loadwin_add_miss(&lw);
+    CHECK_EQ(loadwin_misses(&lw, LOADWIN_10MS), 0);
+    run_ms(&lw, 1, 0);
+    CHECK_EQ(loadwin_misses(&lw, LOADWIN_10MS), 2);
+
+    /* ... and moves on to the longer windows */
+    run_ms(&lw, 9, 0);
+    CHECK_EQ(loadwin_misses(&lw, LOADWIN_10MS), 2);
+    CHECK_EQ(loadwin_misses(&lw, LOADWIN_100MS), 2);
+    run_ms(&lw, 10, 0);
+    CHECK_EQ(loadwin_misses(&lw, LOADWIN_10MS), 0);
+    CHECK_EQ(loadwin_misses(&lw, LOADWIN_100MS), 2);
+    run_ms(&lw, 80, 0);
+    CHECK_EQ(loadwin_misses(&lw, LOADWIN_1S), 2);
+    run_ms(&lw, 100, 0);
+    CHECK_EQ(loadwin_misses(&lw, LOADWIN_100MS), 0);
+    CHECK_EQ(loadwin_misses(&lw, LOADWIN_1S), 2);
+    run_ms(&lw, 900, 0);
+    CHECK_EQ(loadwin_misses(&lw, LOADWIN_1S), 0);
+}
+
+static void test_hysteresis(void) {
+    const loadwin_limits_t limits = {
+        .level = LOADWIN_100MS, .enter_permille = 900, .exit_permille = 700, .miss_limit = 3
+    };
+    loadwin_t lw;
+
+    loadwin_init(&lw);
+
+    /* Between the thresholds the state is kept */
+    run_ms(&lw, 100, 800);
+    CHECK_EQ(loadwin_check(&lw, &limits, false), false);
+    CHECK_EQ(loadwin_check(&lw, &limits, true), true);
+
+    /* At the enter threshold overload is raised */
+    run_ms(&lw, 100, 900);
+    CHECK_EQ(loadwin_check(&lw, &limits, false), true);
+
+    /* Only below the exit threshold it is cleared */
+    run_ms(&lw, 100, 700);
+    CHECK_EQ(loadwin_check(&lw, &limits, true), true);
+    run_ms(&lw, 100, 699);
+    CHECK_EQ(loadwin_check(&lw, &limits, true), false);
+
+    /* Misses raise overload at any load and hold it until they leave the window */
+    for (int i = 0; i < 3; i++) {
+        loadwin_add_miss(&lw);
+    }
+    run_ms(&lw, 10, 100);
+    CHECK_EQ(loadwin_check(&lw, &limits, false), true);
+    run_ms(&lw, 80, 100);
+    CHECK_EQ(loadwin_check(&lw, &limits, true), true);
+    run_ms(&lw, 20, 100);
+    CHECK_EQ(loadwin_check(&lw, &limits, true), false);
+
+    /* Fewer misses than the limit do not raise it */
+    loadwin_add_miss(&lw);
+    run_ms(&lw, 10, 100);
+    CHECK_EQ(loadwin_check(&lw, &limits, false), false);
+}
+
+int main(void) {
+    test_cascade();
+    test_intervals();
+    test_misses();
+    test_hysteresis();
+
+    if (failures > 0) {
+        printf("loadwin_test: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("loadwin_test: passed\n");
+    return 0;
+}
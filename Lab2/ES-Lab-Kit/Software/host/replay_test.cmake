@@ -0,0 +1,31 @@
+# Record/replay check of cruise_sim, run by ctest (add_test in CMakeLists.txt).
+#
+#   cmake -DSIM=<cruise_sim> -DSCRIPT=<script.txt> -DWORK=<dir> [-DOPTIONS="-p;-m;1000"] -P replay_test.cmake
+#
+# Runs the script with -R, which records the Button samples, then replays the recording with
+# -r and the same OPTIONS. The two CSV traces must be byte-identical.
+
+file(MAKE_DIRECTORY ${WORK})
+set(recording ${WORK}/recording.txt)
+set(recorded ${WORK}/recorded.csv)
+set(replayed ${WORK}/replayed.csv)
+
+execute_process(COMMAND ${SIM} ${OPTIONS} -R ${recording} -o ${recorded} ${SCRIPT}
+                RESULT_VARIABLE result ERROR_QUIET)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Recording ${SCRIPT} failed (${result})")
+endif()
+
+execute_process(COMMAND ${SIM} ${OPTIONS} -r -o ${replayed} ${recording}
+                RESULT_VARIABLE result ERROR_QUIET)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Replaying ${recording} failed (${result})")
+endif()
+
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${recorded} ${replayed}
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "The replay of ${SCRIPT} differs from the recorded run: "
+                        "compare ${recorded} and ${replayed}")
+endif()
+message(STATUS "Replay of ${SCRIPT} is identical")
@@ -0,0 +1,264 @@
+/**
+ * @file rta_check.c
+ *
+ * @brief Schedulability check of a project's task table.
+ *
+ *     rta_check [options] tasks.csv
+ *
+ * The table format is described in tasktable.h, the analysis in rta.h. The tool
+ * prints the worst-case response time and slack of every task, the
+ * utilisation against the rate-monotonic bound, and whether rate- and
+ * deadline-monotonic priorities would be schedulable. The exit code is 1 if
+ * a task can miss its deadline with the declared priorities.
+ *
+ * With -m the WCETs are seeded from a firmware log: every "Budget: <task>
+ * WCET <n> us" line of budget_report() that starts with a task name of the
+ * table sets the WCET of that task to the largest measured value plus the
+ * margin. Write the result with -w to keep it.
+ *
+ * TaskSetCheck.cmake runs the tool when a firmware project is configured and
+ * includes the header written with -H.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "rta.h"
+#include "tasktable.h"
+
+/**
+ * @brief Task table and the largest WCET of each task in the log, 0 if none.
+ */
+typedef struct {
+    tasktable_t table;
+    uint32_t measured_us[TASKTABLE_MAX_TASKS];
+} measured_t;
+
+static char *trim(char *s) {
+    char *end;
+
+    while (isspace((unsigned char)*s)) {
+        s++;
+    }
+    end = s + strlen(s);
+    while ((end > s) && isspace((unsigned char)end[-1])) {
+        *--end = '\0';
+    }
+    return s;
+}
+
+/**
+ * @brief Reads the largest measured execution time of each task from the
+ *        budget_report() lines of a firmware log.
+ */
+static int read_measurements(const char *path, measured_t *m) {
+    const tasktable_t *table = &m->table;
+    FILE *in = fopen(path, "r");
+    char line[256];
+
+    if (in == NULL) {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), in) != NULL) {
+        char *p = strstr(line, "Budget: ");
+        char *wcet;
+        unsigned long us;
+
+        if ((p == NULL) || ((wcet = strstr(p, " WCET ")) == NULL) ||
+            (sscanf(wcet, " WCET %lu us", &us) != 1)) {
+            continue;
+        }
+        *wcet = '\0';
+        p = trim(p + strlen("Budget: "));
+        for (size_t i = 0; i < table->count; i++) {
+            size_t n = strlen(table->names[i]);
+
+            /* "Button Task" is the task of table entry "Button" */
+            if ((strncmp(p, table->names[i], n) == 0) && ((p[n] == '\0') || (p[n] == ' ')) &&
+                (us > m->measured_us[i])) {
+                m->measured_us[i] = (uint32_t)us;
+            }
+        }
+    }
+    fclose(in);
+    return 0;
+}
+
+/**
+ * @brief Writes TASK_<NAME>_PERIOD_MS, _DEADLINE_MS, _WCET_US, _PRIORITY and
+ *        _WCRT_US for every task.
+ */
+static void write_header(FILE *out, const char *source, const tasktable_t *table, const uint32_t *response_us) {
+    fprintf(out, "/* Generated by rta_check from %s, do not edit. */\n\n", source);
+    fprintf(out, "#ifndef TASKSET_H\n#define TASKSET_H\n");
+    for (size_t i = 0; i < table->count; i++) {
+        const rta_task_t *t = &table->tasks[i];
+        char macro[TASKTABLE_NAME_LENGTH];
+
+        tasktable_macro(t->name, macro);
+        fprintf(out, "\n#define TASK_%s_PERIOD_MS %luu\n", macro, (unsigned long)(t->period_us / 1000u));
+        fprintf(out, "#define TASK_%s_DEADLINE_MS %luu\n", macro, (unsigned long)(rta_deadline(t) / 1000u));
+        fprintf(out, "#define TASK_%s_WCET_US %luu\n", macro, (unsigned long)t->wcet_us);
+        fprintf(out, "#define TASK_%s_PRIORITY %luu\n", macro, (unsigned long)t->priority);
+        fprintf(out, "#define TASK_%s_WCRT_US %luu\n", macro, (unsigned long)response_us[i]);
+    }
+    fprintf(out, "\n#endif /* TASKSET_H */\n");
+}
+
+/**
+ * @brief Checks the table with rate- or deadline-monotonic priorities instead
+ *        of the declared ones.
+ */
+static bool schedulable_with(const tasktable_t *table, rta_policy_t policy) {
+    rta_task_t tasks[TASKTABLE_MAX_TASKS];
+    uint32_t response_us[TASKTABLE_MAX_TASKS];
+
+    memcpy(tasks, table->tasks, table->count * sizeof(tasks[0]));
+    rta_assign_priorities(tasks, table->count, policy, 1);
+    return rta_response_times(tasks, table->count, response_us);
+}
+
+static void usage(const char *name) {
+    fprintf(stderr,
+            "usage: %s [options] tasks.csv\n"
+            "  -a rm|dm  replace the declared priorities by rate/deadline-monotonic ones\n"
+            "  -m log    seed the WCETs from the budget report of a firmware log\n"
+            "  -f pct    margin on measured WCETs (default 20)\n"
+            "  -w file   write the (seeded) table\n"
+            "  -H file   write the task macros as C header\n"
+            "  -q        print only failures\n",
+            name);
+}
+
+int main(int argc, char *argv[]) {
+    static measured_t measured;
+    tasktable_t *const table = &measured.table;
+    uint32_t response_us[TASKTABLE_MAX_TASKS];
+    const char *log_path = NULL, *table_out = NULL, *header_out = NULL;
+    unsigned long margin = 20;
+    int assign = -1;
+    bool quiet = false, feasible;
+    double utilization, bound;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "a:m:f:w:H:qh")) != -1) {
+        switch (opt) {
+        case 'a':
+            if (strcmp(optarg, "rm") == 0) {
+                assign = RTA_RATE_MONOTONIC;
+            } else if (strcmp(optarg, "dm") == 0) {
+                assign = RTA_DEADLINE_MONOTONIC;
+            } else {
+                usage(argv[0]);
+                return 2;
+            }
+            break;
+        case 'm':
+            log_path = optarg;
+            break;
+        case 'f':
+            margin = strtoul(optarg, NULL, 0);
+            break;
+        case 'w':
+            table_out = optarg;
+            break;
+        case 'H':
+            header_out = optarg;
+            break;
+        case 'q':
+            quiet = true;
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (tasktable_read(argv[optind], table) != 0) {
+        return 2;
+    }
+
+    if (log_path != NULL) {
+        if (read_measurements(log_path, &measured) != 0) {
+            return 2;
+        }
+        for (size_t i = 0; i < table->count; i++) {
+            if (measured.measured_us[i] != 0) {
+                uint32_t seeded = (uint32_t)(measured.measured_us[i] * (100u + margin) / 100u);
+
+                printf("%-12s WCET %lu us -> %lu us (measured %lu us + %lu %%)\n", table->names[i],
+                       (unsigned long)table->tasks[i].wcet_us, (unsigned long)seeded,
+                       (unsigned long)measured.measured_us[i], margin);
+                table->tasks[i].wcet_us = seeded;
+            } else {
+                printf("%-12s not in the log, WCET %lu us kept\n", table->names[i],
+                       (unsigned long)table->tasks[i].wcet_us);
+            }
+        }
+    }
+    if (assign >= 0) {
+        uint32_t lowest = UINT32_MAX;
+
+        /* Keep the band of the declared priorities */
+        for (size_t i = 0; i < table->count; i++) {
+            lowest = (table->tasks[i].priority < lowest) ? table->tasks[i].priority : lowest;
+        }
+        rta_assign_priorities(table->tasks, table->count, (rta_policy_t)assign, lowest);
+    }
+
+    feasible = rta_response_times(table->tasks, table->count, response_us);
+    utilization = rta_utilization(table->tasks, table->count);
+    bound = rta_rm_bound(table->count);
+
+    if (!quiet || !feasible) {
+        printf("%-12s %8s %8s %8s %8s %4s %8s %8s\n", "Task", "T (ms)", "C (us)", "D (ms)", "B (us)",
+               "Prio", "R (us)", "Slack");
+        for (size_t i = 0; i < table->count; i++) {
+            const rta_task_t *t = &table->tasks[i];
+            uint32_t deadline = rta_deadline(t);
+            char slack[16] = "MISS";
+
+            if (response_us[i] <= deadline) {
+                snprintf(slack, sizeof(slack), "%lu", (unsigned long)(deadline - response_us[i]));
+            }
+            printf("%-12s %8lu %8lu %8lu %8lu %4lu %8lu %8s\n", t->name,
+                   (unsigned long)(t->period_us / 1000u), (unsigned long)t->wcet_us,
+                   (unsigned long)(deadline / 1000u), (unsigned long)t->blocking_us,
+                   (unsigned long)t->priority, (unsigned long)response_us[i], slack);
+        }
+        printf("Utilisation %.1f %% (rate-monotonic bound %.1f %% for %zu tasks)\n", utilization * 100.0,
+               bound * 100.0, table->count);
+        printf("RM priorities: %s, DM priorities: %s\n",
+               schedulable_with(table, RTA_RATE_MONOTONIC) ? "schedulable" : "unschedulable",
+               schedulable_with(table, RTA_DEADLINE_MONOTONIC) ? "schedulable" : "unschedulable");
+        printf("%s: %s\n", argv[optind], feasible ? "schedulable" : "UNSCHEDULABLE");
+    }
+
+    if (table_out != NULL) {
+        FILE *out = fopen(table_out, "w");
+
+        if (out == NULL) {
+            perror(table_out);
+            return 2;
+        }
+        tasktable_write(out, table);
+        fclose(out);
+    }
+    if (header_out != NULL) {
+        FILE *out = fopen(header_out, "w");
+
+        if (out == NULL) {
+            perror(header_out);
+            return 2;
+        }
+        write_header(out, argv[optind], table, response_us);
+        fclose(out);
+    }
+    return feasible ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file seqlock_stress.c
+ *
+ * @brief Host stress test of seqlock.c through the blackboard.
+ *
+ *     seqlock_stress [writes]
+ *
+ * One writer thread publishes the control and vehicle sections of a
+ * blackboard (default 2000000 times each), three reader threads copy them
+ * as fast as they can. Every field of write n is derived from n, so a
+ * reader can tell a torn snapshot (fields of different writes) and checks
+ * that the generation equals n and never goes backwards. Exit code 1 on a
+ * torn or out-of-order read.
+ *
+ * The readers are preempted in the middle of their copies by the writer
+ * even on a single core, which is the case the two copies are made for.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "blackboard.h"
+
+#define NUM_READERS     3
+#define DEFAULT_WRITES  2000000u
+
+static blackboard_t bb;
+static uint32_t num_writes = DEFAULT_WRITES;
+static atomic_bool done;
+
+/**
+ * @brief Result of one reader.
+ */
+typedef struct {
+    uint64_t reads;
+    uint64_t torn;
+    uint64_t out_of_order;
+    uint64_t wrong_generation;
+} reader_result_t;
+
+static bb_control_t control_value(uint32_t n) {
+    bb_control_t c = {
+        .throttle = (uint16_t)(n % 81u),
+        .target_velocity = (uint16_t)n,
+        .cruise_active = (n & 1u) != 0,
+        .gas_tag = n,
+        .brake_tag = ~n,
+    };
+    return c;
+}
+
+static bb_vehicle_t vehicle_value(uint32_t n) {
+    bb_vehicle_t v = {
+        .velocity = (uint16_t)n,
+        .position = (uint16_t)(n >> 16),
+    };
+    return v;
+}
+
+static void *writer(void *arg) {
+    (void)arg;
+
+    for (uint32_t n = 1; n <= num_writes; n++) {
+        bb_control_t c = control_value(n);
+        bb_vehicle_t v = vehicle_value(n);
+
+        blackboard_write_control(&bb, &c);
+        blackboard_write_vehicle(&bb, &v);
+    }
+    atomic_store(&done, true);
+    return NULL;
+}
+
+static void *reader(void *arg) {
+    reader_result_t *r = arg;
+    uint32_t last_control = 0;
+    uint32_t last_vehicle = 0;
+
+    while (!atomic_load(&done)) {
+        bb_control_t c;
+        bb_vehicle_t v;
+        uint32_t gen;
+
+        /* Control: gas_tag is the write number, every other field must match it */
+        gen = blackboard_read_control(&bb, &c);
+        if (gen > 0) {
+            bb_control_t expected = control_value(c.gas_tag);
+
+            if ((c.throttle != expected.throttle) || (c.target_velocity != expected.target_velocity) ||
+                (c.cruise_active != expected.cruise_active) || (c.brake_tag != expected.brake_tag)) {
+                r->torn++;
+            }
+            if (gen != c.gas_tag) {
+                r->wrong_generation++;
+            }
+        }
+        if (gen < last_control) {
+            r->out_of_order++;
+        }
+        last_control = gen;
+
+        /* Vehicle: the two 16-bit halves of the write number */
+        gen = blackboard_read_vehicle(&bb, &v);
+        if ((gen > 0) && (((uint32_t)v.position << 16 | v.velocity) != gen)) {
+            r->torn++;
+        }
+        if (gen < last_vehicle) {
+            r->out_of_order++;
+        }
+        last_vehicle = gen;
+
+        r->reads += 2;
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    pthread_t writer_thread;
+    pthread_t reader_threads[NUM_READERS];
+    reader_result_t results[NUM_READERS] = {0};
+    uint64_t reads = 0;
+    uint64_t errors = 0;
+
+    if (argc > 1) {
+        num_writes = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+
+    blackboard_init(&bb);
+    for (int i = 0; i < NUM_READERS; i++) {
+        pthread_create(&reader_threads[i], NULL, reader, &results[i]);
+    }
+    pthread_create(&writer_thread, NULL, writer, NULL);
+
+    pthread_join(writer_thread, NULL);
+    for (int i = 0; i < NUM_READERS; i++) {
+        pthread_join(reader_threads[i], NULL);
+    }
+
+    for (int i = 0; i < NUM_READERS; i++) {
+        const reader_result_t *r = &results[i];
+
+        printf("Reader %d: %llu reads, %llu torn, %llu out of order, %llu wrong generation\n", i,
+               (unsigned long long)r->reads, (unsigned long long)r->torn,
+               (unsigned long long)r->out_of_order, (unsigned long long)r->wrong_generation);
+        reads += r->reads;
+        errors += r->torn + r->out_of_order + r->wrong_generation;
+    }
+    printf("seqlock_stress: %u writes per section, %llu reads, %llu errors\n",
+           num_writes, (unsigned long long)reads, (unsigned long long)errors);
+
+    return (errors > 0) ? 1 : 0;
+}
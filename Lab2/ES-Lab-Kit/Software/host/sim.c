@@ -0,0 +1,353 @@
+/**
+ * @file sim.c
+ *
+ * @brief Faster-than-real-time simulation of the cruise-control tasks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+#define TRACK_LENGTH        24000u
+#define TRACK_MIN_SEGMENT   4000u
+
+static terrain_map_t lab_track;
+static uint16_t lab_track_index[TERRAIN_INDEX_LEN(TRACK_LENGTH, TRACK_MIN_SEGMENT)];
+
+/**
+ * @brief The simulated tasks.
+ */
+typedef enum {
+    JOB_BUTTON,
+    JOB_VEHICLE,
+    JOB_CONTROL,
+    JOBS
+} job_t;
+
+void sim_config_lab(sim_config_t *config) {
+    if (lab_track.segments == NULL) {
+        terrain_init(&lab_track, terrain_lab_track, terrain_lab_track_count, TRACK_LENGTH,
+                     lab_track_index, sizeof(lab_track_index) / sizeof(lab_track_index[0]));
+    }
+
+    config->control = cruise_control_lab;
+    config->vehicle.track = &lab_track;
+    config->vehicle.substep_us = 0;
+    config->button_period_ms = 50;
+    config->control_period_ms = 200;
+    config->vehicle_period_ms = 100;
+    config->queues = false;
+    config->record = NULL;
+}
+
+/**
+ * @brief Parses an input name.
+ */
+static int parse_input(const char *name, sim_input_t *input) {
+    static const char *const names[] = { "gas", "brake", "cruise", "stall", "end" };
+
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++) {
+        if (strcmp(name, names[i]) == 0) {
+            *input = (sim_input_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int sim_script_load(const char *path, sim_script_t *script) {
+    FILE *file = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+    char line[256];
+    size_t capacity = 0;
+    unsigned lineno = 0;
+    bool ended = false;
+
+    memset(script, 0, sizeof(*script));
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char name[16];
+        unsigned long time_ms;
+        int level = 0;
+        int fields;
+        sim_event_t event;
+
+        lineno++;
+        line[strcspn(line, "#\r\n")] = '\0';
+        fields = sscanf(line, "%lu %15s %d", &time_ms, name, &level);
+        if (fields <= 0) {
+            continue;   /* blank or comment */
+        }
+        if ((fields < 2) || (parse_input(name, &event.input) != 0) ||
+            ((event.input != SIM_END) && (fields != 3)) || (level < 0) || (level > 1)) {
+            fprintf(stderr, "%s:%u: expected \"<time_ms> gas|brake|cruise|stall 0|1\" or \"<time_ms> end\"\n",
+                    path, lineno);
+            goto fail;
+        }
+        if (ended || ((script->count > 0) && (time_ms < script->events[script->count - 1].time_ms))) {
+            fprintf(stderr, "%s:%u: events must be sorted by time and end with \"end\"\n", path, lineno);
+            goto fail;
+        }
+
+        event.time_ms = (uint32_t)time_ms;
+        event.pressed = (level != 0);
+        if (event.input == SIM_END) {
+            script->end_ms = event.time_ms;
+            ended = true;
+            continue;
+        }
+
+        if (script->count == capacity) {
+            sim_event_t *events;
+
+            capacity = (capacity == 0) ? 64 : 2 * capacity;
+            events = realloc(script->events, capacity * sizeof(*events));
+            if (events == NULL) {
+                perror("realloc");
+                goto fail;
+            }
+            script->events = events;
+        }
+        script->events[script->count++] = event;
+    }
+
+    if (!ended) {
+        fprintf(stderr, "%s: missing \"<time_ms> end\"\n", path);
+        goto fail;
+    }
+    if (file != stdin) {
+        fclose(file);
+    }
+    return 0;
+
+fail:
+    if (file != stdin) {
+        fclose(file);
+    }
+    sim_script_free(script);
+    return -1;
+}
+
+int sim_recording_load(const char *path, inputrec_block_t **blocks, size_t *count) {
+    FILE *file = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+    size_t capacity = 0;
+    char line[2 * INPUTREC_BLOCK_SIZE + 64];
+    int result = 0;
+
+    *blocks = NULL;
+    *count = 0;
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (*count == capacity) {
+            inputrec_block_t *more;
+
+            capacity = (capacity == 0) ? 64 : 2 * capacity;
+            more = realloc(*blocks, capacity * sizeof(*more));
+            if (more == NULL) {
+                perror("realloc");
+                result = -1;
+                break;
+            }
+            *blocks = more;
+        }
+        if (inputrec_parse_line(line, &(*blocks)[*count])) {
+            if ((*count > 0) && ((*blocks)[*count].seq != (*blocks)[*count - 1].seq + 1u)) {
+                fprintf(stderr, "%s: block %lu follows block %lu, lines missing?\n", path,
+                        (unsigned long)(*blocks)[*count].seq, (unsigned long)(*blocks)[*count - 1].seq);
+                result = -1;
+                break;
+            }
+            (*count)++;
+        }
+    }
+
+    if ((result == 0) && (*count == 0)) {
+        fprintf(stderr, "%s: no \"IR\" blocks found\n", path);
+        result = -1;
+    }
+    if (file != stdin) {
+        fclose(file);
+    }
+    if (result != 0) {
+        free(*blocks);
+        *blocks = NULL;
+        *count = 0;
+    }
+    return result;
+}
+
+int sim_script_load_recording(const char *path, uint32_t button_period_ms, sim_script_t *script) {
+    inputrec_block_t *blocks;
+    inputrec_reader_t reader;
+    inputrec_frame_t frame;
+    size_t count, capacity = 0;
+
+    memset(script, 0, sizeof(*script));
+    if (sim_recording_load(path, &blocks, &count) != 0) {
+        return -1;
+    }
+
+    inputrec_reader_init_blocks(&reader, blocks, (uint32_t)count);
+    while (inputrec_read(&reader, &frame)) {
+        if (script->sample_count == capacity) {
+            uint32_t *more;
+
+            capacity = (capacity == 0) ? 1024 : 2 * capacity;
+            more = realloc(script->samples, capacity * sizeof(*more));
+            if (more == NULL) {
+                perror("realloc");
+                free(blocks);
+                sim_script_free(script);
+                return -1;
+            }
+            script->samples = more;
+        }
+        script->samples[script->sample_count++] = frame.inputs;
+    }
+    free(blocks);
+
+    script->end_ms = (uint32_t)(script->sample_count * button_period_ms);
+    return 0;
+}
+
+void sim_script_free(sim_script_t *script) {
+    free(script->samples);
+    free(script->events);
+    memset(script, 0, sizeof(*script));
+}
+
+sim_result_t sim_run(const sim_config_t *config, const sim_script_t *script,
+                     sim_sample_fn sample, void *arg) {
+    const uint32_t period[JOBS] = {
+        [JOB_BUTTON] = config->button_period_ms,
+        [JOB_VEHICLE] = config->vehicle_period_ms,
+        [JOB_CONTROL] = config->control_period_ms,
+    };
+    uint64_t release[JOBS] = { 0 };
+    job_t order[JOBS] = { JOB_BUTTON, JOB_VEHICLE, JOB_CONTROL };
+    sim_result_t result = { 0 };
+
+    /* Raw button levels, active-low like the lab kit; stall is inverted the same way */
+    bool raw[SIM_END] = { true, true, true, true };
+    size_t next_event = 0;
+    size_t next_sample = 0;
+
+    cruise_buttons_t buttons;
+    cruise_pedals_t pedals = { 0 };
+    cruise_control_t control;
+    cruise_vehicle_t vehicle;
+    uint32_t vehicle_gen = 0;
+    uint32_t control_gen = 0;
+
+    /* Rate-monotonic priorities, ties in the order of the lab */
+    for (int i = 1; i < JOBS; i++) {
+        for (int j = i; (j > 0) && (period[order[j]] < period[order[j - 1]]); j--) {
+            job_t tmp = order[j];
+
+            order[j] = order[j - 1];
+            order[j - 1] = tmp;
+        }
+    }
+
+    cruise_buttons_init(&buttons, raw[SIM_CRUISE]);
+    cruise_control_init(&control);
+    cruise_vehicle_init(&vehicle, 0, 0);
+
+    for (;;) {
+        uint64_t now = release[0];
+
+        for (int i = 1; i < JOBS; i++) {
+            if (release[i] < now) {
+                now = release[i];
+            }
+        }
+        if (now >= script->end_ms) {
+            break;
+        }
+
+        /* Inputs changed up to now, as seen by the next button sample */
+        while ((next_event < script->count) && (script->events[next_event].time_ms <= now)) {
+            const sim_event_t *event = &script->events[next_event++];
+
+            raw[event->input] = !event->pressed;
+        }
+
+        for (int i = 0; i < JOBS; i++) {
+            job_t job = order[i];
+
+            if (release[job] != now) {
+                continue;
+            }
+            release[job] += period[job];
+            result.jobs++;
+
+            switch (job) {
+            case JOB_BUTTON:
+                if (script->samples != NULL) {
+                    uint32_t inputs = (next_sample < script->sample_count)
+                                      ? script->samples[next_sample++] : UINT32_MAX;
+
+                    raw[SIM_GAS] = (inputs >> INPUTREC_SW_7) & 1u;
+                    raw[SIM_BRAKE] = (inputs >> INPUTREC_SW_5) & 1u;
+                    raw[SIM_CRUISE] = (inputs >> INPUTREC_SW_6) & 1u;
+                }
+                if (config->record != NULL) {
+                    const inputrec_frame_t frame = {
+                        .time_ms = (uint32_t)now,
+                        .inputs = ((uint32_t)raw[SIM_GAS] << INPUTREC_SW_7) |
+                                  ((uint32_t)raw[SIM_BRAKE] << INPUTREC_SW_5) |
+                                  ((uint32_t)raw[SIM_CRUISE] << INPUTREC_SW_6) |
+                                  (1u << INPUTREC_SW_8),
+                    };
+
+                    inputrec_add(config->record, &frame);
+                }
+                cruise_buttons_step(&buttons, raw[SIM_GAS], raw[SIM_BRAKE], raw[SIM_CRUISE], &pedals);
+                break;
+
+            case JOB_CONTROL:
+                cruise_control_step(&config->control, &control, &pedals, vehicle.velocity,
+                                    config->queues ? 0 : vehicle.position,
+                                    config->queues || (vehicle_gen != control_gen));
+                control_gen = vehicle_gen;
+                break;
+
+            case JOB_VEHICLE:
+                if (!raw[SIM_STALL]) {
+                    break;      /* Starved, the job never runs */
+                }
+                cruise_vehicle_step(&config->vehicle, &vehicle, control.throttle, pedals.brake,
+                                    (uint16_t)period[JOB_VEHICLE]);
+                vehicle_gen++;
+                if (sample != NULL) {
+                    const sim_sample_t s = {
+                        .time_ms = (uint32_t)now,
+                        .pedals = pedals,
+                        .throttle = control.throttle,
+                        .velocity = vehicle.velocity,
+                        .position = vehicle.position,
+                        .target_velocity = control.target_velocity,
+                        .cruise_active = control.cruise_active,
+                    };
+
+                    sample(&s, arg);
+                }
+                result.samples++;
+                break;
+
+            default:
+                break;
+            }
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file sim.h
+ *
+ * @brief Faster-than-real-time simulation of the cruise-control tasks.
+ *
+ * Runs the Button, Control and Vehicle jobs of cruise_core.h at their
+ * periods in simulated time. Jobs released at the same millisecond run in
+ * rate-monotonic order (Button, Vehicle, Control), as on the target with
+ * zero execution time. Time jumps directly to the next release or input
+ * change, so one job costs a few hundred nanoseconds on the host.
+ *
+ * Inputs come from a script with one change per line:
+ *
+ *     # time[ms] input level
+ *     0       gas     1
+ *     20000   gas     0
+ *     20000   cruise  1
+ *     20200   cruise  0
+ *     60000   brake   1
+ *     65000   end
+ *
+ * The inputs are gas, brake and cruise with level 1 for pressed; the
+ * Button task samples the levels, so a press shorter than its period can
+ * be missed as on the lab kit. While stall is 1 the Vehicle jobs are lost,
+ * as when the Vehicle task is starved; Control then sees no new velocity.
+ * "end" sets the length of the run.
+ *
+ * Instead of a script, the inputs can come from a recording of the
+ * firmware or of an earlier run (see inputrec.h), one sample per Button
+ * job; the run then gives exactly the recorded trajectory.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cruise_core.h"
+#include "inputrec.h"
+
+/**
+ * @brief Simulated inputs.
+ */
+typedef enum {
+    SIM_GAS,
+    SIM_BRAKE,
+    SIM_CRUISE,
+    SIM_STALL,              /* Vehicle task starved, e.g. by an overload */
+    SIM_END
+} sim_input_t;
+
+/**
+ * @brief One input change.
+ */
+typedef struct {
+    uint32_t time_ms;
+    sim_input_t input;
+    bool pressed;
+} sim_event_t;
+
+/**
+ * @brief Input timeline, sorted by time, or recorded samples.
+ */
+typedef struct {
+    sim_event_t *events;
+    size_t count;
+    uint32_t end_ms;        /* Length of the run */
+    uint32_t *samples;      /* Raw inputs per Button job (INPUTREC_SW_x bits), replace the events */
+    size_t sample_count;
+} sim_script_t;
+
+/**
+ * @brief Simulation parameters.
+ */
+typedef struct {
+    cruise_control_config_t control;
+    cruise_vehicle_config_t vehicle;
+    uint32_t button_period_ms;
+    uint32_t control_period_ms;
+    uint32_t vehicle_period_ms;
+    bool queues;            /* Control as in the queue projects: position 0, velocity always fresh */
+    inputrec_t *record;     /* Records every Button sample, or NULL */
+} sim_config_t;
+
+/**
+ * @brief State after a Vehicle job.
+ */
+typedef struct {
+    uint32_t time_ms;
+    cruise_pedals_t pedals;
+    uint16_t throttle;
+    uint16_t velocity;          /* 0.1 m/s */
+    uint16_t position;          /* 0.1 m */
+    uint16_t target_velocity;   /* 0.1 m/s */
+    bool cruise_active;
+} sim_sample_t;
+
+/**
+ * @brief Receives every sample of a run.
+ */
+typedef void (*sim_sample_fn)(const sim_sample_t *sample, void *arg);
+
+/**
+ * @brief Result of a run.
+ */
+typedef struct {
+    uint64_t jobs;          /* Button, Control and Vehicle jobs */
+    uint64_t samples;
+} sim_result_t;
+
+/**
+ * @brief Sets the lab configuration: cruise_control_lab, lab physics on
+ *        the lab track, periods 50/200/100 ms, blackboard wiring of
+ *        CruiseControlOverload.
+ *
+ * @param config Configuration to fill.
+ */
+void sim_config_lab(sim_config_t *config);
+
+/**
+ * @brief Reads a script.
+ *
+ * @param path File name, "-" for stdin.
+ * @param script Script, free with sim_script_free().
+ * @return int 0, or -1 after printing the error to stderr.
+ */
+int sim_script_load(const char *path, sim_script_t *script);
+
+/**
+ * @brief Reads the blocks of a recording printed by inputrec_dump(); other
+ *        lines, e.g. the rest of the UART log, are skipped.
+ *
+ * @param path File name, "-" for stdin.
+ * @param blocks Blocks, oldest first, free with free().
+ * @param count Number of blocks.
+ * @return int 0, or -1 after printing the error to stderr.
+ */
+int sim_recording_load(const char *path, inputrec_block_t **blocks, size_t *count);
+
+/**
+ * @brief Reads a recording as script, see sim_recording_load().
+ *
+ * @param path File name, "-" for stdin.
+ * @param button_period_ms Button period of the recording, sets the length.
+ * @param script Script, free with sim_script_free().
+ * @return int 0, or -1 after printing the error to stderr.
+ */
+int sim_script_load_recording(const char *path, uint32_t button_period_ms, sim_script_t *script);
+
+/**
+ * @brief Frees a script.
+ */
+void sim_script_free(sim_script_t *script);
+
+/**
+ * @brief Runs a script from time 0 with the vehicle at rest.
+ *
+ * @param config Simulation parameters.
+ * @param script Inputs.
+ * @param sample Called after every Vehicle job, or NULL.
+ * @param arg Passed to sample.
+ * @return sim_result_t Counters.
+ */
+sim_result_t sim_run(const sim_config_t *config, const sim_script_t *script,
+                     sim_sample_fn sample, void *arg);
+
+#endif /* SIM_H */
@@ -0,0 +1,95 @@
+/**
+ * @file tasktable.c
+ *
+ * @brief Task table of a firmware project (tasks.csv).
+ */
+
+#include <ctype.h>
+#include <string.h>
+#include "tasktable.h"
+
+static char *trim(char *s) {
+    char *end;
+
+    while (isspace((unsigned char)*s)) {
+        s++;
+    }
+    end = s + strlen(s);
+    while ((end > s) && isspace((unsigned char)end[-1])) {
+        *--end = '\0';
+    }
+    return s;
+}
+
+int tasktable_read(const char *path, tasktable_t *table) {
+    FILE *in = fopen(path, "r");
+    char line[256];
+    unsigned number = 0;
+
+    if (in == NULL) {
+        perror(path);
+        return -1;
+    }
+    table->count = 0;
+    table->comment[0] = '\0';
+    while (fgets(line, sizeof(line), in) != NULL) {
+        char name[TASKTABLE_NAME_LENGTH];
+        unsigned long period_ms, wcet_us, deadline_ms, priority, blocking_us;
+        char *p = trim(line);
+
+        number++;
+        if ((*p == '#') && (table->count == 0) &&
+            (strlen(table->comment) + strlen(p) + 2 <= sizeof(table->comment))) {
+            strcat(strcat(table->comment, p), "\n");
+        }
+        if ((*p == '\0') || (*p == '#')) {
+            continue;
+        }
+        if ((sscanf(p, "%31[^,], %lu , %lu , %lu , %lu , %lu", name, &period_ms, &wcet_us,
+                    &deadline_ms, &priority, &blocking_us) != 6) || (period_ms == 0)) {
+            fprintf(stderr, "%s:%u: expected name, period_ms, wcet_us, deadline_ms, priority, blocking_us\n",
+                    path, number);
+            fclose(in);
+            return -1;
+        }
+        if (table->count == TASKTABLE_MAX_TASKS) {
+            fprintf(stderr, "%s: more than %d tasks\n", path, TASKTABLE_MAX_TASKS);
+            fclose(in);
+            return -1;
+        }
+        strcpy(table->names[table->count], trim(name));
+        table->tasks[table->count] = (rta_task_t){
+            .name = table->names[table->count],
+            .period_us = (uint32_t)(period_ms * 1000u),
+            .wcet_us = (uint32_t)wcet_us,
+            .deadline_us = (uint32_t)(deadline_ms * 1000u),
+            .blocking_us = (uint32_t)blocking_us,
+            .priority = (uint32_t)priority,
+        };
+        table->count++;
+    }
+    fclose(in);
+    return 0;
+}
+
+void tasktable_write(FILE *out, const tasktable_t *table) {
+    fputs((table->comment[0] != '\0') ? table->comment
+                                      : "# name, period_ms, wcet_us, deadline_ms, priority, blocking_us\n", out);
+    for (size_t i = 0; i < table->count; i++) {
+        const rta_task_t *t = &table->tasks[i];
+
+        fprintf(out, "%s, %lu, %lu, %lu, %lu, %lu\n", t->name, (unsigned long)(t->period_us / 1000u),
+                (unsigned long)t->wcet_us, (unsigned long)(t->deadline_us / 1000u),
+                (unsigned long)t->priority, (unsigned long)t->blocking_us);
+    }
+}
+
+const char *tasktable_macro(const char *name, char *macro) {
+    size_t n = 0;
+
+    for (const char *p = name; (*p != '\0') && (n < TASKTABLE_NAME_LENGTH - 1); p++) {
+        macro[n++] = isalnum((unsigned char)*p) ? (char)toupper((unsigned char)*p) : '_';
+    }
+    macro[n] = '\0';
+    return macro;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file tasktable.h
+ *
+ * @brief Task table of a firmware project (tasks.csv), shared by the host
+ *        tools rta_check and cyclic_gen.
+ *
+ * The table has one line per periodic task:
+ *
+ *     # name, period_ms, wcet_us, deadline_ms, priority, blocking_us
+ *     Button,  50, 1000, 0, 7, 0
+ *
+ * A deadline of 0 is the period, priorities are FreeRTOS priorities. Empty
+ * lines and lines starting with # are skipped; the comment lines before the
+ * first task are kept for tasktable_write().
+ */
+
+#ifndef TASKTABLE_H
+#define TASKTABLE_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include "rta.h"
+
+#define TASKTABLE_MAX_TASKS         32
+#define TASKTABLE_NAME_LENGTH       32
+
+/**
+ * @brief Task table with the storage of the names.
+ */
+typedef struct {
+    rta_task_t tasks[TASKTABLE_MAX_TASKS];
+    char names[TASKTABLE_MAX_TASKS][TASKTABLE_NAME_LENGTH];
+    size_t count;
+    char comment[1024];                     /* Comment lines before the first task */
+} tasktable_t;
+
+/**
+ * @brief Reads a table, reports errors on stderr.
+ *
+ * @param path File to read.
+ * @param table Table, written.
+ * @return int 0, or -1 on a read or syntax error.
+ */
+int tasktable_read(const char *path, tasktable_t *table);
+
+/**
+ * @brief Writes a table in the format read by tasktable_read().
+ *
+ * @param out Output stream.
+ * @param table Table.
+ */
+void tasktable_write(FILE *out, const tasktable_t *table);
+
+/**
+ * @brief Converts a task name to a macro name: upper case, anything but
+ *        letters and digits becomes '_'.
+ *
+ * @param name Task name.
+ * @param macro Output buffer of TASKTABLE_NAME_LENGTH characters.
+ * @return const char* macro.
+ */
+const char *tasktable_macro(const char *name, char *macro);
+
+#endif /* TASKTABLE_H */
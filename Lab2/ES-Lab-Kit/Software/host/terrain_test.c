@@ -0,0 +1,126 @@
+/**
+ * @file terrain_test.c
+ *
+ * @brief Host test of the track map of terrain.h.
+ *
+ * - terrain_lab_track gives the grade of the lab's if-chain at every
+ *   position 0..24000 the lab's adjust_position() can produce, including
+ *   24000 itself, which is still on the steep downhill.
+ * - On random tracks of up to 3000 segments, the indexed lookup finds the
+ *   same segment as a linear search at every position.
+ *
+ * Exit code 1 if a check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "terrain.h"
+
+#define LAB_LENGTH      24000
+#define MAX_SEGMENTS    3000
+#define RANDOM_TRACKS   200
+
+static int failures;
+
+/**
+ * @brief Retardation by the slope as in the lab's vVehicleTask().
+ */
+static int lab_grade(uint16_t position) {
+    if (position < 4000) {
+        return 0;
+    } else if (position < 8000) {
+        return 8;
+    } else if (position < 12000) {
+        return 16;
+    } else if (position < 16000) {
+        return 0;
+    } else if (position < 20000) {
+        return -8;
+    }
+    return -16;
+}
+
+static void test_lab_track(void) {
+    static uint16_t index[TERRAIN_INDEX_LEN(LAB_LENGTH, 4000)];
+    terrain_map_t map;
+
+    if (!terrain_init(&map, terrain_lab_track, terrain_lab_track_count, LAB_LENGTH,
+                      index, sizeof(index) / sizeof(index[0]))) {
+        printf("terrain_test.c: terrain_init() failed for the lab track\n");
+        failures++;
+        return;
+    }
+
+    for (uint32_t position = 0; position <= LAB_LENGTH; position++) {
+        int grade = terrain_at(&map, (uint16_t)position)->grade;
+
+        if (grade != lab_grade((uint16_t)position)) {
+            printf("terrain_test.c: lab track at %lu: grade %d, expected %d\n",
+                   (unsigned long)position, grade, lab_grade((uint16_t)position));
+            failures++;
+        }
+    }
+
+    /* Beyond the length the position wraps */
+    if (terrain_segment_at(&map, LAB_LENGTH + 1) != 0) {
+        printf("terrain_test.c: lab track at %u: no wrap to segment 0\n", LAB_LENGTH + 1);
+        failures++;
+    }
+    if (terrain_segment_at(&map, LAB_LENGTH + 8000) != 2) {
+        printf("terrain_test.c: lab track at %u: no wrap to segment 2\n", LAB_LENGTH + 8000);
+        failures++;
+    }
+}
+
+static void test_random_tracks(void) {
+    static terrain_segment_t segments[MAX_SEGMENTS];
+    static uint16_t index[UINT16_MAX];
+    terrain_map_t map;
+
+    srand(2206);
+    for (int t = 0; t < RANDOM_TRACKS; t++) {
+        uint16_t count = (uint16_t)(1 + rand() % MAX_SEGMENTS);
+        uint16_t length = (uint16_t)(count + rand() % (65535 - count));
+        uint16_t step = length / count;
+
+        /* One start in every step-wide slice, so the table is sorted */
+        for (uint16_t i = 0; i < count; i++) {
+            segments[i].start = (i == 0) ? 0 : (uint16_t)(i * step + rand() % step);
+            segments[i].grade = (int8_t)i;
+            segments[i].wind = 0;
+        }
+
+        if (!terrain_init(&map, segments, count, length, index, sizeof(index) / sizeof(index[0]))) {
+            printf("terrain_test.c: terrain_init() failed for track %d (%u segments)\n", t, count);
+            failures++;
+            continue;
+        }
+        /* Linear search, advanced with the position */
+        for (uint32_t position = 0, expected = 0; position <= length; position++) {
+            uint16_t seg = terrain_segment_at(&map, (uint16_t)position);
+
+            while ((expected + 1u < count) && (segments[expected + 1].start <= position)) {
+                expected++;
+            }
+
+            if (seg != expected) {
+                printf("terrain_test.c: track %d at %lu: segment %u, expected %lu\n",
+                       t, (unsigned long)position, seg, (unsigned long)expected);
+                failures++;
+                break;
+            }
+        }
+    }
+}
+
+int main(void) {
+    test_lab_track();
+    test_random_tracks();
+
+    if (failures > 0) {
+        printf("terrain_test: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("terrain_test: passed\n");
+    return 0;
+}
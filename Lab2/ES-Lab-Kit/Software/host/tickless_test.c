@@ -0,0 +1,361 @@
+/**
+ * @file tickless_test.c
+ *
+ * @brief Host test of the tickless idle of rtos/tickless.c: one simulated
+ *        hour of periodic tasks must not drift against the timer.
+ *
+ * rtos/tickless.c is built unchanged against the stand-ins in fake/. This
+ * file models the parts of the RP2350 it touches, counted in CPU cycles:
+ * - the SysTick with its reload, current value, enable bit and pending flag,
+ * - the 1 MHz timer and one hardware alarm, from the same crystal as the
+ *   CPU but with an arbitrary phase,
+ * - WFI, which returns on the alarm, the SysTick or another interrupt,
+ * - other interrupts at random times, which end sleeps early,
+ * - the tick count of the kernel with vTaskStepTick() and its assertion
+ *   not to step past the next unblock time.
+ *
+ * Two tasks run with vTaskDelayUntil(): the 2 s step of the Handshake
+ * project and a 50 ms poll, each with a little work per job. Every release
+ * must lie within RELEASE_JITTER_US of first release + n periods, so no
+ * rounding adds up over the sleeps, and the tick count must match the time.
+ *
+ * Exit code 1 if a check fails.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "hardware/structs/scb.h"
+#include "hardware/structs/systick.h"
+#include "tickless.h"
+
+#define CYCLES_PER_US       150u                    /* 150 MHz system clock */
+#define TICK_CYCLES         (CYCLES_PER_US * 1000u) /* SysTick period set up by the port */
+#define TIMER_PHASE         97u                     /* Cycles of the timer's us before cycle 0 */
+#define SIM_SECONDS         3600u
+
+#define WAKE_CYCLES         40u     /* WFI to the first instruction */
+#define TICK_ISR_CYCLES     600u    /* Tick interrupt and context switch to the released task */
+#define IRQ_CYCLES          750u    /* Handler of another interrupt */
+#define IRQ_MEAN_US         40000u  /* Mean time between other interrupts */
+
+/* A tick that falls into another handler is taken after it; rounding that adds up would grow without bound */
+#define RELEASE_JITTER_US   (IRQ_CYCLES / CYCLES_PER_US + 2u)
+
+typedef struct {
+    const char *name;
+    TickType_t period;
+    uint32_t work_us;
+    TickType_t unblock;             /* xLastWakeTime + period */
+    uint64_t first_cycle;
+    uint32_t releases;
+    int64_t min_drift, max_drift;   /* Cycles against first_cycle + releases periods */
+} task_model_t;
+
+static task_model_t tasks[] = {
+    { .name = "poll", .period = pdMS_TO_TICKS(50), .work_us = 40 },    /* Higher priority */
+    { .name = "step", .period = pdMS_TO_TICKS(2000), .work_us = 300 },
+};
+#define TASKS (sizeof(tasks) / sizeof(tasks[0]))
+
+static int failures;
+static uint64_t cyc;
+static uint32_t seed = 12345u;
+
+/* SysTick model */
+static systick_hw_t systick_regs, systick_seen;
+static bool systick_enabled;
+static uint32_t systick_reload;
+static uint64_t systick_next;       /* Cycle of the next interrupt while enabled */
+static uint32_t systick_frozen;     /* Current value while disabled */
+static bool systick_pending;
+static armv8m_scb_hw_t scb_regs, scb_seen;
+
+/* Timer, alarm and other interrupts */
+static uint64_t alarm_cycle = UINT64_MAX;
+static uint64_t irq_cycle;
+static uint32_t irqs;
+
+/* Kernel */
+static TickType_t ticks;
+
+static uint32_t next_random(void) {
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+static void systick_run(void) {
+    if (systick_enabled) {
+        while (systick_next <= cyc) {
+            systick_pending = true;
+            systick_next += (uint64_t)systick_reload + 1u;
+        }
+    }
+}
+
+/**
+ * @brief Applies the register writes of tickless.c since the last access
+ *        and refreshes the values it reads.
+ */
+static void registers_sync(void) {
+    systick_run();
+    if (systick_regs.rvr != systick_seen.rvr) {
+        systick_reload = systick_regs.rvr & 0x00ffffffu;    /* Taken at the next reload */
+    }
+    if (systick_regs.cvr != systick_seen.cvr) {
+        systick_frozen = 0;                                 /* Any write clears it */
+    }
+    if ((systick_regs.csr ^ systick_seen.csr) & M33_SYST_CSR_ENABLE_BITS) {
+        if (systick_regs.csr & M33_SYST_CSR_ENABLE_BITS) {
+            /* A cleared counter reloads on the next cycle, then counts down */
+            systick_next = cyc + ((systick_frozen == 0) ? (uint64_t)systick_reload + 1u : systick_frozen);
+            systick_enabled = true;
+        } else {
+            systick_frozen = (uint32_t)(systick_next - cyc);
+            systick_enabled = false;
+        }
+    }
+    if ((scb_regs.icsr != scb_seen.icsr) && (scb_regs.icsr & M33_ICSR_PENDSTCLR_BITS)) {
+        systick_pending = false;
+    }
+
+    systick_regs.cvr = systick_enabled ? (uint32_t)(systick_next - cyc) : systick_frozen;
+    systick_regs.rvr = systick_reload;
+    systick_regs.csr = systick_enabled ? M33_SYST_CSR_ENABLE_BITS : 0;
+    scb_regs.icsr = systick_pending ? M33_ICSR_PENDSTSET_BITS : 0;
+    systick_seen = systick_regs;
+    scb_seen = scb_regs;
+}
+
+systick_hw_t *fake_systick_hw(void) {
+    registers_sync();
+    return &systick_regs;
+}
+
+armv8m_scb_hw_t *fake_scb_hw(void) {
+    registers_sync();
+    return &scb_regs;
+}
+
+static uint64_t timer_us(void) {
+    return (cyc + TIMER_PHASE) / CYCLES_PER_US;
+}
+
+uint64_t time_us_64(void) {
+    registers_sync();
+    cyc += 8u + next_random() % 4u;    /* The read itself */
+    systick_run();
+    return timer_us();
+}
+
+int hardware_alarm_claim_unused(bool required) {
+    (void)required;
+    return 2;
+}
+
+void hardware_alarm_set_callback(uint alarm_num, hardware_alarm_callback_t callback) {
+    (void)alarm_num;
+    (void)callback;
+}
+
+bool hardware_alarm_set_target(uint alarm_num, absolute_time_t t) {
+    (void)alarm_num;
+    registers_sync();
+    if (t <= timer_us()) {
+        return true;    /* Missed */
+    }
+    alarm_cycle = t * CYCLES_PER_US - TIMER_PHASE;
+    return false;
+}
+
+void hardware_alarm_cancel(uint alarm_num) {
+    (void)alarm_num;
+    alarm_cycle = UINT64_MAX;
+}
+
+uint32_t save_and_disable_interrupts(void) {
+    return 0;   /* Interrupts are only taken in the main loop */
+}
+
+void restore_interrupts(uint32_t status) {
+    (void)status;
+}
+
+void __dsb(void) {
+}
+
+static uint64_t next_event(void) {
+    uint64_t event = irq_cycle;
+
+    if (alarm_cycle < event) {
+        event = alarm_cycle;
+    }
+    if (systick_enabled && (systick_next < event)) {
+        event = systick_next;
+    }
+    return event;
+}
+
+void __wfi(void) {
+    uint64_t event;
+
+    registers_sync();
+    if (systick_pending) {
+        return;
+    }
+    event = next_event();
+    if (event > cyc) {
+        cyc = event + WAKE_CYCLES;
+    }
+    systick_run();
+}
+
+eSleepModeStatus eTaskConfirmSleepModeStatus(void) {
+    return eStandardSleep;
+}
+
+static TickType_t next_unblock(void) {
+    TickType_t unblock = tasks[0].unblock;
+
+    for (size_t i = 1; i < TASKS; i++) {
+        if ((TickType_t)(tasks[i].unblock - ticks) < (TickType_t)(unblock - ticks)) {
+            unblock = tasks[i].unblock;
+        }
+    }
+    return unblock;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return ticks;
+}
+
+void vTaskStepTick(TickType_t xTicksToJump) {
+    /* configASSERT of tasks.c */
+    if ((TickType_t)(next_unblock() - ticks) < xTicksToJump) {
+        printf("tickless_test.c: stepped %lu ticks at tick %lu, past the unblock at %lu\n",
+               (unsigned long)xTicksToJump, (unsigned long)ticks, (unsigned long)next_unblock());
+        failures++;
+    }
+    ticks += xTicksToJump;
+}
+
+BaseType_t xTimerPendFunctionCall(PendedFunction_t xFunctionToPend, void *pvParameter1,
+                                  uint32_t ulParameter2, TickType_t xTicksToWait) {
+    (void)xTicksToWait;
+    xFunctionToPend(pvParameter1, ulParameter2);
+    return pdPASS;
+}
+
+static void schedule_irq(void) {
+    irq_cycle = cyc + (uint64_t)(next_random() % (2u * IRQ_MEAN_US) + 1u) * CYCLES_PER_US;
+}
+
+/**
+ * @brief Runs the released task: records its release against the ideal one,
+ *        does its work and delays until its next release.
+ */
+static void run_job(task_model_t *t) {
+    uint64_t ideal = t->first_cycle + (uint64_t)t->releases * t->period * TICK_CYCLES;
+    int64_t drift;
+
+    if (t->releases == 0) {
+        t->first_cycle = cyc;
+        ideal = cyc;
+    }
+    drift = (int64_t)(cyc - ideal);
+    t->min_drift = (drift < t->min_drift) ? drift : t->min_drift;
+    t->max_drift = (drift > t->max_drift) ? drift : t->max_drift;
+    t->releases++;
+
+    cyc += (uint64_t)t->work_us * CYCLES_PER_US;   /* Ticks during the job stay pending */
+    systick_run();
+    t->unblock += t->period;                        /* vTaskDelayUntil() */
+}
+
+int main(void) {
+    const uint64_t end = (uint64_t)SIM_SECONDS * 1000000u * CYCLES_PER_US;
+    uint64_t tick0;
+
+    /* The port starts the SysTick with the scheduler, at some phase of the timer */
+    cyc = 12345u;
+    systick_reload = TICK_CYCLES - 1u;
+    systick_enabled = true;
+    systick_next = cyc + 777u;
+    registers_sync();
+    tick0 = systick_next - TICK_CYCLES;     /* Tick 0 */
+    for (size_t i = 0; i < TASKS; i++) {
+        tasks[i].unblock = tasks[i].period;
+    }
+    if (tickless_init() != pdPASS) {
+        printf("tickless_test.c: no alarm\n");
+        return 1;
+    }
+    schedule_irq();
+
+    while (cyc < end) {
+        registers_sync();
+        if (systick_pending) {
+            systick_pending = false;
+            ticks++;
+            cyc += TICK_ISR_CYCLES;
+            for (size_t i = 0; i < TASKS; i++) {
+                if (tasks[i].unblock == ticks) {
+                    run_job(&tasks[i]);
+                }
+            }
+            continue;
+        }
+        if (irq_cycle <= cyc) {
+            irqs++;
+            cyc += IRQ_CYCLES;
+            schedule_irq();
+            continue;
+        }
+
+        /* Idle task: tickless sleep if the next release is at least two ticks away */
+        if ((TickType_t)(next_unblock() - ticks) >= 2) {
+            tickless_sleep(next_unblock() - ticks);
+            registers_sync();
+            if (systick_pending || (irq_cycle <= cyc)) {
+                continue;
+            }
+        }
+        __wfi();    /* Idle with the tick running */
+    }
+
+    for (size_t i = 0; i < TASKS; i++) {
+        const task_model_t *t = &tasks[i];
+
+        printf("%s: %lu releases, drift %" PRId64 " .. %" PRId64 " cycles\n", t->name,
+               (unsigned long)t->releases, t->min_drift, t->max_drift);
+        if ((t->max_drift - t->min_drift) > (int64_t)(RELEASE_JITTER_US * CYCLES_PER_US)) {
+            printf("tickless_test.c: %s drifts by %" PRId64 " us\n", t->name,
+                   (t->max_drift - t->min_drift) / CYCLES_PER_US);
+            failures++;
+        }
+        if (t->releases != SIM_SECONDS * 1000u / t->period) {
+            printf("tickless_test.c: %s released %lu times\n", t->name, (unsigned long)t->releases);
+            failures++;
+        }
+    }
+    if ((int64_t)ticks - (int64_t)((cyc - tick0) / TICK_CYCLES) > 1 ||
+        (int64_t)((cyc - tick0) / TICK_CYCLES) - (int64_t)ticks > 1) {
+        printf("tickless_test.c: tick count %lu after %" PRIu64 " tick periods\n", (unsigned long)ticks,
+               (cyc - tick0) / TICK_CYCLES);
+        failures++;
+    }
+    printf("%lu other interrupts\n", (unsigned long)irqs);
+    tickless_report();
+
+    if (failures > 0) {
+        printf("tickless_test: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("tickless_test: passed\n");
+    return 0;
+}
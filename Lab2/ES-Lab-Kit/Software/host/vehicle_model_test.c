@@ -0,0 +1,182 @@
+/**
+ * @file vehicle_model_test.c
+ *
+ * @brief Host test of vehicle_model.c against a double-precision reference.
+ *
+ *     vehicle_model_test [-v]
+ *
+ * A 10-minute drive on the lab track (full, half and low throttle, with
+ * braking phases) is integrated by the model at 1 ms and 10 ms sub-steps,
+ * called once per 100 ms like the Vehicle task, and by a reference in
+ * double precision at 10 us. At every 100 ms the test compares:
+ * - velocity,
+ * - trajectory: the distance travelled since the start,
+ * - energy: the kinetic energy per unit mass, v^2 / 2.
+ *
+ * Exit code 1 if a deviation exceeds its limit. -v prints the deviations,
+ * also those of the lab physics adjust_position()/adjust_velocity(), which
+ * truncates accelerations below 1 m/s^2 per 100 ms and is far off.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "cruise_core.h"
+
+#define TRACK_LENGTH        24000   /* 0.1 m */
+#define PERIOD_MS           100
+#define DRIVE_PERIODS       6000    /* 10 minutes */
+#define REFERENCE_STEP_S    10e-6
+
+/* Limits for both sub-steps, in 0.1 m/s, 0.1 m and (0.1 m/s)^2 / 2 */
+#define MAX_VELOCITY_ERROR  1.1
+#define MAX_DISTANCE_ERROR  20.0
+#define MAX_ENERGY_ERROR    600.0
+
+static const uint32_t substeps_us[] = { 1000, 10000 };
+#define NUM_SUBSTEPS        (sizeof(substeps_us) / sizeof(substeps_us[0]))
+
+/**
+ * @brief Reference state in double precision.
+ */
+typedef struct {
+    double velocity;    /* 0.1 m/s */
+    double position;    /* 0.1 m, 0..TRACK_LENGTH */
+    double distance;    /* 0.1 m since the start */
+} reference_t;
+
+/**
+ * @brief Largest deviations from the reference.
+ */
+typedef struct {
+    double velocity;
+    double distance;
+    double energy;
+} deviation_t;
+
+static terrain_map_t track;
+static uint16_t track_index[TERRAIN_INDEX_LEN(TRACK_LENGTH, 4000)];
+
+/**
+ * @brief Throttle and brake of the drive, a 60 s cycle.
+ */
+static void profile(uint32_t period, uint16_t *throttle, bool *brake) {
+    uint32_t t_s = (period * PERIOD_MS / 1000) % 60;
+
+    *brake = (t_s >= 50) && (t_s < 53);
+    *throttle = (t_s < 20) ? 80 : (t_s < 40) ? 40 : 20;
+}
+
+static void reference_step(reference_t *ref, uint16_t throttle, bool brake, double interval_s) {
+    for (double t = 0; t < interval_s - REFERENCE_STEP_S / 2; t += REFERENCE_STEP_S) {
+        const terrain_segment_t *segment = terrain_at(&track, (uint16_t)ref->position);
+        double a = brake ? -VEHICLE_MODEL_BRAKE
+                         : throttle / 2.0 - (ref->velocity * ref->velocity / 10000 + 1)
+                           - segment->grade - segment->wind;
+        double v1 = ref->velocity + a * REFERENCE_STEP_S;
+        double dp;
+
+        if (v1 < 0) {
+            v1 = 0;
+        }
+        dp = (ref->velocity + v1) / 2 * REFERENCE_STEP_S;
+        ref->velocity = v1;
+        ref->distance += dp;
+        ref->position += dp;
+        if (ref->position >= TRACK_LENGTH) {
+            ref->position -= TRACK_LENGTH;
+        }
+    }
+}
+
+/**
+ * @brief Distance travelled from the previous position, across the wrap.
+ */
+static uint32_t advance(uint32_t previous, uint32_t position, uint32_t length) {
+    return (position >= previous) ? position - previous : position + length - previous;
+}
+
+static void update(deviation_t *dev, double velocity, double distance, const reference_t *ref) {
+    double v_error = fabs(velocity - ref->velocity);
+    double d_error = fabs(distance - ref->distance);
+    double e_error = fabs(velocity * velocity - ref->velocity * ref->velocity) / 2;
+
+    dev->velocity = fmax(dev->velocity, v_error);
+    dev->distance = fmax(dev->distance, d_error);
+    dev->energy = fmax(dev->energy, e_error);
+}
+
+int main(int argc, char **argv) {
+    bool verbose = (argc > 1) && (strcmp(argv[1], "-v") == 0);
+    vehicle_model_t models[NUM_SUBSTEPS];
+    vehicle_state_t states[NUM_SUBSTEPS];
+    double distances[NUM_SUBSTEPS] = {0};
+    deviation_t deviations[NUM_SUBSTEPS] = {0};
+    const cruise_vehicle_config_t lab_config = { .track = &track, .substep_us = 0 };
+    cruise_vehicle_t lab;
+    double lab_distance = 0;
+    deviation_t lab_deviation = {0};
+    reference_t ref = {0};
+    int failures = 0;
+
+    terrain_init(&track, terrain_lab_track, terrain_lab_track_count, TRACK_LENGTH,
+                 track_index, sizeof(track_index) / sizeof(track_index[0]));
+    for (size_t i = 0; i < NUM_SUBSTEPS; i++) {
+        models[i].track = &track;
+        models[i].substep_us = substeps_us[i];
+        vehicle_model_init(&states[i], 0, 0);
+    }
+    cruise_vehicle_init(&lab, 0, 0);
+
+    for (uint32_t period = 0; period < DRIVE_PERIODS; period++) {
+        uint16_t throttle;
+        bool brake;
+
+        profile(period, &throttle, &brake);
+        reference_step(&ref, throttle, brake, PERIOD_MS / 1000.0);
+
+        for (size_t i = 0; i < NUM_SUBSTEPS; i++) {
+            uint32_t previous = states[i].position;
+
+            vehicle_model_step(&models[i], &states[i], throttle, brake, PERIOD_MS * 1000u);
+            distances[i] += advance(previous, states[i].position, (uint32_t)TRACK_LENGTH << 16) / 65536.0;
+            update(&deviations[i], states[i].velocity / 65536.0, distances[i], &ref);
+        }
+
+        {
+            uint16_t previous = lab.position;
+
+            cruise_vehicle_step(&lab_config, &lab, throttle, brake, PERIOD_MS);
+            lab_distance += advance(previous, lab.position, TRACK_LENGTH);
+            update(&lab_deviation, lab.velocity, lab_distance, &ref);
+        }
+    }
+
+    for (size_t i = 0; i < NUM_SUBSTEPS; i++) {
+        const deviation_t *d = &deviations[i];
+        bool ok = (d->velocity <= MAX_VELOCITY_ERROR) && (d->distance <= MAX_DISTANCE_ERROR) &&
+                  (d->energy <= MAX_ENERGY_ERROR);
+
+        if (verbose || !ok) {
+            printf("Sub-step %5lu us: velocity %.3f, distance %.2f, energy %.1f%s\n",
+                   (unsigned long)substeps_us[i], d->velocity, d->distance, d->energy,
+                   ok ? "" : "  FAILED");
+        }
+        if (!ok) {
+            failures++;
+        }
+    }
+    if (verbose) {
+        printf("Lab physics:       velocity %.3f, distance %.2f, energy %.1f\n",
+               lab_deviation.velocity, lab_deviation.distance, lab_deviation.energy);
+        printf("Reference: %.1f m in 10 minutes\n", ref.distance / 10);
+    }
+
+    if (failures > 0) {
+        printf("vehicle_model_test: deviation from the reference above %.2f m/s, %.1f m or %.0f (0.1 m/s)^2/2\n",
+               MAX_VELOCITY_ERROR / 10, MAX_DISTANCE_ERROR / 10, MAX_ENERGY_ERROR);
+        return 1;
+    }
+    printf("vehicle_model_test: passed\n");
+    return 0;
+}
@@ -0,0 +1,211 @@
+/**
+ * @file admit.c
+ *
+ * @brief Admission control for periodic load added at run time.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "rta.h"
+#include "admit.h"
+
+#if appUSE_ADMISSION_CONTROL
+
+#define PERIOD_STEP_US      1000u   /* Resolution of a degraded period */
+#define TICK_US             ( 1000000u / configTICK_RATE_HZ )
+
+/**
+ * @brief Guaranteed and admitted tasks. The entries are changed only with
+ *        the scheduler suspended.
+ */
+static TaskHandle_t handles[ADMIT_MAX_TASKS];
+static rta_task_t tasks[ADMIT_MAX_TASKS];
+static bool guaranteed[ADMIT_MAX_TASKS];
+static size_t num_tasks;
+
+static admit_test_t test;
+static double cap = ADMIT_DEFAULT_CAP_PERMILLE / 1000.0;
+static uint32_t accepted, degraded, rejected;
+
+static int find(TaskHandle_t task) {
+    for (size_t i = 0; i < num_tasks; i++) {
+        if (handles[i] == task) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static bool passes(const rta_task_t *set, size_t count) {
+    rta_task_t charged[ADMIT_MAX_TASKS];
+    uint32_t response_us[ADMIT_MAX_TASKS];
+    double density = 0.0;
+
+    /* One tick more per job: a job can overrun its WCET until the next tick */
+    for (size_t i = 0; i < count; i++) {
+        charged[i] = set[i];
+        charged[i].wcet_us += TICK_US;
+    }
+
+    if (test == ADMIT_EDF) {
+        for (size_t i = 0; i < count; i++) {
+            uint32_t deadline = rta_deadline(&charged[i]);
+
+            density += (double)charged[i].wcet_us /
+                       ((deadline < charged[i].period_us) ? deadline : charged[i].period_us);
+        }
+        return density <= cap;
+    }
+    /* Above the cap skip the iteration */
+    return (rta_utilization(charged, count) <= cap) && rta_response_times(charged, count, response_us);
+}
+
+/**
+ * @brief Tests the table with the entry at index replaced by (or, at
+ *        num_tasks, extended with) the candidate.
+ */
+static bool passes_with(size_t index, const admit_params_t *params, uint32_t period_us) {
+    rta_task_t set[ADMIT_MAX_TASKS];
+    size_t count = (index == num_tasks) ? num_tasks + 1 : num_tasks;
+
+    for (size_t i = 0; i < num_tasks; i++) {
+        set[i] = tasks[i];
+    }
+    set[index] = (rta_task_t){
+        .period_us = period_us,
+        .wcet_us = params->wcet_us,
+        .deadline_us = params->deadline_us,
+        .priority = params->priority,
+    };
+    return passes(set, count);
+}
+
+static void store(size_t index, TaskHandle_t task, const admit_params_t *params, bool always) {
+    handles[index] = task;
+    tasks[index] = (rta_task_t){
+        .name = pcTaskGetName(task),
+        .period_us = params->period_us,
+        .wcet_us = params->wcet_us,
+        .deadline_us = params->deadline_us,
+        .priority = params->priority,
+    };
+    guaranteed[index] = always;
+    if (index == num_tasks) {
+        num_tasks++;
+    }
+}
+
+void admit_init(admit_test_t t, uint16_t cap_permille) {
+    test = t;
+    cap = cap_permille / 1000.0;
+}
+
+BaseType_t admit_guarantee(TaskHandle_t task, const admit_params_t *params) {
+    BaseType_t result = pdFAIL;
+    int index;
+
+    vTaskSuspendAll();
+    index = find(task);
+    if (index < 0) {
+        index = (int)num_tasks;
+    }
+    if (index < ADMIT_MAX_TASKS) {
+        store((size_t)index, task, params, true);
+        result = passes(tasks, num_tasks) ? pdPASS : pdFAIL;
+    }
+    (void)xTaskResumeAll();
+    return result;
+}
+
+admit_result_t admit_request(TaskHandle_t task, admit_params_t *params, uint32_t max_period_us) {
+    admit_result_t result = ADMIT_REJECTED;
+    int index;
+
+    vTaskSuspendAll();
+    index = find(task);
+    if (index < 0) {
+        index = (int)num_tasks;
+    }
+    if ((index < ADMIT_MAX_TASKS) && ((index == (int)num_tasks) || !guaranteed[index])) {
+        if (passes_with((size_t)index, params, params->period_us)) {
+            result = ADMIT_ACCEPTED;
+        } else if ((max_period_us > params->period_us) && (params->deadline_us == 0) &&
+                   passes_with((size_t)index, params, max_period_us)) {
+            /* The test is monotonic in the period: bisect for the shortest one that passes */
+            uint32_t fails = params->period_us, works = max_period_us;
+
+            while (works - fails > PERIOD_STEP_US) {
+                uint32_t mid = fails + (works - fails) / 2u / PERIOD_STEP_US * PERIOD_STEP_US;
+
+                if (mid == fails) {
+                    mid += PERIOD_STEP_US;
+                }
+                if (passes_with((size_t)index, params, mid)) {
+                    works = mid;
+                } else {
+                    fails = mid;
+                }
+            }
+            params->period_us = works;
+            result = ADMIT_DEGRADED;
+        }
+    }
+    if (result != ADMIT_REJECTED) {
+        store((size_t)index, task, params, false);
+    }
+    (void)xTaskResumeAll();
+
+    switch (result) {
+    case ADMIT_ACCEPTED:
+        accepted++;
+        break;
+    case ADMIT_DEGRADED:
+        degraded++;
+        break;
+    default:
+        rejected++;
+        break;
+    }
+    return result;
+}
+
+void admit_withdraw(TaskHandle_t task) {
+    int index;
+
+    vTaskSuspendAll();
+    index = find(task);
+    if ((index >= 0) && !guaranteed[index]) {
+        /* Keep the table dense */
+        num_tasks--;
+        handles[index] = handles[num_tasks];
+        tasks[index] = tasks[num_tasks];
+        guaranteed[index] = guaranteed[num_tasks];
+    }
+    (void)xTaskResumeAll();
+}
+
+void admit_report(void) {
+    printf("Admission (%s): %lu accepted, %lu degraded, %lu rejected, utilisation %u %% (cap %u %%)\n",
+           (test == ADMIT_EDF) ? "EDF" : "fixed priority", (unsigned long)accepted,
+           (unsigned long)degraded, (unsigned long)rejected,
+           (unsigned)(rta_utilization(tasks, num_tasks) * 100.0 + 0.5), (unsigned)(cap * 100.0 + 0.5));
+    for (size_t i = 0; i < num_tasks; i++) {
+        printf("  %-12s T %6lu us, C %6lu us, D %6lu us, prio %2lu, %s\n", tasks[i].name,
+               (unsigned long)tasks[i].period_us, (unsigned long)tasks[i].wcet_us,
+               (unsigned long)rta_deadline(&tasks[i]), (unsigned long)tasks[i].priority,
+               guaranteed[i] ? "guaranteed" : "admitted");
+    }
+}
+
+static void report_callback(void *unused1, uint32_t unused2) {
+    admit_report();
+}
+
+void admit_request_report(void) {
+    xTimerPendFunctionCall(report_callback, NULL, 0, 0);
+}
+
+#endif /* appUSE_ADMISSION_CONTROL */
@@ -0,0 +1,131 @@
+/**
+ * @file admit.h
+ *
+ * @brief Admission control for periodic load added at run time.
+ *
+ * The guaranteed tasks (the control loop) are declared once with
+ * admit_guarantee(). A task that wants to add load, e.g. a load generator
+ * or a plug-in, declares its execution time C, period T and deadline D with
+ * admit_request() before it runs that load. The request is admitted only if
+ * the whole set, guaranteed tasks, admitted tasks and the new one, still
+ * passes the schedulability test:
+ *
+ * - ADMIT_FIXED_PRIORITY: response-time analysis (rta.h) with the declared
+ *   priorities, and the utilisation at most the cap,
+ * - ADMIT_EDF: density sum C / min(D, T) at most the cap.
+ *
+ * The tests are not exact for the target. Each WCET is charged one tick
+ * more than declared, because releases and the budget enforcement of
+ * budget.h only act on the tick, and the cap of admit_init() (default
+ * ADMIT_DEFAULT_CAP_PERMILLE) leaves headroom for the kernel, the
+ * interrupts and WCETs that were measured too low.
+ *
+ * If the request fails and the caller allows a longer period, the shortest
+ * period up to that limit that passes is granted instead (degraded),
+ * searched by bisection in 1 ms steps; only requests with implicit deadlines
+ * are degraded. Otherwise the request is rejected and an earlier admission
+ * of the task stays valid. A task must stay within the admitted execution
+ * time, e.g. enforced by a budget (budget.h).
+ *
+ * The tests run with the scheduler suspended; with 8 tasks they take a few
+ * microseconds.
+ *
+ * Requirements in FreeRTOSConfig.h:
+ * - appUSE_ADMISSION_CONTROL 1
+ */
+
+#ifndef ADMIT_H
+#define ADMIT_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Maximum number of guaranteed and admitted tasks.
+ */
+#define ADMIT_MAX_TASKS             8
+
+/**
+ * @brief Default utilisation cap in permille.
+ */
+#define ADMIT_DEFAULT_CAP_PERMILLE  900u
+
+/**
+ * @brief Schedulability tests.
+ */
+typedef enum {
+    ADMIT_FIXED_PRIORITY = 0,   /* Response-time analysis */
+    ADMIT_EDF                   /* Density test */
+} admit_test_t;
+
+/**
+ * @brief Outcome of a request.
+ */
+typedef enum {
+    ADMIT_ACCEPTED = 0,         /* Admitted as requested */
+    ADMIT_DEGRADED,             /* Admitted with a longer period */
+    ADMIT_REJECTED              /* Not admitted, an earlier admission stays */
+} admit_result_t;
+
+/**
+ * @brief Timing parameters of a task. Times in us.
+ */
+typedef struct {
+    uint32_t period_us;
+    uint32_t wcet_us;
+    uint32_t deadline_us;       /* Relative deadline, 0 for the period */
+    uint32_t priority;          /* FreeRTOS priority, for ADMIT_FIXED_PRIORITY */
+} admit_params_t;
+
+/**
+ * @brief Selects the schedulability test. Call before any other function.
+ *
+ * @param test Test that matches the scheduler.
+ * @param cap_permille Highest utilisation (or density) of the whole set in
+ *                     permille, e.g. ADMIT_DEFAULT_CAP_PERMILLE.
+ */
+void admit_init(admit_test_t test, uint16_t cap_permille);
+
+/**
+ * @brief Declares a task that is always part of the set.
+ *
+ * @param task Task handle.
+ * @param params Timing parameters.
+ * @return BaseType_t pdPASS, or pdFAIL if the table is full or the
+ *                    guaranteed tasks alone are not schedulable.
+ */
+BaseType_t admit_guarantee(TaskHandle_t task, const admit_params_t *params);
+
+/**
+ * @brief Requests the admission of new or changed load of a task.
+ *
+ * @param task Task handle.
+ * @param params Requested parameters; the period (and an implicit deadline)
+ *               is updated if the request is degraded.
+ * @param max_period_us Longest acceptable period, params->period_us or
+ *                      less to never degrade.
+ * @return admit_result_t Outcome.
+ */
+admit_result_t admit_request(TaskHandle_t task, admit_params_t *params, uint32_t max_period_us);
+
+/**
+ * @brief Removes the admission of a task, its load no longer counts.
+ *
+ * @param task Task handle.
+ */
+void admit_withdraw(TaskHandle_t task);
+
+/**
+ * @brief Prints the admitted set and the number of accepted, degraded and
+ *        rejected requests.
+ */
+void admit_report(void);
+
+/**
+ * @brief Prints the report in the timer service task, e.g. on a button press.
+ *        Requires configUSE_TIMERS.
+ */
+void admit_request_report(void);
+
+#endif /* ADMIT_H */
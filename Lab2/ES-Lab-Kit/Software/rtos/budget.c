@@ -0,0 +1,245 @@
+/**
+ * @file budget.c
+ *
+ * @brief Per-task execution-time budgets with overrun enforcement.
+ */
+
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "pico/stdlib.h"
+#include "budget.h"
+
+#if appUSE_BUDGET_MONITOR
+
+#if configNUMBER_OF_CORES > 1
+#define CURRENT_CORE()      ((unsigned)portGET_CORE_ID())
+#else
+#define CURRENT_CORE()      0u
+#endif
+
+/**
+ * @brief Budget state of a job.
+ */
+typedef enum {
+    JOB_OK = 0,         /* Within budget */
+    JOB_OVERRUN,        /* Budget exceeded, policy not yet applied */
+    JOB_LOGGED,         /* Overrun printed (BUDGET_LOG) */
+    JOB_DEMOTED,        /* Running at BUDGET_DEMOTED_PRIORITY */
+    JOB_SUSPENDED       /* Suspended until the next period */
+} job_state_t;
+
+/**
+ * @brief Budget and accounting data of one task.
+ */
+typedef struct {
+    TaskHandle_t task;
+    uint32_t budget_us;
+    budget_policy_t policy;
+    UBaseType_t base_priority;
+    TickType_t release;         /* Release time of the current job */
+    TickType_t period;          /* Period passed to budget_wait_next_period() */
+    uint32_t used_us;           /* Execution time of the current job */
+    uint32_t max_used_us;       /* Longest job so far */
+    uint32_t overruns;          /* Number of jobs that exceeded the budget */
+    job_state_t state;
+} budget_task_t;
+
+static budget_task_t tasks[BUDGET_MAX_TASKS];
+static UBaseType_t num_tasks;
+
+/**
+ * @brief Entry of the task running on each core (NULL if it has no budget)
+ *        and the time it was switched in or last charged.
+ */
+static budget_task_t *running[configNUMBER_OF_CORES];
+static uint32_t charged_at_us[configNUMBER_OF_CORES];
+
+static budget_task_t *find(TaskHandle_t task) {
+    for (UBaseType_t i = 0; i < num_tasks; i++) {
+        if (tasks[i].task == task) {
+            return &tasks[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Charges the time since the last switch/tick to the task running on
+ *        a core. Must be called with interrupts masked (in a critical section
+ *        on SMP).
+ */
+static void charge_running(unsigned core, uint32_t now) {
+    if (running[core] != NULL) {
+        running[core]->used_us += now - charged_at_us[core];
+    }
+    charged_at_us[core] = now;
+}
+
+/**
+ * @brief Applies the overrun policy, runs in the timer service task.
+ */
+static void enforce(void *arg, uint32_t used_us) {
+    budget_task_t *t = (budget_task_t *)arg;
+    bool demote = false;
+
+    taskENTER_CRITICAL();
+    if (t->state == JOB_OVERRUN) {  /* The job may have completed meanwhile. */
+        switch (t->policy) {
+        case BUDGET_DEMOTE:
+            t->state = JOB_DEMOTED;
+            demote = true;
+            break;
+        case BUDGET_SUSPEND:
+            t->state = JOB_SUSPENDED;
+            vTaskSuspend(t->task);  /* Resumed by the tick hook. */
+            break;
+        default:
+            t->state = JOB_LOGGED;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (demote) {
+        vTaskPrioritySet(t->task, BUDGET_DEMOTED_PRIORITY);
+    }
+    printf("Budget: %s overran its budget (%lu us > %lu us)\n", pcTaskGetName(t->task),
+           (unsigned long)used_us, (unsigned long)t->budget_us);
+}
+
+BaseType_t budget_register(TaskHandle_t task, uint32_t budget_us, budget_policy_t policy) {
+    budget_task_t *t;
+
+    if (num_tasks >= BUDGET_MAX_TASKS) {
+        return pdFAIL;
+    }
+
+    t = &tasks[num_tasks];
+    t->task = task;
+    t->budget_us = budget_us;
+    t->policy = policy;
+    t->base_priority = uxTaskPriorityGet(task);
+    t->release = xTaskGetTickCount();
+    t->period = portMAX_DELAY;
+    t->used_us = 0;
+    t->max_used_us = 0;
+    t->overruns = 0;
+    t->state = JOB_OK;
+    num_tasks++;        /* Publish the entry last, the hooks may already run. */
+
+    return pdPASS;
+}
+
+BaseType_t budget_set(TaskHandle_t task, uint32_t budget_us) {
+    budget_task_t *t = find(task);
+
+    if (t == NULL) {
+        return pdFAIL;
+    }
+    taskENTER_CRITICAL();
+    t->budget_us = budget_us;
+    taskEXIT_CRITICAL();
+    return pdPASS;
+}
+
+/**
+ * @brief Ends the job of the calling task and restores its priority.
+ *
+ * @return budget_task_t* Entry of the task, NULL if it has no budget.
+ */
+static budget_task_t *end_job(TickType_t period) {
+    budget_task_t *t = find(xTaskGetCurrentTaskHandle());
+    bool demoted;
+
+    if (t == NULL) {
+        return NULL;
+    }
+
+    taskENTER_CRITICAL();
+    charge_running(CURRENT_CORE(), time_us_32());
+    if (t->used_us > t->max_used_us) {
+        t->max_used_us = t->used_us;
+    }
+    demoted = (t->state == JOB_DEMOTED);
+    t->state = JOB_OK;
+    t->used_us = 0;
+    t->period = period;
+    taskEXIT_CRITICAL();
+
+    if (demoted) {
+        vTaskPrioritySet(NULL, t->base_priority);
+    }
+    return t;
+}
+
+BaseType_t budget_wait_next_period(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement) {
+    budget_task_t *t = end_job(xTimeIncrement);
+    BaseType_t xWasDelayed;
+
+    xWasDelayed = xTaskDelayUntil(pxPreviousWakeTime, xTimeIncrement);
+
+    if (t != NULL) {
+        t->release = *pxPreviousWakeTime;
+    }
+    return xWasDelayed;
+}
+
+uint32_t budget_wait_notification(TickType_t xTicksToWait) {
+    budget_task_t *t = end_job(portMAX_DELAY);
+    uint32_t events;
+
+    events = ulTaskNotifyTake(pdTRUE, xTicksToWait);
+
+    if (t != NULL) {
+        t->release = xTaskGetTickCount();
+    }
+    return events;
+}
+
+void budget_report(void) {
+    for (UBaseType_t i = 0; i < num_tasks; i++) {
+        printf("Budget: %-12s WCET %6lu us, budget %6lu us, %lu overruns\n",
+               pcTaskGetName(tasks[i].task),
+               (unsigned long)tasks[i].max_used_us,
+               (unsigned long)tasks[i].budget_us,
+               (unsigned long)tasks[i].overruns);
+    }
+}
+
+void budget_task_switched_in(void) {
+    charge_running(CURRENT_CORE(), time_us_32());
+    running[CURRENT_CORE()] = find(xTaskGetCurrentTaskHandle());
+}
+
+void budget_tick_from_isr(void) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    TickType_t now_tick = xTaskGetTickCountFromISR();
+    uint32_t now = time_us_32();
+
+    for (unsigned core = 0; core < configNUMBER_OF_CORES; core++) {
+        charge_running(core, now);
+    }
+
+    for (UBaseType_t i = 0; i < num_tasks; i++) {
+        budget_task_t *t = &tasks[i];
+
+        if ((t->state == JOB_OK) && (t->used_us > t->budget_us)) {
+            t->state = JOB_OVERRUN;
+            t->overruns++;
+            xTimerPendFunctionCallFromISR(enforce, t, t->used_us, &xHigherPriorityTaskWoken);
+        } else if ((t->state == JOB_SUSPENDED) && ((TickType_t)(now_tick - t->release) >= t->period)) {
+            /* Next period has started: resume with a fresh budget. */
+            t->release += t->period;
+            t->used_us = 0;
+            t->state = JOB_OK;
+            if (xTaskResumeFromISR(t->task) == pdTRUE) {
+                xHigherPriorityTaskWoken = pdTRUE;
+            }
+        }
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+#endif /* appUSE_BUDGET_MONITOR */
@@ -0,0 +1,110 @@
+/**
+ * @file budget.h
+ *
+ * @brief Per-task execution-time budgets with overrun enforcement.
+ *
+ * The execution time of every registered task is measured from the
+ * switch-in/switch-out timestamps (traceTASK_SWITCHED_IN). The tick hook
+ * compares the time consumed by the current job with the task's budget.
+ * An overrun is therefore seen at the latest one tick after it happened.
+ * The configured policy is then applied in the timer service task.
+ *
+ * A job ends when the task calls budget_wait_next_period(), which replaces
+ * xTaskDelayUntil() in the periodic loop. Event-driven tasks end their job
+ * with budget_wait_notification() instead; they should use BUDGET_LOG or
+ * BUDGET_DEMOTE, since BUDGET_SUSPEND resumes a task at its next period.
+ *
+ * Requirements in FreeRTOSConfig.h:
+ * - appUSE_BUDGET_MONITOR 1
+ * - configUSE_TICK_HOOK 1
+ * - configUSE_TIMERS 1 and INCLUDE_xTimerPendFunctionCall 1
+ */
+
+#ifndef BUDGET_H
+#define BUDGET_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Maximum number of tasks with a budget.
+ */
+#define BUDGET_MAX_TASKS            8
+
+/**
+ * @brief Priority of a task demoted by BUDGET_DEMOTE (just above idle).
+ */
+#define BUDGET_DEMOTED_PRIORITY     ( tskIDLE_PRIORITY + 1 )
+
+/**
+ * @brief Action taken when a job exceeds its budget.
+ */
+typedef enum {
+    BUDGET_LOG = 0,     /* Only print the overrun */
+    BUDGET_DEMOTE,      /* Run the rest of the job at BUDGET_DEMOTED_PRIORITY */
+    BUDGET_SUSPEND      /* Suspend the task until its next period starts */
+} budget_policy_t;
+
+/**
+ * @brief Assigns an execution-time budget to a task.
+ *
+ * The priority of the task at registration is restored after a demotion.
+ *
+ * @param task Task handle.
+ * @param budget_us Budget per job in us.
+ * @param policy Overrun policy.
+ * @return BaseType_t pdPASS, or pdFAIL if the table is full.
+ */
+BaseType_t budget_register(TaskHandle_t task, uint32_t budget_us, budget_policy_t policy);
+
+/**
+ * @brief Changes the budget of a registered task, e.g. after its load was
+ *        admitted again (admit.h). Applies to the current job.
+ *
+ * @param task Task handle.
+ * @param budget_us Budget per job in us.
+ * @return BaseType_t pdPASS, or pdFAIL if the task has no budget.
+ */
+BaseType_t budget_set(TaskHandle_t task, uint32_t budget_us);
+
+/**
+ * @brief Ends the current job and waits for the next release.
+ *
+ * Drop-in replacement for xTaskDelayUntil(). Tasks without a budget are
+ * simply delayed.
+ *
+ * @param pxPreviousWakeTime Release time of the current job, updated.
+ * @param xTimeIncrement Period in ticks.
+ * @return BaseType_t Return value of xTaskDelayUntil(), i.e. pdFALSE if the
+ *                    next release had already passed.
+ */
+BaseType_t budget_wait_next_period(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement);
+
+/**
+ * @brief Ends the current job and waits for the next task notification.
+ *
+ * Drop-in replacement for ulTaskNotifyTake(pdTRUE, xTicksToWait).
+ *
+ * @param xTicksToWait Maximum time to wait in ticks.
+ * @return uint32_t Number of notifications received, 0 on timeout.
+ */
+uint32_t budget_wait_notification(TickType_t xTicksToWait);
+
+/**
+ * @brief Prints the worst-case execution time and the number of overruns
+ *        of all registered tasks.
+ */
+void budget_report(void);
+
+/**
+ * @brief Kernel hook, called from traceTASK_SWITCHED_IN (rtos_hooks.c).
+ */
+void budget_task_switched_in(void);
+
+/**
+ * @brief Kernel hook, called from the tick hook (rtos_hooks.c).
+ */
+void budget_tick_from_isr(void);
+
+#endif /* BUDGET_H */
@@ -0,0 +1,211 @@
+/**
+ * @file critmode.c
+ *
+ * @brief Mixed-criticality mode switch: sheds the LO tasks while the
+ *        system is overloaded.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "event_groups.h"
+#include "pico/stdlib.h"
+#include "latstat.h"
+#include "critmode.h"
+
+#if appUSE_CRITICALITY_MODE
+
+#define LO_MODE_BIT         ( 1u << 0 )     /* Set while in LO mode */
+
+/**
+ * @brief Tag and statistics of one task.
+ */
+typedef struct {
+    TaskHandle_t task;
+    crit_level_t level;
+    crit_policy_t policy;
+    UBaseType_t stretch;
+    bool shed;                  /* Has shed since the last switch to HI mode */
+    volatile bool parked;       /* CRIT_SUSPEND task waiting for LO mode */
+    uint32_t shed_jobs;         /* Releases skipped in HI mode */
+} crit_task_t;
+
+static crit_task_t tasks[CRIT_MAX_TASKS];
+static UBaseType_t num_tasks;
+
+static volatile crit_level_t mode;
+static volatile bool lo_requested;
+static EventGroupHandle_t lo_mode;
+static TimerHandle_t hold_timer;
+
+static uint32_t entered_us;     /* Time of the last switch to HI mode */
+static TickType_t entered_tick;
+static UBaseType_t unshed;      /* LO tasks that have not shed yet */
+static uint32_t switches;
+static latstat_t latency;       /* crit_enter_hi() until all LO tasks have shed */
+
+static crit_task_t *find(TaskHandle_t task) {
+    for (UBaseType_t i = 0; i < num_tasks; i++) {
+        if (tasks[i].task == task) {
+            return &tasks[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Hold time over: back to LO mode, runs in the timer service task.
+ */
+static void hold_expired(TimerHandle_t timer) {
+    if (!lo_requested || (mode == CRIT_LO)) {
+        return;     /* crit_enter_hi() came first */
+    }
+    lo_requested = false;
+    mode = CRIT_LO;
+    xEventGroupSetBits(lo_mode, LO_MODE_BIT);
+    printf("Crit: LO mode after %lu ms in HI mode\n",
+           (unsigned long)((xTaskGetTickCount() - entered_tick) * portTICK_PERIOD_MS));
+}
+
+BaseType_t crit_init(TickType_t hold) {
+    mode = CRIT_LO;
+    lo_requested = false;
+    latstat_init(&latency);
+
+    lo_mode = xEventGroupCreate();
+    hold_timer = xTimerCreate("CritHold", hold, pdFALSE, NULL, hold_expired);
+    if ((lo_mode == NULL) || (hold_timer == NULL)) {
+        return pdFAIL;
+    }
+    xEventGroupSetBits(lo_mode, LO_MODE_BIT);
+    return pdPASS;
+}
+
+BaseType_t crit_register(TaskHandle_t task, crit_level_t level, crit_policy_t policy,
+                         UBaseType_t stretch) {
+    crit_task_t *t;
+
+    if (num_tasks >= CRIT_MAX_TASKS) {
+        return pdFAIL;
+    }
+
+    t = &tasks[num_tasks];
+    t->task = task;
+    t->level = level;
+    t->policy = policy;
+    t->stretch = (stretch >= 2) ? stretch : 2;
+    t->shed = false;
+    t->parked = false;
+    t->shed_jobs = 0;
+    num_tasks++;
+
+    return pdPASS;
+}
+
+void crit_enter_hi(void) {
+    UBaseType_t lo_tasks = 0;
+    UBaseType_t running = 0;
+
+    lo_requested = false;
+    xTimerStop(hold_timer, 0);
+    if (mode == CRIT_HI) {
+        return;
+    }
+
+    /* Close the gate before the LO tasks can see HI mode */
+    xEventGroupClearBits(lo_mode, LO_MODE_BIT);
+    taskENTER_CRITICAL();
+    for (UBaseType_t i = 0; i < num_tasks; i++) {
+        if (tasks[i].level == CRIT_LO) {
+            /* A task still parked from the last HI mode has shed already */
+            tasks[i].shed = tasks[i].parked;
+            running += tasks[i].shed ? 0 : 1;
+            lo_tasks++;
+        }
+    }
+    unshed = running;
+    entered_us = time_us_32();
+    entered_tick = xTaskGetTickCount();
+    switches++;
+    mode = CRIT_HI;
+    if (running == 0) {
+        latstat_add(&latency, 0);
+    }
+    taskEXIT_CRITICAL();
+
+    printf("Crit: HI mode, shedding %lu LO tasks\n", (unsigned long)lo_tasks);
+}
+
+void crit_request_lo(void) {
+    if (mode == CRIT_HI) {
+        lo_requested = true;
+        xTimerReset(hold_timer, 0);
+    }
+}
+
+crit_level_t crit_mode(void) {
+    return mode;
+}
+
+TickType_t crit_job_done(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement) {
+    crit_task_t *t = find(xTaskGetCurrentTaskHandle());
+    TickType_t now;
+
+    if ((t == NULL) || (t->level == CRIT_HI) || (mode == CRIT_LO)) {
+        return xTimeIncrement;
+    }
+
+    taskENTER_CRITICAL();
+    if (!t->shed) {
+        t->shed = true;
+        if ((unshed > 0) && (--unshed == 0)) {
+            latstat_add(&latency, time_us_32() - entered_us);
+        }
+    }
+    t->parked = (t->policy == CRIT_SUSPEND);
+    taskEXIT_CRITICAL();
+
+    if (t->policy == CRIT_STRETCH) {
+        t->shed_jobs += t->stretch - 1;
+        return xTimeIncrement * t->stretch;
+    }
+
+    xEventGroupWaitBits(lo_mode, LO_MODE_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+    t->parked = false;
+
+    /* All releases up to now are shed; restart one period from now, a release in the
+     * past would count as a deadline miss */
+    now = xTaskGetTickCount();
+    t->shed_jobs += (now - *pxPreviousWakeTime) / xTimeIncrement;
+    *pxPreviousWakeTime = now;
+    return xTimeIncrement;
+}
+
+void crit_report(void) {
+    printf("Crit: %s mode, %lu switches to HI, switch latency avg %lu us, max %lu us\n",
+           (mode == CRIT_HI) ? "HI" : "LO", (unsigned long)switches,
+           (unsigned long)latstat_avg(&latency), (unsigned long)latency.max_us);
+    for (UBaseType_t i = 0; i < num_tasks; i++) {
+        if (tasks[i].level == CRIT_HI) {
+            printf("Crit: %-12s HI\n", pcTaskGetName(tasks[i].task));
+        } else if (tasks[i].policy == CRIT_STRETCH) {
+            printf("Crit: %-12s LO stretch x%lu, %lu shed jobs\n", pcTaskGetName(tasks[i].task),
+                   (unsigned long)tasks[i].stretch, (unsigned long)tasks[i].shed_jobs);
+        } else {
+            printf("Crit: %-12s LO suspend,   %lu shed jobs\n", pcTaskGetName(tasks[i].task),
+                   (unsigned long)tasks[i].shed_jobs);
+        }
+    }
+}
+
+static void report_callback(void *unused1, uint32_t unused2) {
+    crit_report();
+}
+
+void crit_request_report(void) {
+    xTimerPendFunctionCall(report_callback, NULL, 0, 0);
+}
+
+#endif /* appUSE_CRITICALITY_MODE */
@@ -0,0 +1,128 @@
+/**
+ * @file critmode.h
+ *
+ * @brief Mixed-criticality mode switch: sheds the LO tasks while the
+ *        system is overloaded.
+ *
+ * Every registered task is tagged HI or LO criticality. In LO mode all
+ * tasks run normally. crit_enter_hi(), e.g. called on an overload event of
+ * the load monitor (loadmon.h), switches to HI mode. From then on a LO task
+ * sheds its jobs at the end of its current one:
+ *
+ * - CRIT_SUSPEND: the task waits until the system is back in LO mode and
+ *   then starts again with a fresh release,
+ * - CRIT_STRETCH: the task keeps running with its period multiplied.
+ *
+ * A LO task is never stopped in the middle of a job, so it cannot hold the
+ * printf lock or a mutex while it is shed. The mode-switch latency is the
+ * time from crit_enter_hi() until every LO task has shed.
+ *
+ * crit_request_lo() returns to LO mode once the system stays calm for the
+ * hold time given to crit_init(). A new crit_enter_hi() within the hold time
+ * cancels the return. Together with the hysteresis of the load monitor this
+ * keeps the mode from toggling with every load peak.
+ *
+ * A periodic task calls crit_job_done() before it waits for its next
+ * release and uses the returned period; HI tasks and tasks that are not
+ * registered get their own period back.
+ *
+ * Requirements in FreeRTOSConfig.h:
+ * - appUSE_CRITICALITY_MODE 1
+ * - configUSE_TIMERS 1 and INCLUDE_xTimerPendFunctionCall 1
+ */
+
+#ifndef CRITMODE_H
+#define CRITMODE_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Maximum number of registered tasks.
+ */
+#define CRIT_MAX_TASKS              8
+
+/**
+ * @brief Criticality of a task, and the system mode.
+ */
+typedef enum {
+    CRIT_LO = 0,
+    CRIT_HI
+} crit_level_t;
+
+/**
+ * @brief What a LO task does in HI mode.
+ */
+typedef enum {
+    CRIT_SUSPEND = 0,       /* Wait for LO mode at the end of the job */
+    CRIT_STRETCH            /* Run with the period multiplied by the stretch factor */
+} crit_policy_t;
+
+/**
+ * @brief Initialises the mode manager in LO mode. Call before
+ *        vTaskStartScheduler().
+ *
+ * @param hold Time in ticks the system must stay calm before crit_request_lo()
+ *             returns to LO mode.
+ * @return BaseType_t pdPASS, or pdFAIL if the timer or event group could not
+ *                    be allocated.
+ */
+BaseType_t crit_init(TickType_t hold);
+
+/**
+ * @brief Tags a task.
+ *
+ * @param task Task handle.
+ * @param level CRIT_HI or CRIT_LO.
+ * @param policy Behaviour in HI mode, ignored for HI tasks.
+ * @param stretch Period factor of CRIT_STRETCH (>= 2).
+ * @return BaseType_t pdPASS, or pdFAIL if the table is full.
+ */
+BaseType_t crit_register(TaskHandle_t task, crit_level_t level, crit_policy_t policy,
+                         UBaseType_t stretch);
+
+/**
+ * @brief Switches to HI mode, or stays there and cancels a pending return
+ *        to LO mode. Call from a task, e.g. the load monitor callback.
+ */
+void crit_enter_hi(void);
+
+/**
+ * @brief Returns to LO mode after the hold time, unless crit_enter_hi() is
+ *        called meanwhile.
+ */
+void crit_request_lo(void);
+
+/**
+ * @brief Returns the current mode.
+ *
+ * @return crit_level_t CRIT_LO or CRIT_HI.
+ */
+crit_level_t crit_mode(void);
+
+/**
+ * @brief Ends the job of the calling task. A LO task in HI mode sheds here:
+ *        CRIT_SUSPEND blocks until LO mode and moves the release to the
+ *        time it resumes, CRIT_STRETCH gets a longer period.
+ *
+ * @param pxPreviousWakeTime Release time of the current job, as passed to
+ *                           xTaskDelayUntil(); reset after a suspension.
+ * @param xTimeIncrement Period in ticks.
+ * @return TickType_t Period until the next release.
+ */
+TickType_t crit_job_done(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement);
+
+/**
+ * @brief Prints the mode, the number of switches, the mode-switch latency
+ *        and the shed jobs of each LO task.
+ */
+void crit_report(void);
+
+/**
+ * @brief Prints the report from the timer service task; can be called from
+ *        any task.
+ */
+void crit_request_report(void);
+
+#endif /* CRITMODE_H */
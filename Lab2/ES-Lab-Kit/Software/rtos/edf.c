@@ -0,0 +1,183 @@
+/**
+ * @file edf.c
+ *
+ * @brief Earliest-deadline-first scheduling of periodic tasks on top of the
+ *        fixed-priority FreeRTOS scheduler.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "edf.h"
+
+#if appUSE_EDF_SCHEDULER
+
+/**
+ * @brief State of one EDF task.
+ */
+typedef struct {
+    TaskHandle_t task;
+    TickType_t period;
+    TickType_t deadline;        /* Relative deadline */
+    TickType_t release;         /* Release of the current job */
+    TickType_t abs_deadline;    /* Absolute deadline of the current job */
+    UBaseType_t priority;       /* Priority assigned last */
+    uint32_t jobs;
+    uint32_t misses;
+    TickType_t max_lateness;    /* Ticks after the deadline, worst job */
+} edf_task_t;
+
+static edf_task_t tasks[EDF_MAX_TASKS];
+static UBaseType_t num_tasks;
+static UBaseType_t base;
+
+/**
+ * @brief true if deadline a is earlier than b, across the wrap of the tick count.
+ */
+static bool earlier(TickType_t a, TickType_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+static edf_task_t *find(TaskHandle_t task) {
+    for (UBaseType_t i = 0; i < num_tasks; i++) {
+        if (tasks[i].task == task) {
+            return &tasks[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Gives the earliest deadline the highest priority of the band.
+ *        The scheduler is suspended, so the caller is not preempted while
+ *        the order is only partly applied.
+ */
+static void assign_priorities(void) {
+    vTaskSuspendAll();
+    for (UBaseType_t i = 0; i < num_tasks; i++) {
+        UBaseType_t later = 0;
+
+        /* Rank = number of tasks with a later deadline; ties keep the registration order */
+        for (UBaseType_t j = 0; j < num_tasks; j++) {
+            if ((j != i) && (earlier(tasks[i].abs_deadline, tasks[j].abs_deadline) ||
+                             ((tasks[i].abs_deadline == tasks[j].abs_deadline) && (i < j)))) {
+                later++;
+            }
+        }
+        if (tasks[i].priority != base + later) {
+            tasks[i].priority = base + later;
+            vTaskPrioritySet(tasks[i].task, tasks[i].priority);
+        }
+    }
+    (void)xTaskResumeAll();
+}
+
+BaseType_t edf_register(TaskHandle_t task, TickType_t period, TickType_t deadline) {
+    edf_task_t *t;
+
+    if ((task == NULL) || (num_tasks >= EDF_MAX_TASKS)) {
+        return pdFAIL;
+    }
+
+    t = &tasks[num_tasks];
+    t->task = task;
+    t->period = period;
+    t->deadline = (deadline != 0) ? deadline : period;
+    t->release = xTaskGetTickCount();
+    t->abs_deadline = t->release + t->deadline;
+    t->priority = uxTaskPriorityGet(task);
+    t->jobs = 0;
+    t->misses = 0;
+    t->max_lateness = 0;
+    num_tasks++;
+
+    return pdPASS;
+}
+
+BaseType_t edf_set_period(TaskHandle_t task, TickType_t period, TickType_t deadline) {
+    edf_task_t *t = find(task);
+
+    if (t == NULL) {
+        return pdFAIL;
+    }
+    taskENTER_CRITICAL();
+    t->period = period;
+    t->deadline = (deadline != 0) ? deadline : period;
+    taskEXIT_CRITICAL();
+    return pdPASS;
+}
+
+BaseType_t edf_set_release(TickType_t release) {
+    edf_task_t *t = find(xTaskGetCurrentTaskHandle());
+
+    if (t == NULL) {
+        return pdFAIL;
+    }
+    taskENTER_CRITICAL();
+    t->release = release;
+    t->abs_deadline = release + t->deadline;
+    taskEXIT_CRITICAL();
+
+    assign_priorities();
+    return pdPASS;
+}
+
+void edf_start(UBaseType_t base_priority) {
+    base = base_priority;
+    assign_priorities();
+}
+
+BaseType_t edf_job_done(void) {
+    edf_task_t *t = find(xTaskGetCurrentTaskHandle());
+    TickType_t now = xTaskGetTickCount();
+    BaseType_t on_time = pdTRUE;
+
+    if (t == NULL) {
+        return pdTRUE;
+    }
+
+    taskENTER_CRITICAL();
+    t->jobs++;
+    if (earlier(t->abs_deadline, now)) {
+        on_time = pdFALSE;
+        t->misses++;
+        if ((TickType_t)(now - t->abs_deadline) > t->max_lateness) {
+            t->max_lateness = now - t->abs_deadline;
+        }
+    }
+    t->release += t->period;
+    t->abs_deadline = t->release + t->deadline;
+    taskEXIT_CRITICAL();
+
+    assign_priorities();
+    return on_time;
+}
+
+BaseType_t edf_wait_next_period(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement) {
+    BaseType_t on_time = edf_job_done();
+    BaseType_t xWasDelayed = xTaskDelayUntil(pxPreviousWakeTime, xTimeIncrement);
+
+    return ((on_time == pdTRUE) && (xWasDelayed == pdTRUE)) ? pdTRUE : pdFALSE;
+}
+
+void edf_report(void) {
+    printf("EDF: %-12s %6s %6s %8s %6s %8s %4s\n", "Task", "T", "D", "Jobs", "Misses", "Lateness", "Prio");
+    for (UBaseType_t i = 0; i < num_tasks; i++) {
+        printf("EDF: %-12s %6lu %6lu %8lu %6lu %8lu %4lu\n", pcTaskGetName(tasks[i].task),
+               (unsigned long)tasks[i].period, (unsigned long)tasks[i].deadline,
+               (unsigned long)tasks[i].jobs, (unsigned long)tasks[i].misses,
+               (unsigned long)tasks[i].max_lateness, (unsigned long)tasks[i].priority);
+    }
+}
+
+static void report_callback(void *unused1, uint32_t unused2) {
+    edf_report();
+}
+
+void edf_request_report(void) {
+    xTimerPendFunctionCall(report_callback, NULL, 0, 0);
+}
+
+#endif /* appUSE_EDF_SCHEDULER */
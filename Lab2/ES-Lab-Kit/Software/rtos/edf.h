@@ -0,0 +1,117 @@
+/**
+ * @file edf.h
+ *
+ * @brief Earliest-deadline-first scheduling of periodic tasks on top of the
+ *        fixed-priority FreeRTOS scheduler.
+ *
+ * The registered tasks share a band of priorities starting at the base
+ * priority passed to edf_start(). The task whose current job has the
+ * earliest absolute deadline gets the highest priority of the band, the
+ * latest deadline the lowest.
+ *
+ * A task's deadline changes only when its job ends: the next job is released
+ * one period later and has its deadline one relative deadline after the
+ * release. The priorities are therefore re-assigned with vTaskPrioritySet()
+ * only in edf_wait_next_period(), which replaces xTaskDelayUntil() in the
+ * periodic loop. Between two completions the order of the deadlines does
+ * not change, so this is exact EDF at tick resolution. A job that completes
+ * after its absolute deadline counts as a deadline miss.
+ *
+ * With implicit deadlines EDF meets all deadlines up to 100 % utilisation,
+ * while rate-monotonic priorities are only guaranteed up to
+ * n (2^(1/n) - 1), e.g. 74 % for 5 tasks. Under overload EDF degrades for
+ * all tasks, not only the lowest-priority ones.
+ *
+ * Requirements in FreeRTOSConfig.h:
+ * - appUSE_EDF_SCHEDULER 1
+ * - INCLUDE_vTaskPrioritySet 1
+ */
+
+#ifndef EDF_H
+#define EDF_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Maximum number of EDF tasks.
+ */
+#define EDF_MAX_TASKS               8
+
+/**
+ * @brief Makes a task an EDF task. Its first job is released at the
+ *        current tick count. Call before edf_start().
+ *
+ * @param task Task handle.
+ * @param period Period in ticks.
+ * @param deadline Relative deadline in ticks, 0 for the period.
+ * @return BaseType_t pdPASS, or pdFAIL if the table is full.
+ */
+BaseType_t edf_register(TaskHandle_t task, TickType_t period, TickType_t deadline);
+
+/**
+ * @brief Assigns the initial priorities base_priority .. base_priority + n - 1.
+ *        Call before vTaskStartScheduler().
+ *
+ * @param base_priority Lowest priority of the band.
+ */
+void edf_start(UBaseType_t base_priority);
+
+/**
+ * @brief Changes the period and relative deadline of an EDF task, e.g.
+ *        after admission control (admit.h) degraded it. Applies from the
+ *        next release on.
+ *
+ * @param task Task handle.
+ * @param period Period in ticks.
+ * @param deadline Relative deadline in ticks, 0 for the period.
+ * @return BaseType_t pdPASS, or pdFAIL if the task is not an EDF task.
+ */
+BaseType_t edf_set_period(TaskHandle_t task, TickType_t period, TickType_t deadline);
+
+/**
+ * @brief Moves the next release of the calling task, e.g. after it shed
+ *        jobs in HI mode (critmode.h), and re-assigns the priorities.
+ *
+ * @param release Next release in ticks.
+ * @return BaseType_t pdPASS, or pdFAIL if the task is not an EDF task.
+ */
+BaseType_t edf_set_release(TickType_t release);
+
+/**
+ * @brief Ends the current job, re-assigns the priorities by the new deadline
+ *        and waits for the next release.
+ *
+ * Drop-in replacement for xTaskDelayUntil(). Tasks that are not registered
+ * are simply delayed.
+ *
+ * @param pxPreviousWakeTime Release time of the current job, updated.
+ * @param xTimeIncrement Period in ticks.
+ * @return BaseType_t pdFALSE if the job missed its deadline or the next
+ *                    release had already passed, pdTRUE otherwise.
+ */
+BaseType_t edf_wait_next_period(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement);
+
+/**
+ * @brief Ends the current job like edf_wait_next_period() without waiting,
+ *        for tasks that wait with another function, e.g.
+ *        budget_wait_next_period().
+ *
+ * @return BaseType_t pdFALSE if the job missed its deadline.
+ */
+BaseType_t edf_job_done(void);
+
+/**
+ * @brief Prints jobs, deadline misses and the maximum lateness of all EDF
+ *        tasks.
+ */
+void edf_report(void);
+
+/**
+ * @brief Prints the report in the timer service task, e.g. on a button press.
+ *        Requires configUSE_TIMERS.
+ */
+void edf_request_report(void);
+
+#endif /* EDF_H */
@@ -0,0 +1,99 @@
+/**
+ * @file heapmon.c
+ *
+ * @brief FreeRTOS heap usage and fragmentation telemetry.
+ */
+
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "heapmon.h"
+
+#if appUSE_HEAP_MONITOR
+
+static heapmon_stats_t stats = {
+    .total_bytes = configTOTAL_HEAP_SIZE,
+    .min_largest_free_block = configTOTAL_HEAP_SIZE,
+};
+static volatile uint32_t failed_allocations;
+static volatile bool report_requested;
+
+static void sample_timer_callback(TimerHandle_t xTimer) {
+    heapmon_sample();
+    if (report_requested) {
+        report_requested = false;
+        heapmon_report();
+    }
+}
+
+BaseType_t heapmon_start(TickType_t period) {
+    TimerHandle_t xTimer = xTimerCreate("HeapMon", period, pdTRUE, NULL, sample_timer_callback);
+
+    if (xTimer == NULL) {
+        return pdFAIL;
+    }
+    return xTimerStart(xTimer, 0);
+}
+
+void heapmon_sample(void) {
+    HeapStats_t heap;
+
+    vPortGetHeapStats(&heap);   /* Walks the free list with the scheduler suspended. */
+
+    stats.free_bytes = heap.xAvailableHeapSpaceInBytes;
+    stats.min_free_bytes = heap.xMinimumEverFreeBytesRemaining;
+    stats.largest_free_block = heap.xSizeOfLargestFreeBlockInBytes;
+    stats.free_blocks = heap.xNumberOfFreeBlocks;
+    stats.allocations = heap.xNumberOfSuccessfulAllocations;
+    stats.frees = heap.xNumberOfSuccessfulFrees;
+    stats.failed_allocations = failed_allocations;
+
+    if (heap.xAvailableHeapSpaceInBytes > 0) {
+        stats.fragmentation_permille = (uint16_t)(1000u -
+            (uint32_t)((uint64_t)heap.xSizeOfLargestFreeBlockInBytes * 1000u / heap.xAvailableHeapSpaceInBytes));
+    } else {
+        stats.fragmentation_permille = 0;
+    }
+
+    if (stats.largest_free_block < stats.min_largest_free_block) {
+        stats.min_largest_free_block = stats.largest_free_block;
+    }
+    if (stats.fragmentation_permille > stats.max_fragmentation_permille) {
+        stats.max_fragmentation_permille = stats.fragmentation_permille;
+    }
+}
+
+void heapmon_get(heapmon_stats_t *out) {
+    heapmon_sample();
+    *out = stats;
+}
+
+void heapmon_request_report(void) {
+    report_requested = true;
+}
+
+void heapmon_report(void) {
+    heapmon_sample();
+
+    printf("Heap: %lu of %lu bytes used (peak %lu), %lu bytes free in %lu blocks\n",
+           (unsigned long)(stats.total_bytes - stats.free_bytes),
+           (unsigned long)stats.total_bytes,
+           (unsigned long)(stats.total_bytes - stats.min_free_bytes),
+           (unsigned long)stats.free_bytes, (unsigned long)stats.free_blocks);
+    printf("Heap: largest block %lu bytes (min %lu), fragmentation %u.%u %% (max %u.%u %%)\n",
+           (unsigned long)stats.largest_free_block,
+           (unsigned long)stats.min_largest_free_block,
+           stats.fragmentation_permille / 10u, stats.fragmentation_permille % 10u,
+           stats.max_fragmentation_permille / 10u, stats.max_fragmentation_permille % 10u);
+    printf("Heap: %lu allocations, %lu frees, %lu failed\n",
+           (unsigned long)stats.allocations, (unsigned long)stats.frees,
+           (unsigned long)stats.failed_allocations);
+}
+
+void heapmon_malloc_failed(void) {
+    failed_allocations++;
+    printf("Heap: allocation failed, %lu bytes free\n", (unsigned long)xPortGetFreeHeapSize());
+}
+
+#endif /* appUSE_HEAP_MONITOR */
@@ -0,0 +1,79 @@
+/**
+ * @file heapmon.h
+ *
+ * @brief FreeRTOS heap usage and fragmentation telemetry.
+ *
+ * A software timer periodically reads vPortGetHeapStats() of the heap_4
+ * allocator and keeps the minimum free space, the smallest largest-free-block
+ * and the highest fragmentation seen. Fragmentation is reported as
+ * 1 - largest free block / total free space, i.e. 0 % if all free memory is
+ * one contiguous block.
+ *
+ * Requirements in FreeRTOSConfig.h:
+ * - appUSE_HEAP_MONITOR 1
+ * - configUSE_TIMERS 1
+ * - configUSE_MALLOC_FAILED_HOOK 1 (optional, reports failed allocations)
+ * - linked with FreeRTOS-Kernel-Heap4 (or heap_5)
+ */
+
+#ifndef HEAPMON_H
+#define HEAPMON_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+/**
+ * @brief Heap statistics.
+ */
+typedef struct {
+    size_t total_bytes;             /* configTOTAL_HEAP_SIZE */
+    size_t free_bytes;              /* Currently free */
+    size_t min_free_bytes;          /* Lowest free space since startup */
+    size_t largest_free_block;      /* Largest block that can be allocated now */
+    size_t min_largest_free_block;  /* Lowest largest block seen by the sampler */
+    size_t free_blocks;             /* Number of free blocks */
+    size_t allocations;             /* Successful pvPortMalloc() calls */
+    size_t frees;                   /* Successful vPortFree() calls */
+    uint32_t failed_allocations;    /* Calls to the malloc-failed hook */
+    uint16_t fragmentation_permille;     /* Current fragmentation */
+    uint16_t max_fragmentation_permille; /* Highest fragmentation seen */
+} heapmon_stats_t;
+
+/**
+ * @brief Starts periodic sampling.
+ *
+ * @param period Sampling period in ticks.
+ * @return BaseType_t pdPASS if the sampling timer was started.
+ */
+BaseType_t heapmon_start(TickType_t period);
+
+/**
+ * @brief Samples the heap once. Must be called from a task.
+ */
+void heapmon_sample(void);
+
+/**
+ * @brief Samples the heap and returns the statistics.
+ *
+ * @param stats Filled with the current statistics.
+ */
+void heapmon_get(heapmon_stats_t *stats);
+
+/**
+ * @brief Requests a report, printed by the sampling timer.
+ */
+void heapmon_request_report(void);
+
+/**
+ * @brief Samples the heap and prints the statistics.
+ */
+void heapmon_report(void);
+
+/**
+ * @brief Counts a failed allocation. Called from
+ *        vApplicationMallocFailedHook() (rtos_hooks.c).
+ */
+void heapmon_malloc_failed(void);
+
+#endif /* HEAPMON_H */
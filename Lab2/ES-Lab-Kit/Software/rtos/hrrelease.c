@@ -0,0 +1,151 @@
+/**
+ * @file hrrelease.c
+ *
+ * @brief Microsecond-precision releases of periodic tasks from hardware
+ *        timer alarms.
+ */
+
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "pico/stdlib.h"
+#include "histo.h"
+#include "hrrelease.h"
+
+#if appUSE_HR_RELEASE
+
+#define TICK_US             ( 1000000u / configTICK_RATE_HZ )
+
+struct hrrelease {
+    const char *name;
+    TaskHandle_t task;
+    hrrelease_mode_t mode;
+    uint32_t period_us;
+    TickType_t period_ticks;    /* HRRELEASE_DELAY_UNTIL */
+    TickType_t last_wake;       /* HRRELEASE_DELAY_UNTIL */
+    uint64_t release_us;        /* Release of the current job */
+    uint32_t jobs;
+    uint32_t late;              /* Releases that had passed when the job ended */
+    histo_t lateness;           /* Wake-up - release */
+};
+
+static hrrelease_t releases[HRRELEASE_MAX_TASKS];
+static volatile UBaseType_t num_releases;
+
+/**
+ * @brief Alarm at a release, wakes the task.
+ */
+static int64_t alarm_fired(alarm_id_t id, void *arg) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    vTaskNotifyGiveIndexedFromISR(((hrrelease_t *)arg)->task, HRRELEASE_NOTIFY_INDEX,
+                                  &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    return 0;   /* One-shot, the task sets the next alarm */
+}
+
+hrrelease_t *hrrelease_start(const char *name, uint32_t period_us, hrrelease_mode_t mode) {
+    hrrelease_t *r;
+
+    if (mode == HRRELEASE_DELAY_UNTIL) {
+        vTaskDelay(1);      /* Start on a tick, xTaskDelayUntil() releases on ticks */
+    }
+    taskENTER_CRITICAL();
+    if (num_releases >= HRRELEASE_MAX_TASKS) {
+        taskEXIT_CRITICAL();
+        return NULL;
+    }
+    r = &releases[num_releases];
+    r->name = name;
+    r->task = xTaskGetCurrentTaskHandle();
+    r->mode = mode;
+    r->period_ticks = (period_us >= TICK_US) ? (TickType_t)(period_us / TICK_US) : 1;
+    r->period_us = (mode == HRRELEASE_DELAY_UNTIL) ? r->period_ticks * TICK_US : period_us;
+    r->last_wake = xTaskGetTickCount();
+    r->release_us = time_us_64();
+    r->jobs = 0;
+    r->late = 0;
+    histo_init(&r->lateness);
+    num_releases++;
+    taskEXIT_CRITICAL();
+
+    return r;
+}
+
+BaseType_t hrrelease_wait(hrrelease_t *r) {
+    uint64_t now;
+
+    r->jobs++;
+    r->release_us += r->period_us;
+
+    if (r->mode == HRRELEASE_DELAY_UNTIL) {
+        /* The kernel keeps the releases; a wake-up can come a little before release_us
+         * if the first one was later after its tick */
+        BaseType_t delayed = xTaskDelayUntil(&r->last_wake, r->period_ticks);
+
+        now = time_us_64();
+        if (delayed == pdFALSE) {
+            r->late++;
+        }
+        histo_add(&r->lateness, (now > r->release_us) ? (uint32_t)(now - r->release_us) : 0u);
+        return delayed;
+    }
+
+    now = time_us_64();
+    if (now >= r->release_us) {
+        r->late++;
+        histo_add(&r->lateness, (uint32_t)(now - r->release_us));
+        return pdFALSE;
+    }
+
+    if (r->mode == HRRELEASE_TICK) {
+        /* First tick at or after the release: the phase of the tick is unknown, so sleep
+         * the whole ticks that surely end before the release, then tick by tick */
+        TickType_t ticks = (TickType_t)((r->release_us - now) / TICK_US);
+
+        if (ticks > 0) {
+            vTaskDelay(ticks);
+        }
+        while (time_us_64() < r->release_us) {
+            vTaskDelay(1);
+        }
+    } else {
+        /* The alarm may fire before the task blocks; the notification is kept until then */
+        ulTaskNotifyTakeIndexed(HRRELEASE_NOTIFY_INDEX, pdTRUE, 0);
+        if (add_alarm_at(from_us_since_boot(r->release_us), alarm_fired, r, false) > 0) {
+            ulTaskNotifyTakeIndexed(HRRELEASE_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+        }
+        /* 0: the release passed meanwhile, < 0: no alarm slot; continue at once */
+    }
+
+    now = time_us_64();
+    histo_add(&r->lateness, (uint32_t)(now - r->release_us));
+    return pdTRUE;
+}
+
+uint64_t hrrelease_time(const hrrelease_t *r) {
+    return r->release_us;
+}
+
+void hrrelease_report(void) {
+    for (UBaseType_t i = 0; i < num_releases; i++) {
+        const hrrelease_t *r = &releases[i];
+
+        printf("Release: %-12s %s, period %lu us, %lu jobs, %lu late\n", r->name,
+               (r->mode == HRRELEASE_TICK) ? "tick" : (r->mode == HRRELEASE_DELAY_UNTIL) ? "delay until" : "alarm",
+               (unsigned long)r->period_us,
+               (unsigned long)r->jobs, (unsigned long)r->late);
+        histo_print(&r->lateness, stdout);
+    }
+}
+
+static void report_callback(void *unused1, uint32_t unused2) {
+    hrrelease_report();
+}
+
+void hrrelease_request_report(void) {
+    xTimerPendFunctionCall(report_callback, NULL, 0, 0);
+}
+
+#endif /* appUSE_HR_RELEASE */
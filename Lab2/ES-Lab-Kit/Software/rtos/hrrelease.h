@@ -0,0 +1,112 @@
+/**
+ * @file hrrelease.h
+ *
+ * @brief Microsecond-precision releases of periodic tasks from hardware
+ *        timer alarms.
+ *
+ * xTaskDelayUntil() can only release a task on a tick. With the 1 kHz tick
+ * a release that falls between two ticks is delayed by up to 1 ms, and a
+ * period that is no multiple of the tick cannot be kept at all. Here the
+ * release instants are kept in microseconds. hrrelease_wait() sets an alarm
+ * of the Pico SDK alarm pool (a hardware timer alarm, as used by
+ * add_repeating_timer_ms()) at the next release; the alarm interrupt wakes
+ * the task with a task notification. The release is thus delayed only by
+ * the interrupt and the context switch, a few microseconds, independent of
+ * configTICK_RATE_HZ.
+ *
+ * For comparison a release can be created in two tick-based modes:
+ * - HRRELEASE_DELAY_UNTIL waits with xTaskDelayUntil() itself. The period
+ *   is rounded down to whole ticks and the releases are the ticks, so a
+ *   2.5 ms period becomes 2 ms.
+ * - HRRELEASE_TICK keeps the microsecond release instants but waits for the
+ *   first tick at or after each of them (vTaskDelay() in whole ticks),
+ *   which shows the tick lateness at any period.
+ *
+ * Every wake-up records the lateness (wake-up time - release time) in a
+ * histogram (histo.h); its spread is the release jitter. hrrelease_report()
+ * prints the histograms of all releases.
+ *
+ * Requirements in FreeRTOSConfig.h:
+ * - appUSE_HR_RELEASE 1
+ * - configTASK_NOTIFICATION_ARRAY_ENTRIES > HRRELEASE_NOTIFY_INDEX, so the
+ *   wake-ups do not mix with other notifications of the task
+ * - configUSE_TIMERS 1 and INCLUDE_xTimerPendFunctionCall 1
+ * - INCLUDE_xTaskDelayUntil 1 for HRRELEASE_DELAY_UNTIL
+ */
+
+#ifndef HRRELEASE_H
+#define HRRELEASE_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Maximum number of periodic tasks.
+ */
+#define HRRELEASE_MAX_TASKS         8
+
+/**
+ * @brief Notification index of the wake-ups.
+ */
+#define HRRELEASE_NOTIFY_INDEX      1
+
+/**
+ * @brief How the task waits for its releases.
+ */
+typedef enum {
+    HRRELEASE_ALARM = 0,        /* Hardware timer alarm at the release */
+    HRRELEASE_TICK,             /* First tick at or after the release */
+    HRRELEASE_DELAY_UNTIL       /* xTaskDelayUntil(), period in whole ticks */
+} hrrelease_mode_t;
+
+/**
+ * @brief Release handle.
+ */
+typedef struct hrrelease hrrelease_t;
+
+/**
+ * @brief Starts the periodic releases of the calling task. The first job is
+ *        released now, in HRRELEASE_DELAY_UNTIL mode at the next tick.
+ *
+ * @param name Name in the report.
+ * @param period_us Period in us.
+ * @param mode Alarm or tick releases.
+ * @return hrrelease_t* Release handle, or NULL if the table is full.
+ */
+hrrelease_t *hrrelease_start(const char *name, uint32_t period_us, hrrelease_mode_t mode);
+
+/**
+ * @brief Ends the current job and waits for the next release.
+ *
+ * Drop-in replacement for xTaskDelayUntil(). A release that has already
+ * passed is not skipped; the task continues at once.
+ *
+ * @param r Release handle.
+ * @return BaseType_t pdFALSE if the next release had already passed,
+ *                    pdTRUE otherwise.
+ */
+BaseType_t hrrelease_wait(hrrelease_t *r);
+
+/**
+ * @brief Returns the release time of the current job, e.g. to compute its
+ *        response time.
+ *
+ * @param r Release handle.
+ * @return uint64_t Release time in us since boot.
+ */
+uint64_t hrrelease_time(const hrrelease_t *r);
+
+/**
+ * @brief Prints the jobs, late releases and the lateness histogram of every
+ *        task.
+ */
+void hrrelease_report(void);
+
+/**
+ * @brief Prints the report from the timer service task; can be called from
+ *        any task.
+ */
+void hrrelease_request_report(void);
+
+#endif /* HRRELEASE_H */
@@ -0,0 +1,91 @@
+/**
+ * @file latency.c
+ *
+ * @brief End-to-end cause-effect latency of task chains.
+ */
+
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "pico/stdlib.h"
+#include "latstat.h"
+#include "latency.h"
+
+#if appUSE_LATENCY_TRACE
+
+/**
+ * @brief State of one chain.
+ */
+typedef struct {
+    const char *name;
+    latency_tag_t completed;    /* Last tag counted by latency_complete() */
+    latstat_t hop;              /* Capture until forwarded */
+    latstat_t end_to_end;       /* Capture until received by the consumer */
+} latency_chain_t;
+
+static latency_chain_t chains[LATENCY_MAX_CHAINS];
+static volatile int num_chains;
+
+static void print_report(void *arg, uint32_t unused) {
+    latency_report();
+}
+
+int latency_chain_register(const char *name) {
+    latency_chain_t *c;
+
+    if (num_chains >= LATENCY_MAX_CHAINS) {
+        return -1;
+    }
+
+    c = &chains[num_chains];
+    c->name = name;
+    c->completed = LATENCY_NO_TAG;
+    latstat_init(&c->hop);
+    latstat_init(&c->end_to_end);
+
+    return num_chains++;    /* Publish the entry last, the hook may already run. */
+}
+
+latency_tag_t latency_capture(void) {
+    latency_tag_t tag = time_us_32();
+
+    return (tag == LATENCY_NO_TAG) ? 1u : tag;
+}
+
+void latency_forward(int chain, latency_tag_t tag) {
+    if ((chain >= 0) && (tag != LATENCY_NO_TAG)) {
+        latstat_add(&chains[chain].hop, time_us_32() - tag);
+    }
+}
+
+void latency_complete(int chain, latency_tag_t tag) {
+    if ((chain >= 0) && (tag != LATENCY_NO_TAG) && (tag != chains[chain].completed)) {
+        latstat_add(&chains[chain].end_to_end, time_us_32() - tag);
+        chains[chain].completed = tag;
+    }
+}
+
+void latency_request_report(void) {
+    xTimerPendFunctionCall(print_report, NULL, 0, 0);
+}
+
+void latency_report(void) {
+    printf("Latency (us):      %-20s %-20s\n", "hop min/avg/max", "end-to-end min/avg/max");
+
+    for (int i = 0; i < num_chains; i++) {
+        const latency_chain_t *c = &chains[i];
+
+        if (c->end_to_end.count == 0) {
+            printf("  %-16s no events\n", c->name);
+            continue;
+        }
+        printf("  %-16s %6lu/%6lu/%6lu %6lu/%6lu/%6lu (%lu events)\n", c->name,
+               (unsigned long)c->hop.min_us, (unsigned long)latstat_avg(&c->hop),
+               (unsigned long)c->hop.max_us,
+               (unsigned long)c->end_to_end.min_us, (unsigned long)latstat_avg(&c->end_to_end),
+               (unsigned long)c->end_to_end.max_us, (unsigned long)c->end_to_end.count);
+    }
+}
+
+#endif /* appUSE_LATENCY_TRACE */
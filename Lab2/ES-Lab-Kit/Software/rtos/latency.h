@@ -0,0 +1,87 @@
+/**
+ * @file latency.h
+ *
+ * @brief End-to-end cause-effect latency of task chains.
+ *
+ * An input is tagged with its capture time when it is sampled. Every stage
+ * of the chain passes the tag on together with the data it produces, e.g.
+ * as a field of its blackboard section. The stage that reacts to the input
+ * calls latency_forward(), the consumer at the end of the chain calls
+ * latency_complete() with the tag it received.
+ *
+ * Two values are kept per chain:
+ * - hop: capture until the reacting stage forwarded the tag
+ * - end-to-end: capture until the consumer received the tag
+ *
+ * Requirements in FreeRTOSConfig.h:
+ * - appUSE_LATENCY_TRACE 1
+ * - configUSE_TIMERS 1 and INCLUDE_xTimerPendFunctionCall 1
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Maximum number of chains.
+ */
+#define LATENCY_MAX_CHAINS          4
+
+/**
+ * @brief Capture time of an input in us, carried through the chain.
+ */
+typedef uint32_t latency_tag_t;
+
+/**
+ * @brief Tag value meaning "no event".
+ */
+#define LATENCY_NO_TAG              0u
+
+/**
+ * @brief Registers a chain.
+ *
+ * @param name Name printed in the report.
+ * @return int Chain number, or -1 if the table is full.
+ */
+int latency_chain_register(const char *name);
+
+/**
+ * @brief Returns a tag with the current time. Call it right before the
+ *        input is sampled.
+ *
+ * @return latency_tag_t Tag, never LATENCY_NO_TAG.
+ */
+latency_tag_t latency_capture(void);
+
+/**
+ * @brief Records the hop latency of a tag. Call it when the stage that
+ *        reacts to the input publishes its result.
+ *
+ * @param chain Chain number.
+ * @param tag Tag of the input.
+ */
+void latency_forward(int chain, latency_tag_t tag);
+
+/**
+ * @brief Records the end-to-end latency of a tag. Call it when the consumer
+ *        has read the result. A tag is counted only the first time.
+ *
+ * @param chain Chain number.
+ * @param tag Tag received by the consumer.
+ */
+void latency_complete(int chain, latency_tag_t tag);
+
+/**
+ * @brief Requests a report, printed by the timer service task.
+ */
+void latency_request_report(void);
+
+/**
+ * @brief Prints min/avg/max hop and end-to-end latency of all chains.
+ */
+void latency_report(void);
+
+#endif /* LATENCY_H */
@@ -0,0 +1,212 @@
+/**
+ * @file loadmon.c
+ *
+ * @brief Idle-time based CPU load monitor.
+ */
+
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "pico/stdlib.h"
+#include "loadmon.h"
+
+#if appUSE_LOAD_MONITOR
+
+#if configNUMBER_OF_CORES > 1
+#define CURRENT_CORE()      ((unsigned)portGET_CORE_ID())
+#else
+#define CURRENT_CORE()      0u
+#endif
+
+/**
+ * @brief Accounting of one core. The switch hook of a core and the tick hook
+ *        (on the tick core) both run with the kernel's ISR lock held, so
+ *        they never see a half-updated entry.
+ */
+typedef struct {
+    loadwin_t window;               /* Sliding windows, updated from the tick hook */
+    bool overloaded;
+    TaskHandle_t running_task;
+    uint32_t switched_in_us;        /* Time the running task was switched in */
+    uint32_t idle_total_us;         /* Idle time of all completed idle slices */
+    uint32_t last_idle_us;          /* Idle time at the previous tick */
+    uint16_t peak_permille;         /* Highest 100 ms utilisation */
+    uint32_t total_misses;
+} core_t;
+
+static core_t cores[configNUMBER_OF_CORES];
+
+/**
+ * @brief Overload thresholds and callback.
+ */
+static loadwin_limits_t limits;
+static loadmon_callback_t callback;
+static bool overloaded;
+
+/**
+ * @brief Idle tasks; in SMP builds they are not bound to a core.
+ */
+static TaskHandle_t idle_tasks[configNUMBER_OF_CORES];
+
+/**
+ * @brief Time of the previous tick.
+ */
+static uint32_t last_tick_us;
+
+/**
+ * @brief Runs in the timer service task and forwards the event.
+ */
+static void dispatch_event(void *unused, uint32_t event) {
+    if (callback != NULL) {
+        callback((event >> 16) != 0, (uint16_t)(event & 0xFFFFu));
+    }
+}
+
+static bool is_idle(TaskHandle_t task) {
+    if (idle_tasks[0] == NULL) {
+#if configNUMBER_OF_CORES > 1
+        for (unsigned i = 0; i < configNUMBER_OF_CORES; i++) {
+            idle_tasks[i] = xTaskGetIdleTaskHandleForCore((BaseType_t)i);
+        }
+#else
+        idle_tasks[0] = xTaskGetIdleTaskHandle();
+#endif
+    }
+    for (unsigned i = 0; i < configNUMBER_OF_CORES; i++) {
+        if (task == idle_tasks[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void loadmon_init(const loadwin_limits_t *lim, loadmon_callback_t cb) {
+    limits = *lim;
+    callback = cb;
+    overloaded = false;
+    last_tick_us = time_us_32();
+    for (unsigned i = 0; i < configNUMBER_OF_CORES; i++) {
+        loadwin_init(&cores[i].window);
+        cores[i].switched_in_us = last_tick_us;
+    }
+}
+
+void loadmon_deadline_miss(void) {
+    taskENTER_CRITICAL();
+    loadwin_add_miss(&cores[CURRENT_CORE()].window);
+    cores[CURRENT_CORE()].total_misses++;
+    taskEXIT_CRITICAL();
+}
+
+uint16_t loadmon_utilisation(loadwin_level_t level) {
+    uint16_t max = 0;
+
+    for (unsigned i = 0; i < configNUMBER_OF_CORES; i++) {
+        uint16_t permille = loadwin_utilisation(&cores[i].window, level);
+
+        max = (permille > max) ? permille : max;
+    }
+    return max;
+}
+
+uint32_t loadmon_misses(loadwin_level_t level) {
+    uint32_t sum = 0;
+
+    for (unsigned i = 0; i < configNUMBER_OF_CORES; i++) {
+        sum += loadwin_misses(&cores[i].window, level);
+    }
+    return sum;
+}
+
+uint16_t loadmon_core_utilisation(unsigned core, loadwin_level_t level) {
+    return (core < configNUMBER_OF_CORES) ? loadwin_utilisation(&cores[core].window, level) : 0;
+}
+
+uint32_t loadmon_core_misses(unsigned core, loadwin_level_t level) {
+    return (core < configNUMBER_OF_CORES) ? loadwin_misses(&cores[core].window, level) : 0;
+}
+
+uint32_t loadmon_core_idle_us(unsigned core) {
+    return (core < configNUMBER_OF_CORES) ? cores[core].last_idle_us : 0;
+}
+
+bool loadmon_overloaded(void) {
+    return overloaded;
+}
+
+void loadmon_report(void) {
+    printf("Load (permille)   10ms  100ms     1s   peak  headroom  misses\n");
+    for (unsigned i = 0; i < configNUMBER_OF_CORES; i++) {
+        const core_t *c = &cores[i];
+
+        printf("  core %u         %5u  %5u  %5u  %5u     %5u  %6lu\n", i,
+               loadwin_utilisation(&c->window, LOADWIN_10MS),
+               loadwin_utilisation(&c->window, LOADWIN_100MS),
+               loadwin_utilisation(&c->window, LOADWIN_1S),
+               c->peak_permille, 1000u - c->peak_permille, (unsigned long)c->total_misses);
+    }
+}
+
+static void report_callback(void *unused1, uint32_t unused2) {
+    loadmon_report();
+}
+
+void loadmon_request_report(void) {
+    xTimerPendFunctionCall(report_callback, NULL, 0, 0);
+}
+
+void loadmon_task_switched_in(void) {
+    core_t *c = &cores[CURRENT_CORE()];
+    uint32_t now = time_us_32();
+
+    if (is_idle(c->running_task)) {
+        c->idle_total_us += now - c->switched_in_us;
+    }
+    c->running_task = xTaskGetCurrentTaskHandle();
+    c->switched_in_us = now;
+}
+
+void loadmon_tick_from_isr(void) {
+    uint32_t now = time_us_32();
+    uint32_t elapsed = now - last_tick_us;
+    bool state = false;
+    uint16_t permille = 0;
+
+    last_tick_us = now;
+
+    for (unsigned i = 0; i < configNUMBER_OF_CORES; i++) {
+        core_t *c = &cores[i];
+        uint32_t idle = c->idle_total_us;
+        uint32_t idle_delta;
+        uint16_t load;
+
+        /* Include the idle slice that is still running. */
+        if ((c->running_task != NULL) && is_idle(c->running_task)) {
+            idle += now - c->switched_in_us;
+        }
+        idle_delta = idle - c->last_idle_us;
+        c->last_idle_us = idle;
+
+        loadwin_add(&c->window, (idle_delta < elapsed) ? elapsed - idle_delta : 0, elapsed);
+
+        load = loadwin_utilisation(&c->window, LOADWIN_100MS);
+        c->peak_permille = (load > c->peak_permille) ? load : c->peak_permille;
+
+        c->overloaded = loadwin_check(&c->window, &limits, c->overloaded);
+        state = state || c->overloaded;
+        load = loadwin_utilisation(&c->window, limits.level);
+        permille = (load > permille) ? load : permille;
+    }
+
+    if (state != overloaded) {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        uint32_t event = ((uint32_t)state << 16) | permille;
+
+        overloaded = state;
+        xTimerPendFunctionCallFromISR(dispatch_event, NULL, event, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+}
+
+#endif /* appUSE_LOAD_MONITOR */
@@ -0,0 +1,124 @@
+/**
+ * @file loadmon.h
+ *
+ * @brief Idle-time based CPU load monitor.
+ *
+ * The monitor timestamps every switch into and out of the idle task
+ * (traceTASK_SWITCHED_IN) and feeds the busy time into the sliding windows
+ * of loadwin.h from the tick hook. When the utilisation or the number of
+ * reported deadline misses crosses the configured thresholds, the
+ * registered callback is executed in the context of the timer service task.
+ *
+ * In an SMP build (configNUMBER_OF_CORES > 1) every core has its own
+ * windows: the idle time is accounted per core and a deadline miss counts
+ * on the core that reports it. The system is overloaded when any core
+ * crosses the thresholds. loadmon_report() prints the load and the
+ * remaining headroom of each core.
+ *
+ * Requirements in FreeRTOSConfig.h:
+ * - appUSE_LOAD_MONITOR 1
+ * - configUSE_TICK_HOOK 1
+ * - configUSE_TIMERS 1 and INCLUDE_xTimerPendFunctionCall 1
+ */
+
+#ifndef LOADMON_H
+#define LOADMON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "loadwin.h"
+
+/**
+ * @brief Overload event callback.
+ *
+ * @param overloaded true when the system entered overload, false when it
+ *                   returned to normal operation.
+ * @param permille Utilisation of the monitored window at the event.
+ */
+typedef void (*loadmon_callback_t)(bool overloaded, uint16_t permille);
+
+/**
+ * @brief Initialises the load monitor. Call before vTaskStartScheduler().
+ *
+ * @param limits Overload thresholds (copied).
+ * @param callback Function called on every overload state change, or NULL.
+ */
+void loadmon_init(const loadwin_limits_t *limits, loadmon_callback_t callback);
+
+/**
+ * @brief Reports a deadline miss, e.g. when xTaskDelayUntil() returns pdFALSE.
+ */
+void loadmon_deadline_miss(void);
+
+/**
+ * @brief Returns the utilisation of a window of the busiest core.
+ *
+ * @param level Window to read.
+ * @return uint16_t Utilisation in permille.
+ */
+uint16_t loadmon_utilisation(loadwin_level_t level);
+
+/**
+ * @brief Returns the number of deadline misses within a window, all cores.
+ *
+ * @param level Window to read.
+ * @return uint32_t Number of misses.
+ */
+uint32_t loadmon_misses(loadwin_level_t level);
+
+/**
+ * @brief Returns the utilisation of a window of one core.
+ *
+ * @param core Core, 0..configNUMBER_OF_CORES - 1.
+ * @param level Window to read.
+ * @return uint16_t Utilisation in permille.
+ */
+uint16_t loadmon_core_utilisation(unsigned core, loadwin_level_t level);
+
+/**
+ * @brief Returns the number of deadline misses of one core within a window.
+ *
+ * @param core Core, 0..configNUMBER_OF_CORES - 1.
+ * @param level Window to read.
+ * @return uint32_t Number of misses.
+ */
+uint32_t loadmon_core_misses(unsigned core, loadwin_level_t level);
+
+/**
+ * @brief Returns the idle time of one core since the start, up to the last
+ *        tick, e.g. to measure the busy time over a test run. Wraps after
+ *        about 71 minutes.
+ *
+ * @param core Core, 0..configNUMBER_OF_CORES - 1.
+ * @return uint32_t Idle time in us.
+ */
+uint32_t loadmon_core_idle_us(unsigned core);
+
+/**
+ * @brief Prints the load, the peak 100 ms load and the headroom (1000 - peak)
+ *        of each core, and the deadline misses since the start.
+ */
+void loadmon_report(void);
+
+/**
+ * @brief Prints loadmon_report() from the timer service task, callable from
+ *        time-critical tasks.
+ */
+void loadmon_request_report(void);
+
+/**
+ * @brief Returns the current overload state.
+ */
+bool loadmon_overloaded(void);
+
+/**
+ * @brief Kernel hook, called from traceTASK_SWITCHED_IN (rtos_hooks.c).
+ */
+void loadmon_task_switched_in(void);
+
+/**
+ * @brief Kernel hook, called from the tick hook (rtos_hooks.c).
+ */
+void loadmon_tick_from_isr(void);
+
+#endif /* LOADMON_H */
@@ -0,0 +1,73 @@
+/**
+ * @file rtos_hooks.c
+ *
+ * @brief Kernel hook functions shared by the RTOS monitoring modules.
+ *
+ * FreeRTOS allows only one definition of each hook, so the hooks live here
+ * and forward to the modules enabled in FreeRTOSConfig.h.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "rtos_hooks.h"
+#include "loadmon.h"
+#include "budget.h"
+#include "server.h"
+#include "stackprof.h"
+#include "heapmon.h"
+#include "supervisor.h"
+
+void rtos_hooks_task_switched_in(void) {
+#if appUSE_LOAD_MONITOR
+    loadmon_task_switched_in();
+#endif
+#if appUSE_BUDGET_MONITOR
+    budget_task_switched_in();
+#endif
+#if appUSE_APERIODIC_SERVER
+    server_task_switched_in();
+#endif
+#if appUSE_WATCHDOG_SUPERVISOR
+    sup_task_switched_in();
+#endif
+}
+/*-----------------------------------------------------------*/
+
+#if configUSE_TICK_HOOK
+void vApplicationTickHook(void) {
+#if appUSE_LOAD_MONITOR
+    loadmon_tick_from_isr();
+#endif
+#if appUSE_BUDGET_MONITOR
+    budget_tick_from_isr();
+#endif
+#if appUSE_APERIODIC_SERVER
+    server_tick_from_isr();
+#endif
+}
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configCHECK_FOR_STACK_OVERFLOW > 0 )
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
+#if appUSE_STACK_PROFILER
+    stackprof_overflow(xTask, pcTaskName);
+#else
+    taskDISABLE_INTERRUPTS();
+    for (;;) {
+        /* Halt, the kernel state can no longer be trusted. */
+    }
+#endif
+}
+#endif
+/*-----------------------------------------------------------*/
+
+#if configUSE_MALLOC_FAILED_HOOK
+void vApplicationMallocFailedHook(void) {
+#if appUSE_HEAP_MONITOR
+    heapmon_malloc_failed();
+#endif
+    /* The caller receives NULL and decides how to handle it. */
+}
+#endif
+/*-----------------------------------------------------------*/
@@ -0,0 +1,121 @@
+/**
+ * @file rtos_hooks.h
+ *
+ * @brief Kernel trace macros and feature switches of the RTOS monitoring
+ *        modules.
+ *
+ * This header is included at the end of FreeRTOSConfig.h. It must therefore
+ * not use any FreeRTOS types. A project enables a module by defining the
+ * corresponding appUSE_... switch to 1 in its FreeRTOSConfig.h.
+ */
+
+#ifndef RTOS_HOOKS_H
+#define RTOS_HOOKS_H
+
+/**
+ * @brief Idle-time based CPU load monitor (loadmon.h).
+ */
+#ifndef appUSE_LOAD_MONITOR
+#define appUSE_LOAD_MONITOR                     0
+#endif
+
+/**
+ * @brief Per-task execution-time budgets (budget.h).
+ */
+#ifndef appUSE_BUDGET_MONITOR
+#define appUSE_BUDGET_MONITOR                   0
+#endif
+
+/**
+ * @brief Stack high-water-mark profiler (stackprof.h).
+ */
+#ifndef appUSE_STACK_PROFILER
+#define appUSE_STACK_PROFILER                   0
+#endif
+
+/**
+ * @brief Heap usage and fragmentation telemetry (heapmon.h).
+ */
+#ifndef appUSE_HEAP_MONITOR
+#define appUSE_HEAP_MONITOR                     0
+#endif
+
+/**
+ * @brief End-to-end cause-effect latency of task chains (latency.h).
+ */
+#ifndef appUSE_LATENCY_TRACE
+#define appUSE_LATENCY_TRACE                    0
+#endif
+
+/**
+ * @brief Earliest-deadline-first priorities for periodic tasks (edf.h).
+ */
+#ifndef appUSE_EDF_SCHEDULER
+#define appUSE_EDF_SCHEDULER                    0
+#endif
+
+/**
+ * @brief Admission control for load added at run time (admit.h).
+ */
+#ifndef appUSE_ADMISSION_CONTROL
+#define appUSE_ADMISSION_CONTROL                0
+#endif
+
+/**
+ * @brief Sporadic servers for aperiodic jobs (server.h).
+ */
+#ifndef appUSE_APERIODIC_SERVER
+#define appUSE_APERIODIC_SERVER                 0
+#endif
+
+/**
+ * @brief Mixed-criticality mode switch (critmode.h).
+ */
+#ifndef appUSE_CRITICALITY_MODE
+#define appUSE_CRITICALITY_MODE                 0
+#endif
+
+/**
+ * @brief Microsecond task releases from hardware timer alarms (hrrelease.h).
+ */
+#ifndef appUSE_HR_RELEASE
+#define appUSE_HR_RELEASE                       0
+#endif
+
+/**
+ * @brief Tickless idle on a hardware timer alarm (tickless.h).
+ */
+#ifndef appUSE_TICKLESS_IDLE
+#define appUSE_TICKLESS_IDLE                    0
+#endif
+
+/**
+ * @brief Hardware watchdog fed only while all critical tasks check in (supervisor.h).
+ */
+#ifndef appUSE_WATCHDOG_SUPERVISOR
+#define appUSE_WATCHDOG_SUPERVISOR              0
+#endif
+
+#ifndef __ASSEMBLER__
+
+/**
+ * @brief Called by the kernel each time a task has been selected to run.
+ */
+void rtos_hooks_task_switched_in(void);
+
+#define traceTASK_SWITCHED_IN()                 rtos_hooks_task_switched_in()
+
+#if appUSE_TICKLESS_IDLE
+#include <stdint.h>
+
+/**
+ * @brief Called by the idle task instead of the port's tickless idle.
+ */
+void tickless_sleep(uint32_t expected_idle);
+
+#define portSUPPRESS_TICKS_AND_SLEEP(xExpectedIdleTime) tickless_sleep(xExpectedIdleTime)
+#endif
+
+#endif /* __ASSEMBLER__ */
+
+#endif /* RTOS_HOOKS_H */
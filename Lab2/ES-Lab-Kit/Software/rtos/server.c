@@ -0,0 +1,371 @@
+/**
+ * @file server.c
+ *
+ * @brief Sporadic server for aperiodic jobs.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "timers.h"
+#include "pico/stdlib.h"
+#include "latstat.h"
+#include "server.h"
+
+#if appUSE_APERIODIC_SERVER
+
+#if configNUMBER_OF_CORES > 1
+#define CURRENT_CORE()      ((unsigned)portGET_CORE_ID())
+#else
+#define CURRENT_CORE()      0u
+#endif
+
+/**
+ * @brief Queued job.
+ */
+typedef struct {
+    server_job_t job;
+    void *arg;
+    uint32_t submitted_us;
+} request_t;
+
+/**
+ * @brief Budget given back at a later tick.
+ */
+typedef struct {
+    TickType_t at;
+    uint32_t amount_us;
+} replenishment_t;
+
+struct server {
+    server_config_t config;
+    TaskHandle_t task;
+    QueueHandle_t queue;
+    uint32_t capacity_us;       /* Budget left */
+    uint32_t consumed_us;       /* Consumed since the activation */
+    TickType_t activated_at;
+    bool active;                /* Work pending and budget left */
+    bool busy;                  /* A job is running */
+    bool exhausted;             /* Running at the background priority */
+    alarm_id_t budget_alarm;    /* Pending exhaustion alarm, 0 if none */
+    replenishment_t pending[SERVER_MAX_REPLENISHMENTS];
+    UBaseType_t num_pending;
+    uint32_t jobs;
+    uint32_t exhaustions;       /* Number of times the budget ran out */
+    uint32_t dropped;           /* Jobs not queued, the queue was full */
+    latstat_t response;         /* Submit to completion */
+};
+
+static server_t servers[SERVER_MAX_SERVERS];
+static volatile UBaseType_t num_servers;
+
+/**
+ * @brief Server running on each core (NULL if the task is no server) and the
+ *        time it was switched in or last charged.
+ */
+static server_t *running[configNUMBER_OF_CORES];
+static uint32_t charged_at_us[configNUMBER_OF_CORES];
+
+static server_t *find(TaskHandle_t task) {
+    for (UBaseType_t i = 0; i < num_servers; i++) {
+        if (servers[i].task == task) {
+            return &servers[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Charges the time since the last switch/tick to the budget of the
+ *        server running on a core. Only an active server consumes budget,
+ *        background execution is free. Must be called with interrupts masked
+ *        (in a critical section on SMP).
+ */
+static void charge_running(unsigned core, uint32_t now) {
+    server_t *s = running[core];
+
+    if ((s != NULL) && s->active) {
+        uint32_t used = now - charged_at_us[core];
+
+        if (used > s->capacity_us) {
+            used = s->capacity_us;  /* The overrun until the priority change is not carried over. */
+        }
+        s->capacity_us -= used;
+        s->consumed_us += used;
+    }
+    charged_at_us[core] = now;
+}
+
+static int64_t budget_alarm_fired(alarm_id_t id, void *arg);
+
+/**
+ * @brief The server becomes active: the consumed budget is replenished one
+ *        period after this time. The exhaustion alarm is set at the earliest
+ *        time the budget can run out; if no alarm is free, the tick hook
+ *        still sees the exhaustion.
+ */
+static void activate(server_t *s, TickType_t now) {
+    if (!s->active && !s->exhausted && (s->capacity_us > 0)) {
+        s->active = true;
+        s->activated_at = now;
+        s->consumed_us = 0;
+        if (s->budget_alarm <= 0) {
+            s->budget_alarm = add_alarm_in_us(s->capacity_us, budget_alarm_fired, s, true);
+        }
+    }
+}
+
+/**
+ * @brief The server becomes idle or exhausted: schedules the replenishment of
+ *        the budget consumed since the activation.
+ */
+static void deactivate(server_t *s) {
+    replenishment_t *r;
+
+    if (!s->active) {
+        return;
+    }
+    s->active = false;
+    if (s->consumed_us == 0) {
+        return;
+    }
+    if (s->num_pending < SERVER_MAX_REPLENISHMENTS) {
+        r = &s->pending[s->num_pending++];
+        r->at = s->activated_at + s->config.period;
+        r->amount_us = s->consumed_us;
+    } else {
+        /* Merge into the last one: the budget comes back later, never earlier */
+        r = &s->pending[SERVER_MAX_REPLENISHMENTS - 1];
+        r->at = s->activated_at + s->config.period;
+        r->amount_us += s->consumed_us;
+    }
+}
+
+/**
+ * @brief Budget used up: continue in the background until replenished.
+ */
+static void exhaust(server_t *s) {
+    deactivate(s);
+    s->exhausted = true;
+    s->exhaustions++;
+}
+
+/**
+ * @brief Applies a priority change, runs in the timer service task.
+ */
+static void set_priority(void *arg, uint32_t priority) {
+    vTaskPrioritySet(((server_t *)arg)->task, (UBaseType_t)priority);
+}
+
+/**
+ * @brief Alarm at the earliest time the budget can run out. If the server
+ *        was preempted meanwhile, budget is left and the alarm is set again
+ *        for the rest; otherwise the server drops to the background priority
+ *        now instead of at the next tick.
+ */
+static int64_t budget_alarm_fired(alarm_id_t id, void *arg) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    server_t *s = (server_t *)arg;
+    uint32_t now = time_us_32();
+    int64_t again_us = 0;
+    bool change = false;
+    UBaseType_t saved;
+
+    saved = taskENTER_CRITICAL_FROM_ISR();
+    for (unsigned core = 0; core < configNUMBER_OF_CORES; core++) {
+        if (running[core] == s) {
+            charge_running(core, now);
+        }
+    }
+    if (s->active && (s->capacity_us == 0)) {
+        exhaust(s);
+        change = true;
+    } else if (s->active) {
+        again_us = s->capacity_us;
+    }
+    if (again_us == 0) {
+        s->budget_alarm = 0;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+
+    if (change) {
+        xTimerPendFunctionCallFromISR(set_priority, s, s->config.background_priority,
+                                      &xHigherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    return again_us;    /* > 0: again that many us from now */
+}
+
+static void server_loop(void *arg) {
+    server_t *s = (server_t *)arg;
+    request_t r;
+
+    for (;;) {
+        xQueueReceive(s->queue, &r, portMAX_DELAY);
+
+        taskENTER_CRITICAL();
+        s->busy = true;
+        activate(s, xTaskGetTickCount());
+        taskEXIT_CRITICAL();
+
+        r.job(r.arg);
+
+        taskENTER_CRITICAL();
+        charge_running(CURRENT_CORE(), time_us_32());
+        s->busy = false;
+        s->jobs++;
+        latstat_add(&s->response, time_us_32() - r.submitted_us);
+        if (uxQueueMessagesWaiting(s->queue) == 0) {
+            deactivate(s);
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+
+server_t *server_create(const server_config_t *config) {
+    server_t *s;
+
+    if (num_servers >= SERVER_MAX_SERVERS) {
+        return NULL;
+    }
+
+    s = &servers[num_servers];
+    s->config = *config;
+    s->capacity_us = config->budget_us;
+    s->consumed_us = 0;
+    s->active = false;
+    s->busy = false;
+    s->exhausted = false;
+    s->budget_alarm = 0;
+    s->num_pending = 0;
+    s->jobs = 0;
+    s->exhaustions = 0;
+    s->dropped = 0;
+    latstat_init(&s->response);
+
+    s->queue = xQueueCreate(config->queue_length, sizeof(request_t));
+    if (s->queue == NULL) {
+        return NULL;
+    }
+    if (xTaskCreate(server_loop, config->name, config->stack_words, s, config->priority,
+                    &s->task) != pdPASS) {
+        vQueueDelete(s->queue);
+        return NULL;
+    }
+    num_servers++;      /* Publish the entry last, the hooks may already run. */
+
+    return s;
+}
+
+BaseType_t server_submit(server_t *s, server_job_t job, void *arg) {
+    request_t r = { job, arg, time_us_32() };
+
+    if (xQueueSend(s->queue, &r, 0) != pdPASS) {
+        taskENTER_CRITICAL();
+        s->dropped++;
+        taskEXIT_CRITICAL();
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+BaseType_t server_submit_from_isr(server_t *s, server_job_t job, void *arg,
+                                  BaseType_t *pxHigherPriorityTaskWoken) {
+    request_t r = { job, arg, time_us_32() };
+    UBaseType_t saved;
+
+    if (xQueueSendFromISR(s->queue, &r, pxHigherPriorityTaskWoken) != pdPASS) {
+        saved = taskENTER_CRITICAL_FROM_ISR();
+        s->dropped++;
+        taskEXIT_CRITICAL_FROM_ISR(saved);
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+TaskHandle_t server_task(const server_t *s) {
+    return s->task;
+}
+
+void server_report(void) {
+    for (UBaseType_t i = 0; i < num_servers; i++) {
+        const server_t *s = &servers[i];
+
+        printf("Server: %-12s Q %6lu us, Ts %4lu ms, %lu jobs, response avg %lu us, max %lu us, "
+               "%lu exhausted, %lu dropped\n",
+               s->config.name, (unsigned long)s->config.budget_us,
+               (unsigned long)(s->config.period * portTICK_PERIOD_MS), (unsigned long)s->jobs,
+               (unsigned long)latstat_avg(&s->response), (unsigned long)s->response.max_us,
+               (unsigned long)s->exhaustions, (unsigned long)s->dropped);
+    }
+}
+
+static void report_callback(void *unused1, uint32_t unused2) {
+    server_report();
+}
+
+void server_request_report(void) {
+    xTimerPendFunctionCall(report_callback, NULL, 0, 0);
+}
+
+void server_task_switched_in(void) {
+    charge_running(CURRENT_CORE(), time_us_32());
+    running[CURRENT_CORE()] = find(xTaskGetCurrentTaskHandle());
+}
+
+void server_tick_from_isr(void) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    TickType_t now_tick = xTaskGetTickCountFromISR();
+    uint32_t now = time_us_32();
+    UBaseType_t saved;
+
+    for (UBaseType_t i = 0; i < num_servers; i++) {
+        server_t *s = &servers[i];
+        bool change = false;
+        UBaseType_t priority = 0;
+
+        saved = taskENTER_CRITICAL_FROM_ISR();
+        for (unsigned core = 0; core < configNUMBER_OF_CORES; core++) {
+            if (running[core] == s) {
+                charge_running(core, now);
+            }
+        }
+
+        if (s->active && (s->capacity_us == 0)) {
+            /* Missed by the alarm, e.g. no alarm was free */
+            exhaust(s);
+            change = true;
+            priority = s->config.background_priority;
+        }
+
+        while ((s->num_pending > 0) && ((int32_t)(now_tick - s->pending[0].at) >= 0)) {
+            s->capacity_us += s->pending[0].amount_us;
+            if (s->capacity_us > s->config.budget_us) {
+                s->capacity_us = s->config.budget_us;
+            }
+            s->num_pending--;
+            for (UBaseType_t j = 0; j < s->num_pending; j++) {
+                s->pending[j] = s->pending[j + 1];
+            }
+        }
+
+        if (s->exhausted && (s->capacity_us > 0)) {
+            s->exhausted = false;
+            change = true;
+            priority = s->config.priority;
+            if (s->busy || (uxQueueMessagesWaitingFromISR(s->queue) > 0)) {
+                activate(s, now_tick);
+            }
+        }
+        taskEXIT_CRITICAL_FROM_ISR(saved);
+
+        if (change) {
+            xTimerPendFunctionCallFromISR(set_priority, s, priority, &xHigherPriorityTaskWoken);
+        }
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+#endif /* appUSE_APERIODIC_SERVER */
@@ -0,0 +1,147 @@
+/**
+ * @file server.h
+ *
+ * @brief Sporadic server for aperiodic jobs.
+ *
+ * A server is a task with a reserved bandwidth: an execution budget Q per
+ * replenishment period Ts. Aperiodic jobs (UART commands, load bursts, ...)
+ * are queued to the server with server_submit() and run one after the other
+ * at the server priority as long as budget is left. When the budget is used
+ * up, the server drops to its background priority and continues only in
+ * otherwise idle time until budget is replenished. Aperiodic jobs thus get
+ * the response time of a high-priority task for the first Q us of work in
+ * each Ts, but can never take more than Q / Ts of the CPU from the tasks
+ * below the server priority.
+ *
+ * Replenishment follows the sporadic server rules: the budget consumed from
+ * the time the server becomes active (work pending and budget left) until
+ * it becomes idle or exhausted is given back Ts after that activation time.
+ * Unlike a deferrable server, which refills the full budget at every period
+ * boundary and can run 2Q back to back, the sporadic server runs at most Q
+ * plus its overrun (below) in any window of Ts. The response-time analysis
+ * (rta.h) and admission control (admit.h) may therefore treat it as a
+ * periodic task with WCET Q plus the overrun, period Ts and the server
+ * priority; admit.h charges one tick more than Q, which covers it.
+ *
+ * The consumed time is measured like the budgets (budget.h), from the
+ * switch-in timestamps and at every tick. On activation a one-shot alarm of
+ * the Pico SDK alarm pool is set at the earliest time the budget left can
+ * run out, and set again for the rest if the server was preempted. The
+ * exhaustion is thus seen within microseconds, not at the next tick. The
+ * priority change is applied in the timer service task, so the overrun is
+ * the alarm interrupt plus the switch to that task, if it has the highest
+ * priority. Without a free alarm the tick hook sees the exhaustion, an
+ * overrun of up to one tick.
+ *
+ * Requirements in FreeRTOSConfig.h:
+ * - appUSE_APERIODIC_SERVER 1
+ * - configUSE_TICK_HOOK 1
+ * - configUSE_TIMERS 1 and INCLUDE_xTimerPendFunctionCall 1, with
+ *   configTIMER_TASK_PRIORITY the highest priority
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Maximum number of servers.
+ */
+#define SERVER_MAX_SERVERS          2
+
+/**
+ * @brief Maximum number of pending replenishments per server; further ones
+ *        are merged into the last, which only delays budget.
+ */
+#define SERVER_MAX_REPLENISHMENTS   4
+
+/**
+ * @brief Aperiodic job, runs in the server task.
+ */
+typedef void (*server_job_t)(void *arg);
+
+/**
+ * @brief Parameters of a server.
+ */
+typedef struct {
+    const char *name;                   /* Name of the server task */
+    uint32_t budget_us;                 /* Budget Q per replenishment period */
+    TickType_t period;                  /* Replenishment period Ts in ticks */
+    UBaseType_t priority;               /* Priority while budget is left */
+    UBaseType_t background_priority;    /* Priority when exhausted */
+    UBaseType_t queue_length;           /* Maximum number of queued jobs */
+    configSTACK_DEPTH_TYPE stack_words; /* Stack of the server task */
+} server_config_t;
+
+/**
+ * @brief Server handle.
+ */
+typedef struct server server_t;
+
+/**
+ * @brief Creates a server and its task with the full budget.
+ *
+ * @param config Parameters, copied.
+ * @return server_t* Server, or NULL if the table is full or the task or
+ *                   queue could not be allocated.
+ */
+server_t *server_create(const server_config_t *config);
+
+/**
+ * @brief Queues a job to a server, does not block.
+ *
+ * @param s Server.
+ * @param job Job function.
+ * @param arg Argument passed to the job.
+ * @return BaseType_t pdPASS, or pdFAIL if the queue is full (counted as dropped).
+ */
+BaseType_t server_submit(server_t *s, server_job_t job, void *arg);
+
+/**
+ * @brief Queues a job to a server from an interrupt handler.
+ *
+ * @param s Server.
+ * @param job Job function.
+ * @param arg Argument passed to the job.
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the server task was
+ *                                  woken and a context switch is needed.
+ * @return BaseType_t pdPASS, or pdFAIL if the queue is full (counted as dropped).
+ */
+BaseType_t server_submit_from_isr(server_t *s, server_job_t job, void *arg,
+                                  BaseType_t *pxHigherPriorityTaskWoken);
+
+/**
+ * @brief Returns the task of a server, e.g. for the core affinity, the
+ *        stack profiler or admission control.
+ *
+ * @param s Server.
+ * @return TaskHandle_t Server task.
+ */
+TaskHandle_t server_task(const server_t *s);
+
+/**
+ * @brief Prints the jobs, response times (submit to completion), budget
+ *        exhaustions and dropped jobs of all servers.
+ */
+void server_report(void);
+
+/**
+ * @brief Prints the report from the timer service task; can be called from
+ *        any task.
+ */
+void server_request_report(void);
+
+/**
+ * @brief Kernel hook, called from traceTASK_SWITCHED_IN (rtos_hooks.c).
+ */
+void server_task_switched_in(void);
+
+/**
+ * @brief Kernel hook, called from the tick hook (rtos_hooks.c).
+ */
+void server_tick_from_isr(void);
+
+#endif /* SERVER_H */
@@ -0,0 +1,120 @@
+/**
+ * @file stackprof.c
+ *
+ * @brief Stack high-water-mark profiler and stack size recommendation.
+ */
+
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "stackprof.h"
+
+#if appUSE_STACK_PROFILER
+
+/**
+ * @brief Profiling data of one task.
+ */
+typedef struct {
+    TaskHandle_t task;
+    uint32_t depth_words;       /* Allocated depth */
+    uint32_t min_free_words;    /* Lowest high-water mark seen */
+} stackprof_task_t;
+
+static stackprof_task_t tasks[STACKPROF_MAX_TASKS];
+static UBaseType_t num_tasks;
+static volatile bool report_requested;
+static bool kernel_tasks_tracked;
+
+static void sample_timer_callback(TimerHandle_t xTimer) {
+    stackprof_sample();
+    if (report_requested) {
+        report_requested = false;
+        stackprof_report();
+    }
+}
+
+BaseType_t stackprof_track(TaskHandle_t task, uint32_t depth_words) {
+    if ((task == NULL) || (num_tasks >= STACKPROF_MAX_TASKS)) {
+        return pdFAIL;
+    }
+    tasks[num_tasks].task = task;
+    tasks[num_tasks].depth_words = depth_words;
+    tasks[num_tasks].min_free_words = depth_words;
+    num_tasks++;
+    return pdPASS;
+}
+
+BaseType_t stackprof_start(TickType_t period) {
+    TimerHandle_t xTimer = xTimerCreate("StackProf", period, pdTRUE, NULL, sample_timer_callback);
+
+    if (xTimer == NULL) {
+        return pdFAIL;
+    }
+    return xTimerStart(xTimer, 0);
+}
+
+void stackprof_sample(void) {
+    if (!kernel_tasks_tracked) {
+        /* Only available once the scheduler has been started. */
+        kernel_tasks_tracked = true;
+        for (BaseType_t core = 0; core < configNUMBER_OF_CORES; core++) {
+            stackprof_track(xTaskGetIdleTaskHandleForCore(core), configMINIMAL_STACK_SIZE);
+        }
+        stackprof_track(xTimerGetTimerDaemonTaskHandle(), configTIMER_TASK_STACK_DEPTH);
+    }
+
+    for (UBaseType_t i = 0; i < num_tasks; i++) {
+        uint32_t free_words = uxTaskGetStackHighWaterMark(tasks[i].task);
+
+        if (free_words < tasks[i].min_free_words) {
+            tasks[i].min_free_words = free_words;
+        }
+    }
+}
+
+void stackprof_request_report(void) {
+    report_requested = true;
+}
+
+void stackprof_report(void) {
+    uint32_t total_depth = 0;
+    uint32_t total_recommended = 0;
+
+    stackprof_sample();
+
+    printf("Stack profile (depth in words, margin %d %%):\n", STACKPROF_MARGIN_PERCENT);
+    printf("  %-16s %6s %6s %6s %11s\n", "Task", "Depth", "Peak", "Free", "Recommended");
+
+    for (UBaseType_t i = 0; i < num_tasks; i++) {
+        const stackprof_task_t *t = &tasks[i];
+        uint32_t peak = t->depth_words - t->min_free_words;
+        uint32_t recommended = peak + (peak * STACKPROF_MARGIN_PERCENT + 99) / 100;
+
+        recommended = (recommended + STACKPROF_ROUND_WORDS - 1) / STACKPROF_ROUND_WORDS * STACKPROF_ROUND_WORDS;
+        total_depth += t->depth_words;
+        total_recommended += recommended;
+
+        printf("  %-16s %6lu %6lu %6lu %11lu%s\n", pcTaskGetName(t->task),
+               (unsigned long)t->depth_words, (unsigned long)peak,
+               (unsigned long)t->min_free_words, (unsigned long)recommended,
+               (t->min_free_words == 0) ? "  <== EXHAUSTED" : "");
+    }
+
+    printf("  Total %lu bytes allocated, %lu bytes recommended\n",
+           (unsigned long)(total_depth * sizeof(StackType_t)),
+           (unsigned long)(total_recommended * sizeof(StackType_t)));
+    if (uxTaskGetNumberOfTasks() > num_tasks) {
+        printf("  %lu tasks not tracked\n", (unsigned long)(uxTaskGetNumberOfTasks() - num_tasks));
+    }
+}
+
+void stackprof_overflow(TaskHandle_t task, const char *name) {
+    taskDISABLE_INTERRUPTS();
+    printf("STACK OVERFLOW in task %s!\n", name);
+    for (;;) {
+        /* Halt, the kernel state can no longer be trusted. */
+    }
+}
+
+#endif /* appUSE_STACK_PROFILER */
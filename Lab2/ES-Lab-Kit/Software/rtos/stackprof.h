@@ -0,0 +1,90 @@
+/**
+ * @file stackprof.h
+ *
+ * @brief Stack high-water-mark profiler and stack size recommendation.
+ *
+ * The kernel paints every task stack with a known pattern when it creates
+ * the task. A software timer periodically samples
+ * uxTaskGetStackHighWaterMark() of all tracked tasks, which scans for the
+ * first overwritten word, and records the peak usage. The report prints
+ * the peak and a recommended stack depth including a safety margin, and
+ * how many tasks of the kernel were not tracked.
+ *
+ * In debug builds (NDEBUG not defined) the projects also enable
+ * configCHECK_FOR_STACK_OVERFLOW 2, and stackprof_overflow() is called from
+ * the overflow hook.
+ *
+ * Requirements in FreeRTOSConfig.h:
+ * - appUSE_STACK_PROFILER 1
+ * - INCLUDE_uxTaskGetStackHighWaterMark 1, INCLUDE_xTaskGetIdleTaskHandle 1
+ * - configUSE_TIMERS 1
+ */
+
+#ifndef STACKPROF_H
+#define STACKPROF_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Maximum number of profiled tasks (including the idle tasks and the
+ *        timer task).
+ */
+#define STACKPROF_MAX_TASKS         12
+
+/**
+ * @brief Safety margin added to the measured peak in percent.
+ */
+#define STACKPROF_MARGIN_PERCENT    25
+
+/**
+ * @brief Recommended depths are rounded up to a multiple of this (words).
+ */
+#define STACKPROF_ROUND_WORDS       16
+
+/**
+ * @brief Adds a task to the profiler.
+ *
+ * @param task Task handle.
+ * @param depth_words Stack depth passed to xTaskCreate() in words.
+ * @return BaseType_t pdPASS, or pdFAIL if the table is full.
+ */
+BaseType_t stackprof_track(TaskHandle_t task, uint32_t depth_words);
+
+/**
+ * @brief Starts periodic sampling. The idle task of every core and the timer
+ *        service task are added automatically at the first sample.
+ *
+ * @param period Sampling period in ticks.
+ * @return BaseType_t pdPASS if the sampling timer was started.
+ */
+BaseType_t stackprof_start(TickType_t period);
+
+/**
+ * @brief Samples the high-water marks of all tracked tasks.
+ */
+void stackprof_sample(void);
+
+/**
+ * @brief Requests a report, printed by the sampling timer. Can be called
+ *        from any task without adding the printing time to the caller.
+ */
+void stackprof_request_report(void);
+
+/**
+ * @brief Samples once more and prints the peak usage and the recommended
+ *        stack depth of every tracked task.
+ */
+void stackprof_report(void);
+
+/**
+ * @brief Reports a stack overflow and halts. Called from
+ *        vApplicationStackOverflowHook() (rtos_hooks.c).
+ *
+ * @param task Task that overflowed.
+ * @param name Name of the task.
+ */
+void stackprof_overflow(TaskHandle_t task, const char *name);
+
+#endif /* STACKPROF_H */
@@ -0,0 +1,228 @@
+/**
+ * @file supervisor.c
+ *
+ * @brief Hardware watchdog supervisor: resets the board when a critical
+ *        task stops checking in.
+ */
+
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "pico/stdlib.h"
+#include "hardware/watchdog.h"
+#include "supervisor.h"
+
+#if appUSE_WATCHDOG_SUPERVISOR
+
+#define CURRENT_CORE()      ((unsigned)portGET_CORE_ID())
+
+#define SUP_MAGIC           0x53550000u     /* "SU" in the upper half of scratch 0 */
+#define SUP_MAGIC_MASK      0xffff0000u
+#define SCRATCH_RECORD      0
+#define SCRATCH_LATE_TASK   1
+#define SCRATCH_LAST_TASK   2               /* 2 + core */
+
+/**
+ * @brief Window and statistics of one task.
+ */
+typedef struct {
+    TaskHandle_t task;
+    TickType_t window;
+    volatile TickType_t last;   /* Tick of the last check-in */
+    uint32_t checkins;
+    TickType_t max_gap;         /* Longest time between two check-ins */
+} sup_task_t;
+
+static sup_task_t tasks[SUP_MAX_TASKS];
+static volatile UBaseType_t num_tasks;
+
+static TaskHandle_t supervisor;
+static uint32_t watchdog_timeout_ms;
+static TickType_t check_period;
+static uint8_t resets;
+static sup_record_t last_reset;
+
+static sup_task_t *find(TaskHandle_t task) {
+    for (UBaseType_t i = 0; i < num_tasks; i++) {
+        if (tasks[i].task == task) {
+            return &tasks[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief First four characters of a task name as one word; shorter names
+ *        are padded with their terminating zeros.
+ */
+static uint32_t name_tag(const char *name) {
+    uint32_t tag = 0;
+
+    for (unsigned i = 0; (i < 4) && (name[i] != '\0'); i++) {
+        tag |= (uint32_t)(uint8_t)name[i] << (8 * i);
+    }
+    return tag;
+}
+
+static void tag_name(uint32_t tag, char name[5]) {
+    for (unsigned i = 0; i < 4; i++) {
+        name[i] = (char)(tag >> (8 * i));
+    }
+    name[4] = '\0';
+}
+
+static void write_record(sup_reason_t reason, uint32_t late_tag) {
+    watchdog_hw->scratch[SCRATCH_LATE_TASK] = late_tag;
+    watchdog_hw->scratch[SCRATCH_RECORD] = SUP_MAGIC | ((uint32_t)resets << 8) | (uint32_t)reason;
+}
+
+/**
+ * @brief Feeds the watchdog as long as every task checks in within its
+ *        window.
+ */
+static void supervisor_task(void *arg) {
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+
+    watchdog_enable(watchdog_timeout_ms, true);     /* Paused while a debugger halts the cores */
+
+    for (;;) {
+        TickType_t now = xTaskGetTickCount();
+        sup_task_t *late = NULL;
+
+        for (UBaseType_t i = 0; i < num_tasks; i++) {
+            if ((TickType_t)(now - tasks[i].last) > tasks[i].window) {
+                late = &tasks[i];
+                break;
+            }
+        }
+        if (late == NULL) {
+            watchdog_update();
+            xTaskDelayUntil(&xLastWakeTime, check_period);
+            continue;
+        }
+
+        /* Stop feeding; the watchdog resets the board within the timeout */
+        write_record(SUP_RESET_MISSED, name_tag(pcTaskGetName(late->task)));
+        printf("Supervisor: %s missed its window of %lu ms, reset in %lu ms\n",
+               pcTaskGetName(late->task), (unsigned long)(late->window * portTICK_PERIOD_MS),
+               (unsigned long)watchdog_timeout_ms);
+        for (;;) {
+            vTaskDelay(portMAX_DELAY);
+        }
+    }
+}
+
+BaseType_t sup_init(uint32_t timeout_ms, TickType_t period) {
+    uint32_t record = watchdog_hw->scratch[SCRATCH_RECORD];
+
+    /* The scratch registers survive a watchdog reset but not a power-on */
+    last_reset.reason = SUP_RESET_NONE;
+    resets = 0;
+    if (watchdog_enable_caused_reboot() && ((record & SUP_MAGIC_MASK) == SUP_MAGIC)) {
+        last_reset.reason = (sup_reason_t)(record & 0xffu);
+        resets = (uint8_t)(record >> 8);
+        if (resets < UINT8_MAX) {
+            resets++;
+        }
+        last_reset.resets = resets;
+        tag_name(watchdog_hw->scratch[SCRATCH_LATE_TASK], last_reset.late_task);
+        for (unsigned core = 0; core < 2; core++) {
+            tag_name(watchdog_hw->scratch[SCRATCH_LAST_TASK + core], last_reset.last_task[core]);
+        }
+    }
+    for (unsigned core = 0; core < 2; core++) {
+        watchdog_hw->scratch[SCRATCH_LAST_TASK + core] = 0;
+    }
+    /* Stays a hang unless the supervisor finds a late task */
+    write_record(SUP_RESET_HANG, 0);
+
+    watchdog_timeout_ms = timeout_ms;
+    check_period = period;
+    if (xTaskCreate(supervisor_task, "Supervisor", SUP_STACK_WORDS, NULL,
+                    configMAX_PRIORITIES - 1, &supervisor) != pdPASS) {
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+BaseType_t sup_register(TaskHandle_t task, uint32_t window_ms) {
+    sup_task_t *t;
+
+    taskENTER_CRITICAL();
+    if (num_tasks >= SUP_MAX_TASKS) {
+        taskEXIT_CRITICAL();
+        return pdFAIL;
+    }
+    t = &tasks[num_tasks];
+    t->task = task;
+    t->window = pdMS_TO_TICKS(window_ms);
+    t->last = xTaskGetTickCount();
+    t->checkins = 0;
+    t->max_gap = 0;
+    num_tasks++;
+    taskEXIT_CRITICAL();
+
+    return pdPASS;
+}
+
+void sup_checkin(void) {
+    sup_task_t *t = find(xTaskGetCurrentTaskHandle());
+    TickType_t now = xTaskGetTickCount();
+
+    if (t == NULL) {
+        return;
+    }
+    if ((t->checkins > 0) && ((TickType_t)(now - t->last) > t->max_gap)) {
+        t->max_gap = now - t->last;
+    }
+    t->last = now;
+    t->checkins++;
+}
+
+TaskHandle_t sup_task(void) {
+    return supervisor;
+}
+
+const sup_record_t *sup_last_reset(void) {
+    return (last_reset.reason == SUP_RESET_NONE) ? NULL : &last_reset;
+}
+
+void sup_report(void) {
+    if (last_reset.reason == SUP_RESET_NONE) {
+        printf("Supervisor: no watchdog reset\n");
+    } else {
+        printf("Supervisor: watchdog reset %u, ", last_reset.resets);
+        if (last_reset.reason == SUP_RESET_MISSED) {
+            printf("%s missed its window", last_reset.late_task);
+        } else {
+            printf("hang");
+        }
+        printf(", last task %s", last_reset.last_task[0]);
+#if configNUMBER_OF_CORES > 1
+        printf(" / %s", last_reset.last_task[1]);
+#endif
+        printf("\n");
+    }
+    for (UBaseType_t i = 0; i < num_tasks; i++) {
+        printf("Supervisor: %-12s %lu check-ins, longest gap %lu of %lu ms\n",
+               pcTaskGetName(tasks[i].task), (unsigned long)tasks[i].checkins,
+               (unsigned long)(tasks[i].max_gap * portTICK_PERIOD_MS),
+               (unsigned long)(tasks[i].window * portTICK_PERIOD_MS));
+    }
+}
+
+static void report_callback(void *unused1, uint32_t unused2) {
+    sup_report();
+}
+
+void sup_request_report(void) {
+    xTimerPendFunctionCall(report_callback, NULL, 0, 0);
+}
+
+void sup_task_switched_in(void) {
+    watchdog_hw->scratch[SCRATCH_LAST_TASK + CURRENT_CORE()] =
+        name_tag(pcTaskGetName(xTaskGetCurrentTaskHandle()));
+}
+
+#endif /* appUSE_WATCHDOG_SUPERVISOR */
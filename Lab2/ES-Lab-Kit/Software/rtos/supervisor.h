@@ -0,0 +1,130 @@
+/**
+ * @file supervisor.h
+ *
+ * @brief Hardware watchdog supervisor: resets the board when a critical
+ *        task stops checking in.
+ *
+ * Each critical task is registered with a window, the longest time it may
+ * take between two calls of sup_checkin(), e.g. a few periods. The
+ * supervisor task runs at the highest priority, checks all windows every
+ * check period and feeds the RP2350 hardware watchdog only if every task
+ * has checked in within its window. A task that hangs, e.g. in a blocking
+ * I2C transfer, or that is starved by higher-priority load, therefore
+ * resets the board one watchdog timeout after its window has expired. So
+ * does a hang of the kernel or of the supervisor itself, e.g. a hard fault
+ * or interrupts disabled for too long.
+ *
+ * The cause survives the reset in the watchdog scratch registers 0-3
+ * (4-7 are used by the Pico SDK):
+ *
+ * - 0: magic, number of watchdog resets since power-on and the reason:
+ *   SUP_RESET_MISSED if a task missed its window, SUP_RESET_HANG if the
+ *   watchdog expired without the supervisor noticing a late task,
+ * - 1: the first four characters of the name of the late task,
+ * - 2, 3: the first four characters of the name of the task that was last
+ *   switched in on core 0 and core 1, updated at every context switch.
+ *
+ * sup_init() reads the record of the previous reset, sup_last_reset()
+ * returns it and sup_report() prints it with the check-in statistics.
+ *
+ * Requirements in FreeRTOSConfig.h:
+ * - appUSE_WATCHDOG_SUPERVISOR 1
+ * - configUSE_TIMERS 1 and INCLUDE_xTimerPendFunctionCall 1
+ */
+
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Maximum number of supervised tasks.
+ */
+#define SUP_MAX_TASKS               8
+
+/**
+ * @brief Stack depth of the supervisor task in words.
+ */
+#define SUP_STACK_WORDS             512
+
+/**
+ * @brief Reason of a watchdog reset.
+ */
+typedef enum {
+    SUP_RESET_NONE = 0,         /* Not reset by the watchdog */
+    SUP_RESET_HANG,             /* Watchdog expired, no task was late: kernel or supervisor hung */
+    SUP_RESET_MISSED            /* A task missed its check-in window */
+} sup_reason_t;
+
+/**
+ * @brief Record of the last watchdog reset, read from the scratch registers.
+ */
+typedef struct {
+    sup_reason_t reason;
+    uint8_t resets;             /* Watchdog resets since power-on */
+    char late_task[5];          /* Task that missed its window, SUP_RESET_MISSED only */
+    char last_task[2][5];       /* Task last switched in on core 0 and 1 */
+} sup_record_t;
+
+/**
+ * @brief Reads the record of the previous reset and creates the supervisor
+ *        task at priority configMAX_PRIORITIES - 1. The watchdog is armed
+ *        when the scheduler starts. Call before vTaskStartScheduler().
+ *
+ * @param timeout_ms Watchdog timeout in ms, longer than the check period
+ *                   and at most 16777 ms.
+ * @param period Check period in ticks.
+ * @return BaseType_t pdPASS, or pdFAIL if the task could not be created.
+ */
+BaseType_t sup_init(uint32_t timeout_ms, TickType_t period);
+
+/**
+ * @brief Supervises a task. Its first window starts now.
+ *
+ * @param task Task handle.
+ * @param window_ms Longest time between two check-ins in ms.
+ * @return BaseType_t pdPASS, or pdFAIL if the table is full.
+ */
+BaseType_t sup_register(TaskHandle_t task, uint32_t window_ms);
+
+/**
+ * @brief Checks in the calling task, e.g. once per job. Tasks that are not
+ *        registered are ignored.
+ */
+void sup_checkin(void);
+
+/**
+ * @brief Returns the record of the previous reset.
+ *
+ * @return const sup_record_t* Record, or NULL if the board was not reset by
+ *                             the watchdog.
+ */
+const sup_record_t *sup_last_reset(void);
+
+/**
+ * @brief Returns the supervisor task, e.g. for the stack profiler.
+ *
+ * @return TaskHandle_t Supervisor task, or NULL before sup_init().
+ */
+TaskHandle_t sup_task(void);
+
+/**
+ * @brief Prints the record of the previous reset and, for every task, the
+ *        check-ins and the longest time between two of them.
+ */
+void sup_report(void);
+
+/**
+ * @brief Prints the report from the timer service task; can be called from
+ *        any task.
+ */
+void sup_request_report(void);
+
+/**
+ * @brief Kernel hook, called from traceTASK_SWITCHED_IN (rtos_hooks.c).
+ */
+void sup_task_switched_in(void);
+
+#endif /* SUPERVISOR_H */
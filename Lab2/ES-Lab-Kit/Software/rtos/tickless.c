@@ -0,0 +1,190 @@
+/**
+ * @file tickless.c
+ *
+ * @brief Tickless idle for the RP2350: sleeps on a hardware timer alarm
+ *        until the next task has to wake up.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "hardware/structs/scb.h"
+#include "hardware/structs/systick.h"
+#include "tickless.h"
+
+#if appUSE_TICKLESS_IDLE
+
+#if configNUMBER_OF_CORES > 1
+#error "tickless.c requires configNUMBER_OF_CORES 1"
+#endif
+
+#define TICK_US             ( 1000000u / configTICK_RATE_HZ )
+
+static int alarm = -1;
+static uint32_t cycles_per_tick;    /* SysTick reload + 1, as set up by the port */
+static uint32_t cycles_per_us;
+
+/* Tick grid: tick anchor_tick is due at anchor_us, every further tick TICK_US later */
+static bool anchored;
+static uint64_t anchor_us;
+static TickType_t anchor_tick;
+
+static uint64_t start_us;
+static uint32_t sleeps;
+static uint32_t early;              /* Woken by another interrupt before the alarm */
+static uint32_t aborted;            /* A task became ready or a tick was due */
+static uint32_t regrids;            /* Tick count lost the grid, e.g. after a missed tick */
+static uint64_t slept_us;
+static uint32_t max_sleep_us;
+
+/**
+ * @brief The alarm only has to wake the core from WFI.
+ */
+static void alarm_fired(uint alarm_num) {
+}
+
+/**
+ * @brief Waits for the next edge of the microsecond timer, so the SysTick
+ *        can be programmed without the fraction of the current microsecond.
+ */
+static uint64_t time_us_edge(void) {
+    uint64_t t = time_us_64();
+    uint64_t now;
+
+    while ((now = time_us_64()) == t) {
+    }
+    return now;
+}
+
+/**
+ * @brief Restarts the stopped SysTick so that it interrupts at next_us and
+ *        then every tick.
+ */
+static void systick_restart(uint64_t next_us, uint64_t now) {
+    uint32_t cycles = (next_us > now) ? (uint32_t)(next_us - now) * cycles_per_us : cycles_per_us;
+
+    systick_hw->rvr = cycles - 1;
+    systick_hw->cvr = 0;            /* Reloads from rvr on the next clock */
+    systick_hw->csr |= M33_SYST_CSR_ENABLE_BITS;
+    systick_hw->rvr = cycles_per_tick - 1;  /* Taken at the next reload */
+}
+
+BaseType_t tickless_init(void) {
+    alarm = hardware_alarm_claim_unused(false);
+    if (alarm < 0) {
+        return pdFAIL;
+    }
+    hardware_alarm_set_callback((uint)alarm, alarm_fired);
+    anchored = false;
+    start_us = time_us_64();
+    return pdPASS;
+}
+
+void tickless_sleep(uint32_t expected_idle) {
+    uint32_t irq;
+    uint64_t now, boundary, wake, woke, next;
+    TickType_t stepped = 0;
+    uint32_t slept;
+
+    if ((alarm < 0) || (expected_idle < 2)) {
+        return;
+    }
+    if (expected_idle > TICKLESS_MAX_SLEEP_TICKS) {
+        expected_idle = TICKLESS_MAX_SLEEP_TICKS;
+    }
+
+    irq = save_and_disable_interrupts();
+    if ((eTaskConfirmSleepModeStatus() == eAbortSleep) ||
+        (scb_hw->icsr & M33_ICSR_PENDSTSET_BITS)) {
+        aborted++;
+        restore_interrupts(irq);
+        return;
+    }
+
+    now = time_us_edge();
+    if (!anchored) {
+        /* The SysTick started by the port defines the grid */
+        cycles_per_tick = systick_hw->rvr + 1;
+        cycles_per_us = cycles_per_tick / TICK_US;
+        anchor_us = now + (systick_hw->cvr + 1) / cycles_per_us;
+        anchor_tick = xTaskGetTickCount() + 1;
+        anchored = true;
+    }
+    /* Instant of the next tick on the grid */
+    boundary = anchor_us + (uint64_t)(TickType_t)(xTaskGetTickCount() + 1 - anchor_tick) * TICK_US;
+    if ((boundary + TICK_US / 2 < now) || (boundary > now + TICK_US + TICK_US / 2)) {
+        /* Only after a missed tick; the grid restarts at the SysTick phase */
+        regrids++;
+        anchored = false;
+        aborted++;
+        restore_interrupts(irq);
+        return;
+    }
+    if (boundary <= now + TICKLESS_WAKE_MARGIN_US) {
+        aborted++;          /* The tick is about to interrupt anyway */
+        restore_interrupts(irq);
+        return;
+    }
+
+    /* From here on the grid alone decides when the ticks fall due */
+    systick_hw->csr &= ~M33_SYST_CSR_ENABLE_BITS;
+    scb_hw->icsr = M33_ICSR_PENDSTCLR_BITS;
+
+    wake = boundary + (uint64_t)(expected_idle - 1) * TICK_US - TICKLESS_WAKE_MARGIN_US;
+    if (!hardware_alarm_set_target((uint)alarm, from_us_since_boot(wake))) {
+        __dsb();
+        __wfi();        /* Wakes on the alarm or any other interrupt, handled after restore */
+        hardware_alarm_cancel((uint)alarm);
+    }
+
+    woke = time_us_edge();
+    if (woke >= boundary) {
+        stepped = (TickType_t)(1 + (woke - boundary) / TICK_US);
+        if (stepped > expected_idle - 1) {
+            stepped = expected_idle - 1;    /* The last tick is left to the SysTick */
+        }
+    }
+    next = boundary + (uint64_t)stepped * TICK_US;
+    systick_restart(next, woke);
+    if (stepped > 0) {
+        vTaskStepTick(stepped);
+    }
+
+    slept = (uint32_t)(woke - now);
+    sleeps++;
+    slept_us += slept;
+    if (slept > max_sleep_us) {
+        max_sleep_us = slept;
+    }
+    if (woke < wake) {
+        early++;
+    }
+    restore_interrupts(irq);
+}
+
+void tickless_report(void) {
+    uint64_t elapsed = time_us_64() - start_us;
+
+    printf("Tickless: %lu sleeps, %lu woken early, %lu aborted, %lu regrids\n",
+           (unsigned long)sleeps, (unsigned long)early, (unsigned long)aborted,
+           (unsigned long)regrids);
+    printf("Tickless: slept %lu of %lu ms (%lu.%lu %%), longest sleep %lu ms\n",
+           (unsigned long)(slept_us / 1000), (unsigned long)(elapsed / 1000),
+           (unsigned long)(slept_us * 100 / elapsed), (unsigned long)(slept_us * 1000 / elapsed % 10),
+           (unsigned long)(max_sleep_us / 1000));
+}
+
+static void report_callback(void *unused1, uint32_t unused2) {
+    tickless_report();
+}
+
+void tickless_request_report(void) {
+    xTimerPendFunctionCall(report_callback, NULL, 0, 0);
+}
+
+#endif /* appUSE_TICKLESS_IDLE */
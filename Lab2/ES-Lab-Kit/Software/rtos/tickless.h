@@ -0,0 +1,88 @@
+/**
+ * @file tickless.h
+ *
+ * @brief Tickless idle for the RP2350: sleeps on a hardware timer alarm
+ *        until the next task has to wake up.
+ *
+ * With configUSE_TICKLESS_IDLE 0 the SysTick interrupt wakes the core 1000
+ * times per second even if all tasks are blocked for seconds. In tickless
+ * idle the kernel calls portSUPPRESS_TICKS_AND_SLEEP() from the idle task
+ * with the number of ticks until the next task unblocks. tickless_sleep()
+ * then stops the SysTick, sets a hardware timer alarm shortly before that
+ * tick and waits for interrupts (WFI). After the wake-up it steps the tick
+ * count over the ticks that were slept through and restarts the SysTick so
+ * that its next interrupt falls on the next tick. A task is thus released
+ * by the same tick interrupt as without tickless idle. Any other interrupt
+ * ends the sleep early; only the ticks that have passed are stepped.
+ *
+ * The port's own implementation (configUSE_TICKLESS_IDLE 1) computes the
+ * ticks slept from the SysTick counter and rounds at every sleep, so the
+ * tick count slowly drifts against real time. Here the tick instants lie on
+ * a fixed grid of the 1 MHz timer (time_us_64()): the n-th tick after the
+ * first sleep is due at a fixed anchor + n tick periods. Every sleep wakes
+ * and restarts the SysTick on this grid, so rounding errors do not add up
+ * and vTaskDelayUntil() periods keep their length over any number of
+ * sleeps. The SysTick and the timer both run from the crystal.
+ *
+ * The absence of drift is checked by the host test host/tickless_test.c
+ * (ctest tickless), which runs this file against a model of the SysTick,
+ * the timer alarm and other interrupts for one simulated hour. It is not
+ * yet verified on hardware: a one-hour run of the Handshake project on a
+ * Pico 2 is still missing.
+ *
+ * tickless_report() prints how often and how long the core slept.
+ *
+ * Requirements in FreeRTOSConfig.h:
+ * - appUSE_TICKLESS_IDLE 1 and configUSE_TICKLESS_IDLE 2, so the port's
+ *   implementation is replaced by the one here
+ * - configNUMBER_OF_CORES 1; the SysTick of core 0 drives the tick
+ * - configUSE_TIMERS 1 and INCLUDE_xTimerPendFunctionCall 1
+ */
+
+#ifndef TICKLESS_H
+#define TICKLESS_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Time before the tick at which the alarm wakes the core, to restart
+ *        the SysTick in time for the tick.
+ */
+#define TICKLESS_WAKE_MARGIN_US     50
+
+/**
+ * @brief Longest sleep in ticks; the idle task simply sleeps again.
+ */
+#define TICKLESS_MAX_SLEEP_TICKS    pdMS_TO_TICKS(60000)
+
+/**
+ * @brief Claims the hardware timer alarm. Call before vTaskStartScheduler().
+ *
+ * @return BaseType_t pdPASS, or pdFAIL if no hardware alarm is free; the
+ *                    core then idles with the tick running.
+ */
+BaseType_t tickless_init(void);
+
+/**
+ * @brief Prints the number of sleeps, early wake-ups and aborted sleeps and
+ *        the share of the time the core slept.
+ */
+void tickless_report(void);
+
+/**
+ * @brief Prints the report from the timer service task; can be called from
+ *        any task.
+ */
+void tickless_request_report(void);
+
+/**
+ * @brief Kernel hook, called from portSUPPRESS_TICKS_AND_SLEEP (rtos_hooks.h)
+ *        with the scheduler suspended.
+ *
+ * @param expected_idle Ticks until the next task unblocks.
+ */
+void tickless_sleep(uint32_t expected_idle);
+
+#endif /* TICKLESS_H */